@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gc_controller_emulation.h"
+#include "gc_port_host.h"
+
+// Notes //
+/* NOTE 1:
+ * Simulated GC console. Every cycle it picks new button inputs, puts a
+ * command on the line and runs one pass of the emulation. The response
+ * is checked against the layouts in Notes 2-4 of
+ * gc_controller_emulation.h. Commands the console would never get an
+ * answer to must not be answered.
+ *
+ * Time is virtual. Each cycle moves the cycle counter of the host port
+ * by one poll interval of the uC clock, so millions of polls run in
+ * seconds. The real time spent by the emulation is reported per phase.
+ *
+ * Usage: gc_console_sim [number of cycles] [seed]
+ */
+
+// Macros //
+#define SIM_DEFAULT_CYCLES		1000000UL
+#define SIM_CPU_CLOCK_HZ		100000000UL
+#define SIM_POLL_INTERVAL_US	1000UL
+#define SIM_NUM_OF_INPUTS		NUM_OF_GC_BUTTON_INPUTS
+
+/* Bits of a POLL response layout, see Note 4 of gc_controller_emulation.h */
+#define SIM_BYTE0_ZERO_BITS		0xE0
+#define SIM_BYTE1_ONE_BIT		0x80
+
+// Enumerations //
+/* What the console sends in a cycle */
+typedef enum
+{
+	SIM_COMMAND_POLL = 0,
+	SIM_COMMAND_PROBE = 1,
+	SIM_COMMAND_PROBE_ORIGIN = 2,
+	SIM_COMMAND_UNKNOWN = 3,
+	SIM_COMMAND_BAD_POLL = 4,
+	SIM_COMMAND_MID_FRAME = 5,
+	SIM_COMMAND_BIT_ERROR = 6,
+	NUM_OF_SIM_COMMANDS = 7
+} SimCommand_t;
+
+// Structures //
+/* Results of the whole run */
+typedef struct
+{
+	uint64_t numOfSent[NUM_OF_SIM_COMMANDS];
+	uint64_t numOfFailures[NUM_OF_SIM_COMMANDS];
+	uint64_t numOfResponses;
+} SimResults_t;
+
+// Variables //
+static uint64_t simRandomState = 0x9E3779B97F4A7C15ULL;
+
+static const char *simCommandNames[NUM_OF_SIM_COMMANDS] =
+{
+	"POLL", "PROBE", "PROBE ORIGIN", "unknown", "bad POLL", "mid-frame", "bit error"
+};
+
+static const uint8_t simBitPairCase1[4] = {GC_BITS_00_CASE1, GC_BITS_01_CASE1, GC_BITS_10_CASE1, GC_BITS_11_CASE1};
+static const uint8_t simBitPairCase2[4] = {GC_BITS_00_CASE2, GC_BITS_01_CASE2, GC_BITS_10_CASE2, GC_BITS_11_CASE2};
+
+// Function Implementations //
+/* xorshift64*, good enough to pick commands and inputs */
+static uint32_t SimRandom(void)
+{
+	simRandomState ^= simRandomState >> 12;
+	simRandomState ^= simRandomState << 25;
+	simRandomState ^= simRandomState >> 27;
+	return (uint32_t)((simRandomState * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Puts GC bytes on the line like a console would, with either UART
+ * byte of every bit pair (see Note 5 of gc_controller_emulation.h)
+ */
+static uint32_t SimEncodeCommand(const uint8_t *gcBytes, uint32_t numOfGCBytes, uint8_t *uartBytes)
+{
+	uint32_t numOfUartBytes = 0;
+
+	for(uint32_t i = 0; i < numOfGCBytes; i++)
+	{
+		for(int32_t shift = 6; shift >= 0; shift -= 2)
+		{
+			uint32_t bitPair = (gcBytes[i] >> shift) & 0x03;
+			uartBytes[numOfUartBytes++] = (SimRandom() & 1) ? simBitPairCase2[bitPair] : simBitPairCase1[bitPair];
+		}
+	}
+	uartBytes[numOfUartBytes++] = GC_BITS_STOP_BIT;
+
+	return numOfUartBytes;
+}
+
+/* Turns a response back into GC bytes. Returns how many, or -1 if the
+ * line did not carry whole GC bytes ended by a stop bit.
+ */
+static int32_t SimDecodeResponse(const uint8_t *uartBytes, uint32_t numOfUartBytes, uint8_t *gcBytes)
+{
+	if( (numOfUartBytes == 0) || (uartBytes[numOfUartBytes - 1] != GC_BITS_STOP_BIT) ||
+		(((numOfUartBytes - 1) % GC_UART_BYTES_PER_GC_BYTE) != 0) )
+	{
+		return -1;
+	}
+
+	uint32_t numOfGCBytes = (numOfUartBytes - 1) / GC_UART_BYTES_PER_GC_BYTE;
+	for(uint32_t i = 0; i < numOfGCBytes; i++)
+	{
+		uint8_t gcByte = 0;
+		for(uint32_t j = 0; j < GC_UART_BYTES_PER_GC_BYTE; j++)
+		{
+			uint8_t uartByte = uartBytes[(i * GC_UART_BYTES_PER_GC_BYTE) + j];
+			uint32_t bitPair = 0;
+			while( (bitPair < 4) && (simBitPairCase1[bitPair] != uartByte) )
+			{
+				bitPair++;
+			}
+			if(bitPair == 4)
+			{
+				return -1;
+			}
+			gcByte = (uint8_t)((gcByte << 2) | bitPair);
+		}
+		gcBytes[i] = gcByte;
+	}
+
+	return (int32_t)numOfGCBytes;
+}
+
+/* Value of a stick axis the layout allows for the pushed directions */
+static uint8_t SimStickAxis(uint32_t low, uint32_t high, uint8_t lowValue, uint8_t highValue)
+{
+	if(low && high)
+	{
+		return 0x80;
+	}
+	return low ? lowValue : high ? highValue : 0x80;
+}
+
+/* Checks a POLL or PROBE ORIGIN response against the layout for the inputs */
+static uint32_t SimCheckControllerState(const uint8_t *gcBytes, uint32_t numOfGCBytes, uint32_t expectedGCBytes, uint32_t pushed)
+{
+	#define SIM_PUSHED(gcButton)	((pushed >> (gcButton)) & 1UL)
+	#define SIM_SOCD(first, second)	(SIM_PUSHED(first) && !SIM_PUSHED(second))
+
+	uint32_t tilt = SIM_PUSHED(GC_TILT);
+	uint32_t ok = (numOfGCBytes == expectedGCBytes);
+
+	if(ok)
+	{
+		// BYTE 0: 0, 0, 0, START, Y, X, B, A
+		ok &= ((gcBytes[0] & SIM_BYTE0_ZERO_BITS) == 0);
+		ok &= (((gcBytes[0] >> 4) & 1) == SIM_PUSHED(GC_START));
+		ok &= (((gcBytes[0] >> 3) & 1) == SIM_PUSHED(GC_Y));
+		ok &= (((gcBytes[0] >> 2) & 1) == SIM_PUSHED(GC_X));
+		ok &= (((gcBytes[0] >> 1) & 1) == SIM_PUSHED(GC_B));
+		ok &= ((gcBytes[0] & 1) == SIM_PUSHED(GC_A));
+
+		// BYTE 1: 1, L, R, Z, DU, DD, DR, DL with opposite d-pad directions cleaned
+		ok &= ((gcBytes[1] & SIM_BYTE1_ONE_BIT) != 0);
+		ok &= (((gcBytes[1] >> 6) & 1) == SIM_PUSHED(GC_L));
+		ok &= (((gcBytes[1] >> 5) & 1) == SIM_PUSHED(GC_R));
+		ok &= (((gcBytes[1] >> 4) & 1) == SIM_PUSHED(GC_Z));
+		ok &= (((gcBytes[1] >> 3) & 1) == SIM_SOCD(GC_DPAD_UP, GC_DPAD_DOWN));
+		ok &= (((gcBytes[1] >> 2) & 1) == SIM_SOCD(GC_DPAD_DOWN, GC_DPAD_UP));
+		ok &= (((gcBytes[1] >> 1) & 1) == SIM_SOCD(GC_DPAD_RIGHT, GC_DPAD_LEFT));
+		ok &= ((gcBytes[1] & 1) == SIM_SOCD(GC_DPAD_LEFT, GC_DPAD_RIGHT));
+
+		// BYTE 2-5: sticks
+		ok &= (gcBytes[2] == SimStickAxis(SIM_PUSHED(GC_MAIN_STICK_LEFT), SIM_PUSHED(GC_MAIN_STICK_RIGHT),
+										  tilt ? 0x4C : 0x00, tilt ? 0xB1 : 0xFF));
+		ok &= (gcBytes[3] == SimStickAxis(SIM_PUSHED(GC_MAIN_STICK_DOWN), SIM_PUSHED(GC_MAIN_STICK_UP),
+										  tilt ? 0x4C : 0x00, tilt ? 0xFF : 0xB1));
+		ok &= (gcBytes[4] == SimStickAxis(SIM_PUSHED(GC_C_STICK_LEFT), SIM_PUSHED(GC_C_STICK_RIGHT), 0x00, 0xFF));
+		ok &= (gcBytes[5] == SimStickAxis(SIM_PUSHED(GC_C_STICK_DOWN), SIM_PUSHED(GC_C_STICK_UP), 0x00, 0xB1));
+
+		// BYTE 6-7: triggers, BYTE 8-9: PROBE ORIGIN only
+		for(uint32_t i = 6; i < numOfGCBytes; i++)
+		{
+			ok &= (gcBytes[i] == 0x00);
+		}
+	}
+
+	#undef SIM_SOCD
+	#undef SIM_PUSHED
+
+	return ok;
+}
+
+/* Sends one command and checks what comes back */
+static uint32_t SimRunCycle(SimCommand_t simCommand, uint32_t pushed, SimResults_t *results)
+{
+	uint8_t command[MAX_GC_CONSOLE_COMMAND_BYTES] = {GC_JOYBUS_COMMAND_POLL, 0x03, (uint8_t)(SimRandom() % 3)};
+	uint32_t numOfCommandBytes = 3;
+	uint8_t uartBytes[HOST_PORT_MAX_UART_BYTES];
+	uint32_t numOfUartBytes;
+	uint32_t skippedUartBytes = 0;
+
+	switch(simCommand)
+	{
+		case SIM_COMMAND_PROBE:
+			command[0] = GC_JOYBUS_COMMAND_PROBE;
+			numOfCommandBytes = 1;
+			break;
+		case SIM_COMMAND_PROBE_ORIGIN:
+			command[0] = GC_JOYBUS_COMMAND_PROBE_ORIGIN;
+			numOfCommandBytes = 1;
+			break;
+		case SIM_COMMAND_UNKNOWN:
+			// Any first byte without a handler
+			do
+			{
+				command[0] = (uint8_t)SimRandom();
+			} while( (command[0] == GC_JOYBUS_COMMAND_PROBE) || (command[0] == GC_JOYBUS_COMMAND_POLL) ||
+					 (command[0] == GC_JOYBUS_COMMAND_PROBE_ORIGIN) || (command[0] == GC_JOYBUS_COMMAND_CALIBRATE) ||
+					 (command[0] == GC_JOYBUS_COMMAND_RESET) );
+			numOfCommandBytes = 1 + (SimRandom() % MAX_GC_CONSOLE_COMMAND_BYTES);
+			break;
+		case SIM_COMMAND_BAD_POLL:
+			command[2] = (uint8_t)(3 + (SimRandom() % 253));
+			break;
+		case SIM_COMMAND_MID_FRAME:
+			// Start listening part way into a GC byte
+			do
+			{
+				skippedUartBytes = 1 + (SimRandom() % ((numOfCommandBytes * GC_UART_BYTES_PER_GC_BYTE) - 1));
+			} while((skippedUartBytes % GC_UART_BYTES_PER_GC_BYTE) == 0);
+			break;
+		default:
+			break;
+	}
+
+	numOfUartBytes = SimEncodeCommand(command, numOfCommandBytes, uartBytes);
+	if(simCommand == SIM_COMMAND_BIT_ERROR)
+	{
+		// A UART byte that is no bit pair at all
+		uint32_t position = SimRandom() % (numOfUartBytes - 1);
+		do
+		{
+			uartBytes[position] = (uint8_t)SimRandom();
+		} while(gcJoybusDecodeTable[uartBytes[position]] != GC_JOYBUS_INVALID_BITS);
+	}
+
+	HostPort_SetInputs(pushed);
+	HostPort_QueueUartBytes(uartBytes + skippedUartBytes, numOfUartBytes - skippedUartBytes);
+	HostPort_AdvanceCycles((SIM_CPU_CLOCK_HZ / 1000000UL) * SIM_POLL_INTERVAL_US);
+	GCControllerEmulation_RunOnce();
+
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	uint8_t gcBytes[HOST_PORT_MAX_UART_BYTES];
+	uint32_t numOfResponseBytes = HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+	int32_t numOfGCBytes = (numOfResponseBytes != 0) ? SimDecodeResponse(response, numOfResponseBytes, gcBytes) : 0;
+	uint32_t ok;
+
+	results->numOfResponses += (numOfResponseBytes != 0);
+	switch(simCommand)
+	{
+		case SIM_COMMAND_POLL:
+			ok = SimCheckControllerState(gcBytes, (numOfGCBytes > 0) ? (uint32_t)numOfGCBytes : 0, 8, pushed);
+			break;
+		case SIM_COMMAND_PROBE_ORIGIN:
+			ok = SimCheckControllerState(gcBytes, (numOfGCBytes > 0) ? (uint32_t)numOfGCBytes : 0, 10, pushed);
+			break;
+		case SIM_COMMAND_PROBE:
+			ok = (numOfGCBytes == 3) && (gcBytes[0] == 0x09) && (gcBytes[1] == 0x00) && (gcBytes[2] == 0x03);
+			break;
+		default:
+			ok = (numOfResponseBytes == 0);
+			break;
+	}
+
+	return ok;
+}
+
+/* Picks what the console sends, mostly polls like a game would */
+static SimCommand_t SimPickCommand(void)
+{
+	uint32_t pick = SimRandom() % 100;
+
+	if(pick < 80) return SIM_COMMAND_POLL;
+	if(pick < 84) return SIM_COMMAND_PROBE;
+	if(pick < 88) return SIM_COMMAND_PROBE_ORIGIN;
+	if(pick < 91) return SIM_COMMAND_UNKNOWN;
+	if(pick < 94) return SIM_COMMAND_BAD_POLL;
+	if(pick < 97) return SIM_COMMAND_MID_FRAME;
+	return SIM_COMMAND_BIT_ERROR;
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t numOfCycles = (argc > 1) ? strtoull(argv[1], NULL, 0) : SIM_DEFAULT_CYCLES;
+	SimResults_t results;
+	uint64_t numOfFailures = 0;
+
+	memset(&results, 0, sizeof(results));
+	if(argc > 2)
+	{
+		simRandomState ^= strtoull(argv[2], NULL, 0);
+	}
+
+	GCControllerEmulation_Init();
+
+	for(uint64_t cycle = 0; cycle < numOfCycles; cycle++)
+	{
+		SimCommand_t simCommand = SimPickCommand();
+		uint32_t pushed = SimRandom() & ((1UL << SIM_NUM_OF_INPUTS) - 1);
+
+		results.numOfSent[simCommand]++;
+		if(!SimRunCycle(simCommand, pushed, &results))
+		{
+			if(results.numOfFailures[simCommand]++ == 0)
+			{
+				printf("cycle %llu: %s failed with inputs 0x%06X\n", (unsigned long long)cycle, simCommandNames[simCommand], pushed);
+			}
+		}
+	}
+
+	/* Report */
+	HostPortPhaseTimes_t phaseTimes;
+	GCRxStats_t rxStats;
+	HostPort_GetPhaseTimes(&phaseTimes);
+	GCControllerEmulation_GetRxStats(0, &rxStats);
+
+	printf("%llu cycles, %.1f s of virtual time\n", (unsigned long long)numOfCycles,
+		   (double)numOfCycles * SIM_POLL_INTERVAL_US / 1e6);
+	for(uint32_t i = 0; i < NUM_OF_SIM_COMMANDS; i++)
+	{
+		printf("  %-13s sent %10llu  failed %llu\n", simCommandNames[i],
+			   (unsigned long long)results.numOfSent[i], (unsigned long long)results.numOfFailures[i]);
+		numOfFailures += results.numOfFailures[i];
+	}
+	printf("responses %llu, commands decoded %u, rejected %u\n", (unsigned long long)results.numOfResponses,
+		   rxStats.numOfCommands, rxStats.numOfBadCommands);
+	printf("host ns per phase: refresh %.1f  receive %.1f  respond %.1f\n",
+		   phaseTimes.numOfRefreshes ? (double)phaseTimes.refreshNs / phaseTimes.numOfRefreshes : 0.0,
+		   phaseTimes.numOfCommands ? (double)phaseTimes.receiveNs / phaseTimes.numOfCommands : 0.0,
+		   phaseTimes.numOfResponses ? (double)phaseTimes.respondNs / phaseTimes.numOfResponses : 0.0);
+
+	if(numOfFailures != 0)
+	{
+		printf("FAILED\n");
+		return 1;
+	}
+
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,539 @@
+#include <string.h>
+#include <time.h>
+#include "gc_port_host.h"
+#include "gc_controller_emulation.h"
+#include "gc_joybus.h"
+#include "gc_profile.h"
+
+// Macros //
+/* Longest command the host port can encode */
+#define MAX_HOST_COMMAND_BYTES		16
+
+/* Frames that can be prepared at the same time */
+#define MAX_HOST_PREPARED_FRAMES	4
+
+// Structures //
+/* Copy of a frame as it was prepared */
+typedef struct
+{
+	const uint32_t *frame;
+	uint32_t numOfGCBytes;
+	uint32_t frameCopy[GC_MAX_RESPONSE_BYTES];
+} HostPortPreparedFrame_t;
+
+/* Model of the GC data line of one console port */
+typedef struct
+{
+	uint8_t rxBytes[HOST_PORT_MAX_UART_BYTES];
+	uint32_t rxHead;
+	uint32_t rxTail;
+	uint8_t txBytes[HOST_PORT_MAX_UART_BYTES];
+	uint32_t numOfTxBytes;
+	HostPortPreparedFrame_t preparedFrames[MAX_HOST_PREPARED_FRAMES];
+	uint32_t numOfUnpreparedFrames;
+	uint32_t receiving;
+	uint32_t idleChecked;
+	uint32_t rxTimed;
+	uint32_t rxNextTime;
+} HostPortLine_t;
+
+/* Model of the GC data lines, buttons and cycle counter */
+typedef struct
+{
+	HostPortLine_t lines[GC_NUM_OF_CONSOLE_PORTS];
+	uint32_t selectedLine;
+	uint32_t inputs;
+	uint32_t inputSamples[GC_MAX_SAMPLE_WINDOW];
+	uint32_t numOfInputSamples;
+	uint32_t cycles;
+	uint32_t cyclesPerUartByte;
+	uint32_t cyclesPerFrame;
+	uint32_t nextInputs;
+	uint32_t nextInputsTime;
+	uint32_t hasNextInputs;
+	uint64_t phaseStartNs;
+	HostPortPhaseTimes_t phaseTimes;
+	uint8_t telemetryBytes[HOST_PORT_MAX_TELEMETRY_BYTES];
+	uint32_t numOfTelemetryBytes;
+	uint32_t telemetryStalled;
+} HostPort_t;
+
+/* Model of the recording region, kept out of HostPort_t so a reset does
+ * not erase it
+ */
+typedef struct
+{
+	uint8_t bytes[GC_RECORDING_FLASH_BYTES];
+	uint32_t isSetup;
+	uint32_t numOfWrites;
+	uint32_t numOfBadWrites;
+} HostPortFlash_t;
+
+// Variables //
+static HostPort_t hostPort;
+static HostPortFlash_t hostPortFlash;
+
+// Function Prototypes //
+/* Gets a monotonic time in nanoseconds */
+static uint64_t HostPort_GetNs(void);
+
+/* Gets the line the helpers act on */
+static HostPortLine_t *HostPort_GetSelectedLine(void);
+
+/* Finds where a frame was prepared on a line, NULL if it never was */
+static HostPortPreparedFrame_t *HostPort_FindPreparedFrame(HostPortLine_t *, const uint32_t *);
+
+// Function Implementations //
+void HostPort_Reset()
+{
+	memset(&hostPort, 0, sizeof(hostPort));
+}
+
+void HostPort_SetInputs(uint32_t pushedButtons)
+{
+	// The pins held still long enough to fill every sample
+	hostPort.inputs = pushedButtons;
+	for(uint32_t i = 0; i < GC_MAX_SAMPLE_WINDOW; i++)
+	{
+		hostPort.inputSamples[i] = pushedButtons;
+	}
+}
+
+void HostPort_AddInputSample(uint32_t pushedButtons)
+{
+	hostPort.inputs = pushedButtons;
+	hostPort.inputSamples[hostPort.numOfInputSamples % GC_MAX_SAMPLE_WINDOW] = pushedButtons;
+	hostPort.numOfInputSamples++;
+}
+
+void HostPort_SetInputsAt(uint32_t cycles, uint32_t pushedButtons)
+{
+	hostPort.nextInputs = pushedButtons;
+	hostPort.nextInputsTime = cycles;
+	hostPort.hasNextInputs = 1;
+}
+
+void HostPort_SelectConsolePort(uint32_t consolePort)
+{
+	hostPort.selectedLine = consolePort;
+}
+
+void HostPort_QueueUartBytes(const uint8_t *uartBytes, uint32_t numOfUartBytes)
+{
+	HostPortLine_t *line = HostPort_GetSelectedLine();
+
+	for(uint32_t i = 0; i < numOfUartBytes; i++)
+	{
+		// A full queue drops bytes like an overrun would
+		if(line->rxTail < HOST_PORT_MAX_UART_BYTES)
+		{
+			line->rxBytes[line->rxTail++] = uartBytes[i];
+		}
+	}
+}
+
+void HostPort_QueueCommand(const uint8_t *gcBytes, uint32_t numOfGCBytes)
+{
+	uint32_t frame[MAX_HOST_COMMAND_BYTES];
+	uint8_t stopBit = GC_BITS_STOP_BIT;
+
+	if(numOfGCBytes > MAX_HOST_COMMAND_BYTES)
+	{
+		numOfGCBytes = MAX_HOST_COMMAND_BYTES;
+	}
+
+	GCJoybus_EncodeFrame(gcBytes, numOfGCBytes, frame);
+	HostPort_QueueUartBytes((const uint8_t *)frame, numOfGCBytes * GC_UART_BYTES_PER_GC_BYTE);
+	HostPort_QueueUartBytes(&stopBit, 1);
+}
+
+uint32_t HostPort_TakeSentBytes(uint8_t *uartBytes, uint32_t maxUartBytes)
+{
+	HostPortLine_t *line = HostPort_GetSelectedLine();
+	uint32_t numOfUartBytes = (line->numOfTxBytes < maxUartBytes) ? line->numOfTxBytes : maxUartBytes;
+
+	memcpy(uartBytes, line->txBytes, numOfUartBytes);
+	line->numOfTxBytes = 0;
+
+	return numOfUartBytes;
+}
+
+void HostPort_DeliverUartBytes()
+{
+#if GC_USE_DMA_RX
+	HostPortLine_t *line = HostPort_GetSelectedLine();
+
+	/* The receiver hands over what it got, and what is left after a
+	 * command ended is skipped like StartReceiving does on the uC
+	 */
+	hostPort.phaseStartNs = HostPort_GetNs();
+	while(line->receiving && (line->rxHead != line->rxTail))
+	{
+		HostPort_AdvanceCycles(hostPort.cyclesPerUartByte);
+		if(GCControllerEmulation_ReceiveUartByte(hostPort.selectedLine, line->rxBytes[line->rxHead++]))
+		{
+			line->rxHead = 0;
+			line->rxTail = 0;
+		}
+	}
+#endif
+}
+
+void HostPort_AdvanceCycles(uint32_t cycles)
+{
+	hostPort.cycles += cycles;
+
+	// Inputs set for a later cycle change once it is reached
+	if( hostPort.hasNextInputs && ((int32_t)(hostPort.cycles - hostPort.nextInputsTime) >= 0) )
+	{
+		hostPort.hasNextInputs = 0;
+		HostPort_SetInputs(hostPort.nextInputs);
+	}
+}
+
+void HostPort_SetCyclesPerUartByte(uint32_t cycles)
+{
+	hostPort.cyclesPerUartByte = cycles;
+}
+
+void HostPort_SetCyclesPerFrame(uint32_t cycles)
+{
+	hostPort.cyclesPerFrame = cycles;
+}
+
+uint32_t HostPort_GetNumOfUnpreparedFrames()
+{
+	return HostPort_GetSelectedLine()->numOfUnpreparedFrames;
+}
+
+void HostPort_GetPhaseTimes(HostPortPhaseTimes_t *phaseTimes)
+{
+	*phaseTimes = hostPort.phaseTimes;
+}
+
+uint32_t HostPort_IsReceiving()
+{
+	return HostPort_GetSelectedLine()->receiving;
+}
+
+uint32_t HostPort_TakeTelemetryBytes(uint8_t *bytes, uint32_t maxBytes)
+{
+	uint32_t numOfBytes = (hostPort.numOfTelemetryBytes < maxBytes) ? hostPort.numOfTelemetryBytes : maxBytes;
+
+	memcpy(bytes, hostPort.telemetryBytes, numOfBytes);
+	hostPort.numOfTelemetryBytes = 0;
+
+	return numOfBytes;
+}
+
+void HostPort_SetTelemetryStalled(uint32_t stalled)
+{
+	hostPort.telemetryStalled = stalled;
+}
+
+/* gc_port.h */
+void GCPort_Init()
+{
+	HostPort_Reset();
+}
+
+uint32_t GCPort_ReadInputs()
+{
+	return hostPort.inputs;
+}
+
+void GCPort_ReadInputWindow(uint32_t numOfSamples, GCInputWindow_t *window)
+{
+	window->allPushed = 0xFFFFFFFF;
+	window->anyPushed = 0;
+	window->sampleTime = hostPort.cycles;
+
+	for(uint32_t i = 1; (i <= numOfSamples) && (i <= GC_MAX_SAMPLE_WINDOW); i++)
+	{
+		uint32_t sample = hostPort.inputSamples[(hostPort.numOfInputSamples - i) % GC_MAX_SAMPLE_WINDOW];
+		window->allPushed &= sample;
+		window->anyPushed |= sample;
+	}
+}
+
+uint32_t GCPort_GetInputSampleRate()
+{
+#if GC_USE_DMA_SAMPLING
+	return GC_SAMPLE_RATE_HZ;
+#else
+	return 0;
+#endif
+}
+
+uint32_t GCPort_GetCycles()
+{
+	return hostPort.cycles;
+}
+
+void GCPort_WaitForCycles(uint32_t cycles)
+{
+	// Nothing else runs on the host, so the time only has to pass
+	if((int32_t)(cycles - hostPort.cycles) > 0)
+	{
+		HostPort_AdvanceCycles(cycles - hostPort.cycles);
+	}
+}
+
+uint32_t GCPort_LockInputs()
+{
+	// Inputs only change between calls on the host
+	return 0;
+}
+
+void GCPort_UnlockInputs(uint32_t lock)
+{
+	(void)lock;
+}
+
+void GCPort_StartReceiving(uint32_t consolePort)
+{
+	HostPortLine_t *line = &hostPort.lines[consolePort];
+	line->receiving = 1;
+	line->idleChecked = 0;
+	line->rxTimed = 0;
+}
+
+void GCPort_StopReceiving(uint32_t consolePort)
+{
+	HostPortLine_t *line = &hostPort.lines[consolePort];
+	uint64_t nowNs = HostPort_GetNs();
+	hostPort.phaseTimes.receiveNs += nowNs - hostPort.phaseStartNs;
+	hostPort.phaseTimes.numOfCommands++;
+	hostPort.phaseStartNs = nowNs;
+
+	line->receiving = 0;
+
+	// Fully read commands are gone, start the queue over
+	if(line->rxHead == line->rxTail)
+	{
+		line->rxHead = 0;
+		line->rxTail = 0;
+	}
+}
+
+uint32_t GCPort_IsByteReceived(uint32_t consolePort)
+{
+	HostPortLine_t *line = &hostPort.lines[consolePort];
+
+	/* Report an idle line once per listen so the emulation gets to do
+	 * its work between polls, like it does on the uC.
+	 */
+	if(!line->idleChecked)
+	{
+		line->idleChecked = 1;
+		hostPort.phaseStartNs = HostPort_GetNs();
+		return 0;
+	}
+
+	// The emulation is done with the idle time once it checks again
+	if(line->idleChecked == 1)
+	{
+		uint64_t nowNs = HostPort_GetNs();
+		hostPort.phaseTimes.refreshNs += nowNs - hostPort.phaseStartNs;
+		hostPort.phaseTimes.numOfRefreshes++;
+		hostPort.phaseStartNs = nowNs;
+		line->idleChecked = 2;
+	}
+
+	return 1;
+}
+
+uint8_t GCPort_ReceiveByte(uint32_t consolePort)
+{
+	HostPortLine_t *line = &hostPort.lines[consolePort];
+
+	// An empty queue is an idle line, which reads as the stop bit
+	if(line->rxHead == line->rxTail)
+	{
+		return GC_BITS_STOP_BIT;
+	}
+
+	/* Queued bytes follow each other on the line from the first one
+	 * waited for, each one arriving after the time it takes
+	 */
+	uint32_t cyclesPerUartByte = hostPort.cyclesPerUartByte;
+	if(!line->rxTimed)
+	{
+		line->rxTimed = 1;
+		line->rxNextTime = hostPort.cycles + cyclesPerUartByte;
+	}
+	if((int32_t)(line->rxNextTime - hostPort.cycles) > 0)
+	{
+		HostPort_AdvanceCycles(line->rxNextTime - hostPort.cycles);
+	}
+	uint8_t uartByte = line->rxBytes[line->rxHead++];
+	line->rxNextTime += cyclesPerUartByte;
+
+	/* Bytes that arrived while this one was still waiting to be read
+	 * are lost, like an overrun of the one byte data register
+	 */
+	uint32_t isOverrun = 0;
+	while( (cyclesPerUartByte != 0) && (line->rxHead != line->rxTail) &&
+		   ((int32_t)(hostPort.cycles - line->rxNextTime) >= 0) )
+	{
+		line->rxHead++;
+		line->rxNextTime += cyclesPerUartByte;
+		isOverrun = 1;
+	}
+	if(isOverrun)
+	{
+		GCControllerEmulation_ReceiveErrors(consolePort, 0, 1, 0);
+	}
+
+	return uartByte;
+}
+
+void GCPort_PrepareFrame(uint32_t consolePort, const uint32_t *frame, uint32_t numOfGCBytes)
+{
+	HostPortLine_t *line = &hostPort.lines[consolePort];
+	HostPortPreparedFrame_t *prepared = HostPort_FindPreparedFrame(line, frame);
+	if(prepared == NULL)
+	{
+		// A new frame takes the first free place
+		prepared = HostPort_FindPreparedFrame(line, NULL);
+		if(prepared == NULL)
+		{
+			return;
+		}
+	}
+
+	prepared->frame = frame;
+	prepared->numOfGCBytes = numOfGCBytes;
+	memcpy(prepared->frameCopy, frame, numOfGCBytes * sizeof(uint32_t));
+	HostPort_AdvanceCycles(hostPort.cyclesPerFrame);
+}
+
+void GCPort_SendFrame(uint32_t consolePort, const uint32_t *frame, uint32_t numOfGCBytes)
+{
+	HostPortLine_t *line = &hostPort.lines[consolePort];
+	const uint8_t *uartBytes = (const uint8_t *)frame;
+	uint32_t numOfUartBytes = numOfGCBytes * GC_UART_BYTES_PER_GC_BYTE;
+
+	// A port sending a waveform would send what was prepared
+	HostPortPreparedFrame_t *prepared = HostPort_FindPreparedFrame(line, frame);
+	if( (prepared == NULL) || (numOfGCBytes > prepared->numOfGCBytes) ||
+		(memcmp(prepared->frameCopy, frame, numOfGCBytes * sizeof(uint32_t)) != 0) )
+	{
+		line->numOfUnpreparedFrames++;
+	}
+
+	GC_PROFILE_END(GC_PROFILE_TURNAROUND);
+	GC_PROFILE_START(GC_PROFILE_TX);
+	for(uint32_t i = 0; i <= numOfUartBytes; i++)
+	{
+		if(line->numOfTxBytes < HOST_PORT_MAX_UART_BYTES)
+		{
+			// The stop bit goes out last
+			line->txBytes[line->numOfTxBytes++] = (i < numOfUartBytes) ? uartBytes[i] : GC_BITS_STOP_BIT;
+		}
+	}
+	GC_PROFILE_END(GC_PROFILE_TX);
+
+	hostPort.phaseTimes.respondNs += HostPort_GetNs() - hostPort.phaseStartNs;
+	hostPort.phaseTimes.numOfResponses++;
+}
+
+uint32_t GCPort_IsBusy(uint32_t consolePort)
+{
+	(void)consolePort;
+	return 0;
+}
+
+void GCPort_SendTelemetry(const uint8_t *bytes, uint32_t numOfBytes)
+{
+	// The bytes go out at once, a full log drops them like a lost link
+	for(uint32_t i = 0; i < numOfBytes; i++)
+	{
+		if(hostPort.numOfTelemetryBytes < HOST_PORT_MAX_TELEMETRY_BYTES)
+		{
+			hostPort.telemetryBytes[hostPort.numOfTelemetryBytes++] = bytes[i];
+		}
+	}
+}
+
+uint32_t GCPort_IsTelemetryBusy()
+{
+	return hostPort.telemetryStalled;
+}
+
+uint32_t HostPort_GetNumOfFlashWrites()
+{
+	return hostPortFlash.numOfWrites;
+}
+
+uint32_t HostPort_GetNumOfBadFlashWrites()
+{
+	return hostPortFlash.numOfBadWrites;
+}
+
+const uint8_t *GCPort_GetRecordingFlash()
+{
+	// Flash is erased when it leaves the factory
+	if(!hostPortFlash.isSetup)
+	{
+		GCPort_EraseRecordingFlash();
+	}
+	return hostPortFlash.bytes;
+}
+
+void GCPort_EraseRecordingFlash()
+{
+	memset(hostPortFlash.bytes, 0xFF, sizeof(hostPortFlash.bytes));
+	hostPortFlash.isSetup = 1;
+}
+
+void GCPort_ProgramRecordingWord(uint32_t offset, uint32_t word)
+{
+	// The uC would fault on these
+	if((offset & 3) || ((offset + 4) > GC_RECORDING_FLASH_BYTES))
+	{
+		hostPortFlash.numOfBadWrites++;
+		return;
+	}
+
+	uint8_t *bytes = (uint8_t *)GCPort_GetRecordingFlash() + offset;
+	uint32_t isErased = 1;
+	hostPortFlash.numOfWrites++;
+
+	/* Programming only clears bits, little endian like the uC */
+	for(uint32_t i = 0; i < 4; i++)
+	{
+		isErased &= (bytes[i] == 0xFF);
+		bytes[i] &= (uint8_t)(word >> (8 * i));
+	}
+
+	if(!isErased)
+	{
+		hostPortFlash.numOfBadWrites++;
+	}
+}
+
+uint64_t HostPort_GetNs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+HostPortLine_t *HostPort_GetSelectedLine()
+{
+	return &hostPort.lines[hostPort.selectedLine];
+}
+
+HostPortPreparedFrame_t *HostPort_FindPreparedFrame(HostPortLine_t *line, const uint32_t *frame)
+{
+	for(uint32_t i = 0; i < MAX_HOST_PREPARED_FRAMES; i++)
+	{
+		if(line->preparedFrames[i].frame == frame)
+		{
+			return &line->preparedFrames[i];
+		}
+	}
+
+	return NULL;
+}
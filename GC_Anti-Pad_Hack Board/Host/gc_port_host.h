@@ -0,0 +1,140 @@
+#ifndef GC_PORT_HOST_H_
+#define GC_PORT_HOST_H_
+
+#include <stdint.h>
+#include "gc_port.h"
+
+// Notes //
+/* NOTE 1:
+ * PC version of gc_port.h. Instead of the USARTs and the GPIO ports it
+ * keeps a model of them in memory:
+ *
+ * - RX: UART bytes queued by the caller, as the console would put them
+ *   on the GC data line. When the queue runs dry the line reads idle,
+ *   which is the stop bit UART byte.
+ * - TX: every UART byte of a sent frame is logged, followed by
+ *   GC_BITS_STOP_BIT for the stop bit made on the GC_STOP pin. Frames
+ *   sent without being prepared as they are, see GCPort_PrepareFrame,
+ *   are counted.
+ * - Inputs: a packed input word, set bit means PUSHED. The last
+ *   GC_MAX_SAMPLE_WINDOW words are kept as background samples.
+ * - Cycles: a counter the caller moves forward. The emulation only
+ *   moves it by waiting for a cycle, or for UART bytes to arrive.
+ * - Telemetry: every byte sent out of the expansion port is logged. The
+ *   caller can stall the port to fill the telemetry ring.
+ * - Recording flash: a region of memory that starts erased. Programming
+ *   can only clear bits, like the flash, and a word programmed twice
+ *   without an erase is counted. A reset keeps it, like a power cycle.
+ *
+ * The port also measures the real time the emulation spends in each
+ * phase of answering a command, see HostPortPhaseTimes_t.
+ */
+
+/* NOTE 2:
+ * Every console port has a GC data line of its own. The helpers below
+ * that queue, take or count something of a line act on the one picked
+ * with HostPort_SelectConsolePort, port 0 after a reset.
+ *
+ * With GC_USE_DMA_RX nothing asks the port for UART bytes, so the
+ * caller hands them to the emulation with HostPort_DeliverUartBytes
+ * where the USART interrupt would.
+ */
+
+// Public Macros //
+/* UART bytes the host port can hold in each direction */
+#define HOST_PORT_MAX_UART_BYTES	1024
+
+/* Telemetry bytes the host port can hold */
+#define HOST_PORT_MAX_TELEMETRY_BYTES	4096
+
+// Public Structures //
+/* Total nanoseconds spent by the emulation in each phase.
+ * refresh:  sampling, processing and encoding while the line is idle
+ * receive:  decoding the UART bytes of the command
+ * respond:  from the end of the command to the end of the response
+ */
+typedef struct
+{
+	uint64_t refreshNs;
+	uint64_t receiveNs;
+	uint64_t respondNs;
+	uint32_t numOfRefreshes;
+	uint32_t numOfCommands;
+	uint32_t numOfResponses;
+} HostPortPhaseTimes_t;
+
+// Public Function Prototypes //
+/* Empties the line, releases every button and clears the cycle counter */
+void HostPort_Reset(void);
+
+/* Sets the packed button inputs, as if they were held for every
+ * background sample
+ */
+void HostPort_SetInputs(uint32_t);
+
+/* Sets the packed button inputs for one more background sample */
+void HostPort_AddInputSample(uint32_t);
+
+/* Sets the packed button inputs once the cycle counter reaches the
+ * given cycle, like HostPort_SetInputs
+ */
+void HostPort_SetInputsAt(uint32_t, uint32_t);
+
+/* Picks the console port the line helpers act on */
+void HostPort_SelectConsolePort(uint32_t);
+
+/* Queues UART bytes sent by the console */
+void HostPort_QueueUartBytes(const uint8_t *, uint32_t);
+
+/* Queues a console command, encoded and ended with a stop bit */
+void HostPort_QueueCommand(const uint8_t *, uint32_t);
+
+/* Gets the UART bytes sent since the last call, returns how many */
+uint32_t HostPort_TakeSentBytes(uint8_t *, uint32_t);
+
+/* Hands the queued UART bytes to the emulation while it is receiving,
+ * with GC_USE_DMA_RX. Bytes left after a command ended are skipped.
+ */
+void HostPort_DeliverUartBytes(void);
+
+/* Moves the cycle counter forward */
+void HostPort_AdvanceCycles(uint32_t);
+
+/* Moves the cycle counter forward by the given amount for every queued
+ * UART byte received, 0 by default. The bytes then keep arriving at
+ * that pace without GC_USE_DMA_RX, and those that arrive while the one
+ * before them is not read yet are lost to an overrun.
+ */
+void HostPort_SetCyclesPerUartByte(uint32_t);
+
+/* Moves the cycle counter forward by the given amount for every frame
+ * prepared, like rendering a waveform would, 0 by default
+ */
+void HostPort_SetCyclesPerFrame(uint32_t);
+
+/* Gets how many frames were sent that were not prepared first, or
+ * changed after they were
+ */
+uint32_t HostPort_GetNumOfUnpreparedFrames(void);
+
+/* Gets the time spent in each phase so far */
+void HostPort_GetPhaseTimes(HostPortPhaseTimes_t *);
+
+/* Returns 1 while the receiver is enabled */
+uint32_t HostPort_IsReceiving(void);
+
+/* Gets the telemetry bytes sent since the last call, returns how many */
+uint32_t HostPort_TakeTelemetryBytes(uint8_t *, uint32_t);
+
+/* Keeps the expansion port busy while set, like a slow link would */
+void HostPort_SetTelemetryStalled(uint32_t);
+
+/* Gets how many words of the recording flash were programmed */
+uint32_t HostPort_GetNumOfFlashWrites(void);
+
+/* Gets how many words of the recording flash were programmed without
+ * being erased first
+ */
+uint32_t HostPort_GetNumOfBadFlashWrites(void);
+
+#endif /* GC_PORT_HOST_H_ */
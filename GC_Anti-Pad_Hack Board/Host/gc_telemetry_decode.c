@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gc_telemetry.h"
+
+/* Turns the expansion port telemetry stream back into one line of text
+ * per record. Reads a file, or stdin so it can sit behind a serial port:
+ *
+ *   stty -F /dev/ttyUSB0 1000000 raw && ./gc_telemetry_decode /dev/ttyUSB0
+ *
+ * -c sets the cycle counter clock in Hz used to print times (default
+ * 100 MHz). The stream is resynced on the sync byte and checksum, and
+ * the sequence shows records lost on the uC or on the link. Needs a
+ * little endian PC, like the uC.
+ */
+
+// Macros //
+#define DEFAULT_CYCLE_CLOCK_HZ	100000000.0
+
+// Structures //
+/* What was seen in the whole stream */
+typedef struct
+{
+	uint32_t numOfRecords;
+	uint32_t numOfLost;
+	uint32_t numOfSkippedBytes;
+} DecodeStats_t;
+
+// Variables //
+static const char * const commandNames[] =
+{
+	"PROBE",
+	"PROBE_ORIGIN",
+	"POLL_RUMBLE_OFF",
+	"POLL_RUMBLE_ON",
+	"NONE",
+	"RESET",
+	"CALIBRATE",
+	"POLL_BRAKE"
+};
+
+// Function Prototypes //
+static uint32_t IsRecordValid(const uint8_t *);
+static void PrintRecord(const GCTelemetryRecord_t *, double);
+
+// Function Implementations //
+int main(int argc, char **argv)
+{
+	const char *path = NULL;
+	double cycleClockHz = DEFAULT_CYCLE_CLOCK_HZ;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if( (strcmp(argv[i], "-c") == 0) && (i + 1 < argc) )
+		{
+			cycleClockHz = strtod(argv[++i], NULL);
+		}
+		else if(path == NULL)
+		{
+			path = argv[i];
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [-c cycle_clock_hz] [file]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	FILE *stream = stdin;
+	if( (path != NULL) && (strcmp(path, "-") != 0) )
+	{
+		stream = fopen(path, "rb");
+		if(stream == NULL)
+		{
+			perror(path);
+			return 1;
+		}
+	}
+
+	// Show records as they come when reading a live link
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	DecodeStats_t stats = {0};
+	uint8_t window[GC_TELEMETRY_RECORD_BYTES];
+	uint32_t numInWindow = 0;
+	uint32_t nextSequence = 0;
+	uint32_t haveSequence = 0;
+	int c;
+
+	while((c = fgetc(stream)) != EOF)
+	{
+		window[numInWindow++] = (uint8_t)c;
+
+		// A record starts with the sync byte, anything else is skipped
+		if(window[0] != GC_TELEMETRY_SYNC)
+		{
+			numInWindow = 0;
+			stats.numOfSkippedBytes++;
+			continue;
+		}
+
+		if(numInWindow < GC_TELEMETRY_RECORD_BYTES)
+		{
+			continue;
+		}
+
+		/* A bad checksum means the sync byte was part of something else,
+		 * look for the next one in what was read
+		 */
+		if(!IsRecordValid(window))
+		{
+			uint32_t next = 1;
+			while( (next < numInWindow) && (window[next] != GC_TELEMETRY_SYNC) )
+			{
+				next++;
+			}
+			stats.numOfSkippedBytes += next;
+			memmove(window, &window[next], numInWindow - next);
+			numInWindow -= next;
+			continue;
+		}
+
+		GCTelemetryRecord_t record;
+		memcpy(&record, window, sizeof(record));
+		numInWindow = 0;
+
+		if(haveSequence)
+		{
+			stats.numOfLost += (uint8_t)(record.sequence - nextSequence);
+		}
+		nextSequence = (uint8_t)(record.sequence + 1);
+		haveSequence = 1;
+		stats.numOfRecords++;
+
+		PrintRecord(&record, cycleClockHz);
+	}
+
+	if(stream != stdin)
+	{
+		fclose(stream);
+	}
+
+	fprintf(stderr, "%u records, %u lost, %u bytes skipped\n",
+			stats.numOfRecords, stats.numOfLost, stats.numOfSkippedBytes);
+
+	return 0;
+}
+
+uint32_t IsRecordValid(const uint8_t *recordBytes)
+{
+	uint16_t checksum = 0;
+	for(uint32_t i = 0; i < (GC_TELEMETRY_RECORD_BYTES - 2); i++)
+	{
+		checksum += recordBytes[i];
+	}
+
+	uint16_t sentChecksum = (uint16_t)(recordBytes[GC_TELEMETRY_RECORD_BYTES - 2] |
+									   (recordBytes[GC_TELEMETRY_RECORD_BYTES - 1] << 8));
+
+	return (checksum == sentChecksum) ? 1 : 0;
+}
+
+void PrintRecord(const GCTelemetryRecord_t *record, double cycleClockHz)
+{
+	double usPerCycle = 1000000.0 / cycleClockHz;
+
+	printf("#%03u %12.3f us P%u ", record->sequence, record->timestamp * usPerCycle, GC_TELEMETRY_PORT(record->flags));
+
+	if(record->command < (sizeof(commandNames) / sizeof(commandNames[0])))
+	{
+		printf("%-15s", commandNames[record->command]);
+	}
+	else
+	{
+		printf("COMMAND_%-7u", record->command);
+	}
+
+	// The command bytes, or BAD for a command that could not be decoded
+	if(record->flags & GC_TELEMETRY_FLAG_BAD_COMMAND)
+	{
+		printf(" [BAD     ]");
+	}
+	else
+	{
+		char bytes[3 * GC_TELEMETRY_COMMAND_BYTES + 1] = "";
+		uint32_t length = 0;
+		for(uint32_t i = 0; (i < record->numOfGCBytes) && (i < GC_TELEMETRY_COMMAND_BYTES); i++)
+		{
+			length += snprintf(&bytes[length], sizeof(bytes) - length, (i == 0) ? "%02X" : " %02X", record->gcBytes[i]);
+		}
+		printf(" [%-8s]", bytes);
+	}
+
+	printf(" inputs %06X age %8.3f us rumble %s",
+		   record->inputs, record->inputAge * usPerCycle,
+		   (record->flags & GC_TELEMETRY_FLAG_RUMBLE) ? "on " : "off");
+
+	printf(" | fe %u oe %u ne %u bad %u dropped %u",
+		   record->framingErrors, record->overrunErrors, record->noiseErrors,
+		   record->numOfBadCommands, record->numOfDropped);
+
+	printf(" | cycles rx %u turnaround %u tx %u refresh %u\n",
+		   record->commandRxCycles, record->turnaroundCycles, record->txCycles, record->refreshCycles);
+}
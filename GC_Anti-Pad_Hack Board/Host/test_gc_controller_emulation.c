@@ -0,0 +1,1755 @@
+#include <stdio.h>
+#include <string.h>
+#include "gc_controller_emulation.h"
+#include "gc_controller_reader.h"
+#include "gc_port_host.h"
+#include "gc_profile.h"
+#include "gc_telemetry.h"
+#include "gc_input_edges.h"
+#include "gc_capture_rx.h"
+#include "gc_waveform.h"
+#include "gc_macro.h"
+#include "gc_recording.h"
+
+// Macros //
+/* Records a failed check without stopping the test */
+#define CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			numOfFailures++; \
+		} \
+	} while(0)
+
+#define NUM_OF_INPUT_COMBINATIONS	(1UL << NUM_OF_GC_BUTTON_INPUTS)
+
+// Variables //
+static uint32_t numOfFailures = 0;
+
+// Function Implementations //
+/* Controller state as the original firmware built it, one button at a
+ * time. Every optimized path must produce exactly these bytes.
+ */
+static void ReferenceControllerState(uint32_t pushed, uint8_t *gcBytes)
+{
+	#define IS_PUSHED(gcButton)	((pushed >> (gcButton)) & 1UL)
+
+	uint32_t left = IS_PUSHED(GC_MAIN_STICK_LEFT), right = IS_PUSHED(GC_MAIN_STICK_RIGHT);
+	uint32_t down = IS_PUSHED(GC_MAIN_STICK_DOWN), up = IS_PUSHED(GC_MAIN_STICK_UP);
+	uint32_t cLeft = IS_PUSHED(GC_C_STICK_LEFT), cRight = IS_PUSHED(GC_C_STICK_RIGHT);
+	uint32_t cDown = IS_PUSHED(GC_C_STICK_DOWN), cUp = IS_PUSHED(GC_C_STICK_UP);
+	uint32_t dLeft = IS_PUSHED(GC_DPAD_LEFT), dRight = IS_PUSHED(GC_DPAD_RIGHT);
+	uint32_t dDown = IS_PUSHED(GC_DPAD_DOWN), dUp = IS_PUSHED(GC_DPAD_UP);
+	uint32_t tilt = IS_PUSHED(GC_TILT);
+
+	// Clean to neutral
+	if(left && right) { left = 0; right = 0; }
+	if(down && up) { down = 0; up = 0; }
+	if(cLeft && cRight) { cLeft = 0; cRight = 0; }
+	if(cDown && cUp) { cDown = 0; cUp = 0; }
+	if(dLeft && dRight) { dLeft = 0; dRight = 0; }
+	if(dDown && dUp) { dDown = 0; dUp = 0; }
+
+	gcBytes[0] = (IS_PUSHED(GC_START) << 4) | (IS_PUSHED(GC_Y) << 3) | (IS_PUSHED(GC_X) << 2) |
+				 (IS_PUSHED(GC_B) << 1) | IS_PUSHED(GC_A);
+	gcBytes[1] = 0x80 | (IS_PUSHED(GC_L) << 6) | (IS_PUSHED(GC_R) << 5) | (IS_PUSHED(GC_Z) << 4) |
+				 (dUp << 3) | (dDown << 2) | (dRight << 1) | dLeft;
+	gcBytes[2] = left ? (tilt ? 0x4C : 0x00) : right ? (tilt ? 0xB1 : 0xFF) : 0x80;
+	gcBytes[3] = down ? (tilt ? 0x4C : 0x00) : up ? (tilt ? 0xFF : 0xB1) : 0x80;
+	gcBytes[4] = cLeft ? 0x00 : cRight ? 0xFF : 0x80;
+	gcBytes[5] = cDown ? 0x00 : cUp ? 0xB1 : 0x80;
+	gcBytes[6] = 0x00;
+	gcBytes[7] = 0x00;
+	gcBytes[8] = 0x00;
+	gcBytes[9] = 0x00;
+
+	#undef IS_PUSHED
+}
+
+/* Builds the UART bytes a response must be on the line */
+static uint32_t ExpectedUartBytes(const uint8_t *gcBytes, uint32_t numOfGCBytes, uint8_t *uartBytes)
+{
+	static const uint8_t bitPairToUart[4] = {GC_BITS_00_CASE1, GC_BITS_01_CASE1, GC_BITS_10_CASE1, GC_BITS_11_CASE1};
+	uint32_t numOfUartBytes = 0;
+
+	for(uint32_t i = 0; i < numOfGCBytes; i++)
+	{
+		for(int32_t shift = 6; shift >= 0; shift -= 2)
+		{
+			uartBytes[numOfUartBytes++] = bitPairToUart[(gcBytes[i] >> shift) & 0x03];
+		}
+	}
+	uartBytes[numOfUartBytes++] = GC_BITS_STOP_BIT;
+
+	return numOfUartBytes;
+}
+
+/* One pass of the emulation loop, and the USART interrupt of the
+ * selected console port with GC_USE_DMA_RX
+ */
+static void RunEmulation(void)
+{
+	GCControllerEmulation_RunOnce();
+#if GC_USE_DMA_RX
+	HostPort_DeliverUartBytes();
+#endif
+}
+
+/* Sends a command and gets the response */
+static uint32_t Exchange(const uint8_t *command, uint32_t numOfCommandBytes, uint8_t *response)
+{
+	HostPort_QueueCommand(command, numOfCommandBytes);
+	RunEmulation();
+	return HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+}
+
+/* Polls and returns 1 if the response is the reference for the inputs */
+static uint32_t IsPollResponse(uint32_t pushed)
+{
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	uint8_t gcBytes[GC_MAX_RESPONSE_BYTES];
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+
+	ReferenceControllerState(pushed, gcBytes);
+	uint32_t numOfExpected = ExpectedUartBytes(gcBytes, 8, expected);
+	uint32_t numOfResponse = Exchange(poll, sizeof(poll), response);
+
+	return (numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0);
+}
+
+static void TestJoybusTables(void)
+{
+	for(uint32_t gcByte = 0; gcByte < 256; gcByte++)
+	{
+		uint8_t expected[GC_UART_BYTES_PER_GC_BYTE + 1];
+		uint8_t gcByteValue = (uint8_t)gcByte;
+		uint32_t frame;
+
+		ExpectedUartBytes(&gcByteValue, 1, expected);
+		GCJoybus_EncodeFrame(&gcByteValue, 1, &frame);
+		CHECK(memcmp(&frame, expected, GC_UART_BYTES_PER_GC_BYTE) == 0);
+	}
+
+	CHECK(gcJoybusDecodeTable[GC_BITS_00_CASE1] == 0 && gcJoybusDecodeTable[GC_BITS_00_CASE2] == 0);
+	CHECK(gcJoybusDecodeTable[GC_BITS_01_CASE1] == 1 && gcJoybusDecodeTable[GC_BITS_01_CASE2] == 1);
+	CHECK(gcJoybusDecodeTable[GC_BITS_10_CASE1] == 2 && gcJoybusDecodeTable[GC_BITS_10_CASE2] == 2);
+	CHECK(gcJoybusDecodeTable[GC_BITS_11_CASE1] == 3 && gcJoybusDecodeTable[GC_BITS_11_CASE2] == 3);
+	CHECK(gcJoybusDecodeTable[GC_BITS_STOP_BIT] == GC_JOYBUS_STOP_BIT);
+	CHECK(gcJoybusDecodeTable[0x00] == GC_JOYBUS_INVALID_BITS);
+}
+
+static void TestProbe(void)
+{
+	static const uint8_t probe[] = {GC_JOYBUS_COMMAND_PROBE};
+	static const uint8_t probeResponse[] = {0x09, 0x00, 0x03};
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+
+	uint32_t numOfExpected = ExpectedUartBytes(probeResponse, sizeof(probeResponse), expected);
+	uint32_t numOfResponse = Exchange(probe, sizeof(probe), response);
+	CHECK(numOfResponse == numOfExpected);
+	CHECK(memcmp(response, expected, numOfExpected) == 0);
+}
+
+/* Every input combination through POLL must match the reference */
+static void TestPollAllInputs(void)
+{
+	uint32_t numOfMismatches = 0;
+
+	for(uint32_t pushed = 0; pushed < NUM_OF_INPUT_COMBINATIONS; pushed++)
+	{
+#if GC_USE_MACROS
+		// MACRO picks sequences instead, see TestMacros
+		if(pushed & GC_BUTTON_MASK(GC_MACRO))
+		{
+			continue;
+		}
+#endif
+		HostPort_SetInputs(pushed);
+		if(!IsPollResponse(pushed))
+		{
+			if(numOfMismatches++ == 0)
+			{
+				printf("first POLL mismatch with inputs 0x%06X\n", pushed);
+			}
+		}
+	}
+
+	CHECK(numOfMismatches == 0);
+}
+
+static void TestProbeOriginAndRumble(void)
+{
+	static const uint8_t probeOrigin[] = {GC_JOYBUS_COMMAND_PROBE_ORIGIN};
+	static const uint8_t pollRumbleOn[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x01};
+	uint32_t pushed = GC_BUTTON_MASK(GC_A) | GC_BUTTON_MASK(GC_MAIN_STICK_UP) | GC_BUTTON_MASK(GC_TILT);
+	uint8_t gcBytes[GC_MAX_RESPONSE_BYTES];
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+
+	HostPort_SetInputs(pushed);
+	ReferenceControllerState(pushed, gcBytes);
+
+	uint32_t numOfExpected = ExpectedUartBytes(gcBytes, 10, expected);
+	uint32_t numOfResponse = Exchange(probeOrigin, sizeof(probeOrigin), response);
+	CHECK(numOfResponse == numOfExpected);
+	CHECK(memcmp(response, expected, numOfExpected) == 0);
+
+	numOfExpected = ExpectedUartBytes(gcBytes, 8, expected);
+	numOfResponse = Exchange(pollRumbleOn, sizeof(pollRumbleOn), response);
+	CHECK(numOfResponse == numOfExpected);
+	CHECK(memcmp(response, expected, numOfExpected) == 0);
+}
+
+/* Lays the standard response out like a poll mode does, from
+ * Note 4 of gc_controller_emulation.h
+ */
+static void ReferencePollMode(const uint8_t *standard, uint32_t pollMode, uint8_t *gcBytes)
+{
+	#define NIBBLES(high, low)	((uint8_t)(((high) & 0xF0) | ((low) >> 4)))
+
+	const uint8_t cX = standard[4], cY = standard[5], l = standard[6], r = standard[7];
+	const uint8_t a = standard[8], b = standard[9];
+	const uint8_t layouts[5][4] =
+	{
+		{cX, cY, NIBBLES(l, r), NIBBLES(a, b)},
+		{NIBBLES(cX, cY), l, r, NIBBLES(a, b)},
+		{NIBBLES(cX, cY), NIBBLES(l, r), a, b},
+		{cX, cY, l, r},
+		{cX, cY, a, b}
+	};
+
+	memcpy(gcBytes, standard, 4);
+	memcpy(&gcBytes[4], layouts[(pollMode <= 4) ? pollMode : 0], 4);
+
+	#undef NIBBLES
+}
+
+/* Every poll mode gets its own layout, the first poll after a change of
+ * mode as well as the ones after it
+ */
+static void TestPollModes(void)
+{
+	static const uint32_t inputs[] =
+	{
+		0,
+		GC_BUTTON_MASK(GC_B) | GC_BUTTON_MASK(GC_C_STICK_RIGHT) | GC_BUTTON_MASK(GC_C_STICK_UP),
+		GC_BUTTON_MASK(GC_Z) | GC_BUTTON_MASK(GC_MAIN_STICK_LEFT) | GC_BUTTON_MASK(GC_TILT) | GC_BUTTON_MASK(GC_C_STICK_DOWN)
+	};
+	uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x00, 0x00};
+	uint8_t standard[GC_MAX_RESPONSE_BYTES];
+	uint8_t gcBytes[GC_MAX_RESPONSE_BYTES];
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+
+	for(uint32_t i = 0; i < (sizeof(inputs) / sizeof(inputs[0])); i++)
+	{
+		HostPort_SetInputs(inputs[i]);
+		ReferenceControllerState(inputs[i], standard);
+
+		for(uint32_t pollMode = 0; pollMode < 8; pollMode++)
+		{
+			poll[1] = (uint8_t)pollMode;
+			poll[2] = (uint8_t)(pollMode % 3);
+			ReferencePollMode(standard, pollMode, gcBytes);
+			uint32_t numOfExpected = ExpectedUartBytes(gcBytes, 8, expected);
+			for(uint32_t j = 0; j < 2; j++)
+			{
+				uint32_t numOfResponse = Exchange(poll, sizeof(poll), response);
+				CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+			}
+		}
+	}
+
+	/* Back to the standard mode for the tests after this one */
+	poll[1] = 0x03;
+	poll[2] = 0x00;
+	Exchange(poll, sizeof(poll), response);
+	Exchange(poll, sizeof(poll), response);
+	HostPort_SetInputs(0);
+}
+
+/* RESET is answered like PROBE, and CALIBRATE like PROBE ORIGIN in any
+ * poll mode
+ */
+static void TestResetAndCalibrate(void)
+{
+	static const uint8_t reset[] = {GC_JOYBUS_COMMAND_RESET};
+	static const uint8_t calibrate[] = {GC_JOYBUS_COMMAND_CALIBRATE, 0x00, 0x00};
+	static const uint8_t shortCalibrate[] = {GC_JOYBUS_COMMAND_CALIBRATE};
+	static const uint8_t probeOrigin[] = {GC_JOYBUS_COMMAND_PROBE_ORIGIN};
+	static const uint8_t pollMode0[] = {GC_JOYBUS_COMMAND_POLL, 0x00, 0x00};
+	static const uint8_t probeResponse[] = {0x09, 0x00, 0x03};
+	uint32_t pushed = GC_BUTTON_MASK(GC_X) | GC_BUTTON_MASK(GC_C_STICK_LEFT);
+	uint8_t gcBytes[GC_MAX_RESPONSE_BYTES];
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+
+	HostPort_SetInputs(pushed);
+	ReferenceControllerState(pushed, gcBytes);
+	uint32_t numOfExpected = ExpectedUartBytes(gcBytes, 10, expected);
+
+	Exchange(pollMode0, sizeof(pollMode0), response);
+	Exchange(pollMode0, sizeof(pollMode0), response);
+	uint32_t numOfResponse = Exchange(calibrate, sizeof(calibrate), response);
+	CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+	numOfResponse = Exchange(probeOrigin, sizeof(probeOrigin), response);
+	CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+	CHECK(Exchange(shortCalibrate, sizeof(shortCalibrate), response) == 0);
+
+	numOfExpected = ExpectedUartBytes(probeResponse, sizeof(probeResponse), expected);
+	numOfResponse = Exchange(reset, sizeof(reset), response);
+	CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+
+	/* Polls are answered as before after a RESET */
+	Exchange(reset, sizeof(reset), response);
+	CHECK(IsPollResponse(pushed));
+
+	HostPort_SetInputs(0);
+}
+
+/* Commands that must not be answered */
+static void TestIgnoredCommands(void)
+{
+	static const uint8_t unknown[] = {0x14};
+	static const uint8_t badPoll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x03};
+	static const uint8_t badPollMode[] = {GC_JOYBUS_COMMAND_POLL, 0x08, 0x00};
+	static const uint8_t longProbe[] = {GC_JOYBUS_COMMAND_PROBE, 0x00};
+	static const uint8_t midFrame[] = {GC_BITS_01_CASE1, GC_BITS_00_CASE1, GC_BITS_STOP_BIT};
+	static const uint8_t badByte[] = {0x12, GC_BITS_00_CASE1, GC_BITS_00_CASE1, GC_BITS_00_CASE1, GC_BITS_STOP_BIT};
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCRxStats_t before, after;
+
+	GCControllerEmulation_GetRxStats(0, &before);
+
+	CHECK(Exchange(unknown, sizeof(unknown), response) == 0);
+	CHECK(Exchange(badPoll, sizeof(badPoll), response) == 0);
+	CHECK(Exchange(badPollMode, sizeof(badPollMode), response) == 0);
+	CHECK(Exchange(longProbe, sizeof(longProbe), response) == 0);
+
+	HostPort_QueueUartBytes(midFrame, sizeof(midFrame));
+	RunEmulation();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == 0);
+
+	HostPort_QueueUartBytes(badByte, sizeof(badByte));
+	RunEmulation();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == 0);
+
+	GCControllerEmulation_GetRxStats(0, &after);
+	CHECK(after.numOfBadCommands - before.numOfBadCommands == 2);
+	CHECK(after.numOfCommands - before.numOfCommands == 4);
+}
+
+/* Both UART bytes of a bit pair are the same bits */
+static void TestBitErrorTolerance(void)
+{
+	static const uint8_t poll[] =
+	{
+		GC_BITS_01_CASE2, GC_BITS_00_CASE2, GC_BITS_00_CASE1, GC_BITS_00_CASE2,
+		GC_BITS_00_CASE1, GC_BITS_00_CASE2, GC_BITS_00_CASE1, GC_BITS_11_CASE2,
+		GC_BITS_00_CASE2, GC_BITS_00_CASE1, GC_BITS_00_CASE2, GC_BITS_00_CASE1,
+		GC_BITS_STOP_BIT
+	};
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+
+	HostPort_QueueUartBytes(poll, sizeof(poll));
+	RunEmulation();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == (8 * GC_UART_BYTES_PER_GC_BYTE) + 1);
+}
+
+/* Feeds the edges of the given bits and a stop bit to the capture
+ * receiver, with times in timer counts, and gets its UART bytes
+ */
+static uint32_t CaptureBits(const uint8_t *gcBytes, uint32_t numOfBits, uint16_t time, const uint16_t *timing, uint8_t *uartBytes)
+{
+	GCCaptureRx_t rx;
+	uint32_t numOfUartBytes = 0;
+
+	GCCaptureRx_Reset(&rx);
+	for(uint32_t bit = 0; bit <= numOfBits; bit++)
+	{
+		uint32_t isOne = (bit == numOfBits) ? 1 : ((gcBytes[bit / 8] >> (7 - (bit % 8))) & 1);
+		numOfUartBytes += GCCaptureRx_Edge(&rx, time, &uartBytes[numOfUartBytes]);
+		numOfUartBytes += GCCaptureRx_Edge(&rx, (uint16_t)(time + timing[isOne ? 1 : 2]), &uartBytes[numOfUartBytes]);
+		time = (uint16_t)(time + timing[0]);
+	}
+
+	return numOfUartBytes + GCCaptureRx_Idle(&rx, &uartBytes[numOfUartBytes]);
+}
+
+/* The capture receiver gives the UART bytes of a command at any console
+ * clock, and the emulation answers them
+ */
+static void TestCaptureRx(void)
+{
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x01};
+
+	/* Bit, 1 low and 0 low times at 100 MHz. Nominal, console clock 15%
+	 * slow and fast, lopsided low times and a slow timer clock.
+	 */
+	static const uint16_t timings[][3] =
+	{
+		{400, 100, 300},
+		{460, 115, 345},
+		{340, 85, 255},
+		{400, 150, 250},
+		{48, 12, 36}
+	};
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t uartBytes[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	uint32_t numOfExpected = ExpectedUartBytes(poll, sizeof(poll), expected);
+
+	for(uint32_t i = 0; i < sizeof(timings) / sizeof(timings[0]); i++)
+	{
+		// The timer wraps in the middle of the command
+		uint32_t numOfUartBytes = CaptureBits(poll, sizeof(poll) * 8, 0xFF00, timings[i], uartBytes);
+		CHECK((numOfUartBytes == numOfExpected) && (memcmp(uartBytes, expected, numOfExpected) == 0));
+	}
+
+	HostPort_QueueUartBytes(uartBytes, numOfExpected);
+	RunEmulation();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == (8 * GC_UART_BYTES_PER_GC_BYTE) + 1);
+
+	/* A bit left over is an invalid UART byte before the stop bit */
+	CHECK(CaptureBits(poll, 9, 0, timings[0], uartBytes) == 6);
+	CHECK(GC_JOYBUS_DECODE(uartBytes[4]) == GC_JOYBUS_INVALID_BITS);
+	CHECK(uartBytes[5] == GC_BITS_STOP_BIT);
+
+	/* An idle line gives nothing */
+	GCCaptureRx_t rx;
+	GCCaptureRx_Reset(&rx);
+	CHECK(GCCaptureRx_Idle(&rx, uartBytes) == 0);
+}
+
+/* Sequences step once per poll, hold what they were told to and never
+ * run more than the op limit for one poll
+ */
+static void TestMacroBytecode(void)
+{
+	static const uint8_t longStep[] =
+	{
+		GC_MACRO_PRESS(GC_BUTTON_MASK(GC_A)), GC_MACRO_PRESS(GC_BUTTON_MASK(GC_B)),
+		GC_MACRO_PRESS(GC_BUTTON_MASK(GC_X)), GC_MACRO_PRESS(GC_BUTTON_MASK(GC_Y)),
+		GC_MACRO_PRESS(GC_BUTTON_MASK(GC_L)), GC_MACRO_PRESS(GC_BUTTON_MASK(GC_R)),
+		GC_MACRO_PRESS(GC_BUTTON_MASK(GC_Z)), GC_MACRO_PRESS(GC_BUTTON_MASK(GC_START)),
+		GC_MACRO_PRESS(GC_BUTTON_MASK(GC_DPAD_UP)), GC_MACRO_WAIT(0),
+		GC_MACRO_END()
+	};
+	static const uint8_t stickAndWait[] =
+	{
+		GC_MACRO_PRESS(GC_BUTTON_MASK(GC_C_STICK_UP) | GC_BUTTON_MASK(GC_A)),
+		GC_MACRO_STICK(GC_BUTTON_MASK(GC_MAIN_STICK_LEFT) | GC_BUTTON_MASK(GC_TILT)), GC_MACRO_WAIT(3),
+		GC_MACRO_RELEASE(GC_BUTTON_MASK(GC_A)), GC_MACRO_WAIT(1),
+		GC_MACRO_END()
+	};
+	static const uint8_t unknownOp[] = {0x7F, GC_MACRO_WAIT(1), GC_MACRO_END()};
+	static const uint8_t nothing[] = {GC_MACRO_END()};
+	static const uint8_t * const sequences[GC_MACRO_NUM_OF_SLOTS] = {longStep, stickAndWait, unknownOp, nothing};
+	const uint32_t macro = GC_BUTTON_MASK(GC_MACRO);
+	const uint32_t player = GC_BUTTON_MASK(GC_L) | GC_BUTTON_MASK(GC_MAIN_STICK_UP);
+	const uint32_t eightButtons = 0xFF;
+	const uint32_t stick = GC_BUTTON_MASK(GC_MAIN_STICK_LEFT) | GC_BUTTON_MASK(GC_TILT);
+	GCMacro_t engine;
+
+	GCMacro_Init(&engine, sequences);
+
+	/* Nothing picked, nothing plays */
+	CHECK(GCMacro_Apply(&engine, player | GC_BUTTON_MASK(GC_B)) == (player | GC_BUTTON_MASK(GC_B)));
+	GCMacro_Poll(&engine);
+	CHECK(!GCMacro_IsPlaying(&engine));
+
+	/* B picks slot 1 and is not sent, holding it picks nothing more */
+	CHECK(GCMacro_Apply(&engine, macro) == macro);
+	CHECK(GCMacro_Apply(&engine, macro | GC_BUTTON_MASK(GC_B)) == macro);
+	CHECK(GCMacro_Apply(&engine, macro | GC_BUTTON_MASK(GC_B)) == macro);
+	CHECK(!GCMacro_IsPlaying(&engine));
+
+	/* STICK replaces the stick inputs PRESS set, and WAIT 3 sends the
+	 * same for 3 polls
+	 */
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		GCMacro_Poll(&engine);
+		CHECK(GCMacro_IsPlaying(&engine));
+		CHECK(GCMacro_Apply(&engine, player) == (GC_BUTTON_MASK(GC_A) | stick));
+	}
+	GCMacro_Poll(&engine);
+	CHECK(GCMacro_Apply(&engine, player) == stick);
+	GCMacro_Poll(&engine);
+	CHECK(!GCMacro_IsPlaying(&engine));
+	CHECK(GCMacro_Apply(&engine, player) == player);
+
+	/* A step longer than the op limit goes on at the next poll, and a
+	 * pick while playing is dropped
+	 */
+	CHECK(GCMacro_Apply(&engine, macro | GC_BUTTON_MASK(GC_A)) == macro);
+	GCMacro_Poll(&engine);
+	CHECK(GCMacro_Apply(&engine, 0) == eightButtons);
+	CHECK(GCMacro_Apply(&engine, macro | GC_BUTTON_MASK(GC_B)) == eightButtons);
+	GCMacro_Poll(&engine);
+	CHECK(GCMacro_Apply(&engine, 0) == (eightButtons | GC_BUTTON_MASK(GC_DPAD_UP)));
+	GCMacro_Poll(&engine);
+	CHECK(!GCMacro_IsPlaying(&engine));
+	GCMacro_Poll(&engine);
+	CHECK(!GCMacro_IsPlaying(&engine));
+
+	/* An unknown op ends the sequence like END */
+	GCMacro_Apply(&engine, 0);
+	GCMacro_Apply(&engine, macro | GC_BUTTON_MASK(GC_X));
+	GCMacro_Poll(&engine);
+	CHECK(!GCMacro_IsPlaying(&engine));
+	CHECK(GCMacro_Apply(&engine, player) == player);
+}
+
+/* Copies the whole words queued by a writer into bytes from the given
+ * offset, as flash would get them. Returns the offset after them.
+ */
+static uint32_t TakeRecordedWords(GCRecordingWriter_t *writer, uint8_t *bytes, uint32_t offset)
+{
+	uint32_t word;
+	while(GCRecording_TakeWord(writer, &word))
+	{
+		for(uint32_t i = 0; i < 4; i++)
+		{
+			bytes[offset++] = (uint8_t)(word >> (8 * i));
+		}
+	}
+	return offset;
+}
+
+/* Polls read back as they were recorded, runs and single button changes
+ * cost a byte, and a session appended after a cut off record still
+ * decodes
+ */
+static void TestRecordingCodec(void)
+{
+	static uint8_t bytes[1024];
+	const uint32_t first = GC_BUTTON_MASK(GC_L) | GC_BUTTON_MASK(GC_MAIN_STICK_UP);
+	const uint32_t second = first | GC_BUTTON_MASK(GC_A);
+	const uint32_t third = second ^ (GC_BUTTON_MASK(GC_B) | GC_BUTTON_MASK(GC_TILT));
+	const uint32_t fourth = second ^ (GC_BUTTON_MASK(GC_B) | GC_BUTTON_MASK(GC_X));
+	uint32_t polls[300 + 3];
+	uint32_t numOfPolls = 0;
+	GCRecordingWriter_t writer;
+	GCRecordingReader_t reader;
+	uint32_t word;
+
+	for(uint32_t i = 0; i < 300; i++)
+	{
+		polls[numOfPolls++] = first;
+	}
+	polls[numOfPolls++] = second;
+	polls[numOfPolls++] = third;
+	polls[numOfPolls++] = first;
+
+	/* A KEY, then a RUN byte every 128 polls of the same word */
+	memset(bytes, 0xFF, sizeof(bytes));
+	CHECK(GCRecording_InitWriter(&writer, 0) == 0);
+	for(uint32_t i = 0; i < 300; i++)
+	{
+		CHECK(GCRecording_Record(&writer, polls[i]));
+	}
+	CHECK(writer.numOfRecordBytes == (4 + 2));
+	CHECK(GCRecording_Record(&writer, second));
+	CHECK(writer.numOfRecordBytes == (4 + 2 + 2));
+	CHECK(GCRecording_Record(&writer, third) && GCRecording_Record(&writer, first));
+	CHECK(writer.numOfRecordBytes == (4 + 2 + 2 + 4 + 4));
+
+	uint32_t end = TakeRecordedWords(&writer, bytes, 0);
+	CHECK(end == writer.numOfRecordBytes);
+	GCRecording_InitReader(&reader, bytes, sizeof(bytes));
+	for(uint32_t i = 0; i < numOfPolls; i++)
+	{
+		CHECK(GCRecording_Next(&reader, &word) && (word == polls[i]));
+	}
+	CHECK(!GCRecording_Next(&reader, &word));
+	GCRecording_InitReader(&reader, bytes, sizeof(bytes));
+	CHECK(GCRecording_SkipToEnd(&reader) == end);
+
+	/* KEY, FLIP and an XOR of which only the first 2 of its 3 bytes made
+	 * it to flash. The next session finishes it with 0x00, and the XOR
+	 * was of the low 16 bits so it still reads back right.
+	 */
+	memset(bytes, 0xFF, sizeof(bytes));
+	GCRecording_InitWriter(&writer, 0);
+	GCRecording_Record(&writer, first);
+	GCRecording_Record(&writer, second);
+	GCRecording_Record(&writer, fourth);
+	CHECK(TakeRecordedWords(&writer, bytes, 0) == 8);
+	memset(&bytes[8], 0xFF, 4);
+	GCRecording_InitReader(&reader, bytes, sizeof(bytes));
+	end = GCRecording_SkipToEnd(&reader);
+	CHECK(end == 9);
+
+	CHECK(GCRecording_InitWriter(&writer, end) == 8);
+	GCRecording_Record(&writer, third);
+	GCRecording_Record(&writer, third);
+	GCRecording_Record(&writer, first);
+	GCRecording_Record(&writer, second);
+	GCRecording_Record(&writer, first);
+	GCRecording_Record(&writer, second);
+	TakeRecordedWords(&writer, bytes, 8);
+	const uint32_t appended[] = {first, second, fourth, third, third, first};
+	GCRecording_InitReader(&reader, bytes, sizeof(bytes));
+	for(uint32_t i = 0; i < (sizeof(appended) / sizeof(appended[0])); i++)
+	{
+		CHECK(GCRecording_Next(&reader, &word) && (word == appended[i]));
+	}
+
+	/* Anything but erased flash after the records leaves no room */
+	bytes[4] = 0xA5;
+	GCRecording_InitReader(&reader, bytes, sizeof(bytes));
+	CHECK(GCRecording_SkipToEnd(&reader) == sizeof(bytes));
+
+	/* A full ring stops the recording for good */
+	GCRecording_InitWriter(&writer, 0);
+	uint32_t numOfRecorded = 0;
+	for(uint32_t i = 0; i < GC_RECORDING_RING_BYTES; i++)
+	{
+		numOfRecorded += GCRecording_Record(&writer, (i & 1) ? first : fourth);
+	}
+	CHECK(numOfRecorded == (GC_RECORDING_RING_BYTES / 4));
+	CHECK(writer.isStopped);
+	TakeRecordedWords(&writer, bytes, 0);
+	CHECK(!GCRecording_Record(&writer, first));
+
+	/* A region is only a recording with the magic */
+	uint8_t magic[4] = {'G', 'C', 'R', '1'};
+	CHECK(GCRecording_HasMagic(magic));
+	magic[3] = '2';
+	CHECK(!GCRecording_HasMagic(magic));
+}
+
+/* A rendered response reads back as the same UART bytes, and every
+ * response the emulation sent was prepared first
+ */
+static void TestWaveform(void)
+{
+	static const uint8_t gcBytes[] = {0x09, 0x00, 0x03, 0xA5, 0x5A};
+	static const uint32_t firstGCByte[GC_WAVEFORM_SLOTS_PER_GC_BYTE] =
+	{
+		0, 0, 0, 1,  0, 0, 0, 1,  0, 0, 0, 1,  0, 0, 0, 1,
+		0, 1, 1, 1,  0, 0, 0, 1,  0, 0, 0, 1,  0, 1, 1, 1
+	};
+	uint32_t frame[sizeof(gcBytes)];
+	uint32_t slots[GC_WAVEFORM_SLOTS(sizeof(gcBytes))];
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t uartBytes[HOST_PORT_MAX_UART_BYTES];
+	GCWaveform_t waveform;
+	GCCaptureRx_t rx;
+
+	GCJoybus_EncodeFrame(gcBytes, sizeof(gcBytes), frame);
+	GCWaveform_Init(&waveform, 0, 1);
+	GCWaveform_Render(&waveform, frame, sizeof(gcBytes), slots);
+	GCWaveform_StopBit(&waveform, &slots[sizeof(gcBytes) * GC_WAVEFORM_SLOTS_PER_GC_BYTE]);
+	CHECK(memcmp(slots, firstGCByte, sizeof(firstGCByte)) == 0);
+
+	/* Every change of level is an edge, 100 timer counts per slot */
+	uint32_t numOfUartBytes = 0;
+	uint32_t level = 1;
+	GCCaptureRx_Reset(&rx);
+	for(uint32_t i = 0; i < GC_WAVEFORM_SLOTS(sizeof(gcBytes)); i++)
+	{
+		if(slots[i] != level)
+		{
+			level = slots[i];
+			numOfUartBytes += GCCaptureRx_Edge(&rx, (uint16_t)(i * 100), &uartBytes[numOfUartBytes]);
+		}
+	}
+	CHECK(level == 1);
+	numOfUartBytes += GCCaptureRx_Idle(&rx, &uartBytes[numOfUartBytes]);
+
+	uint32_t numOfExpected = ExpectedUartBytes(gcBytes, sizeof(gcBytes), expected);
+	CHECK((numOfUartBytes == numOfExpected) && (memcmp(uartBytes, expected, numOfExpected) == 0));
+
+	CHECK(HostPort_GetNumOfUnpreparedFrames() == 0);
+}
+
+static void TestResponseCacheStats(void)
+{
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCResponseCacheStats_t stats;
+
+	GCControllerEmulation_GetResponseCacheStats(0, &stats);
+	uint32_t numOfResponses = stats.numOfResponses;
+
+	HostPort_QueueCommand(poll, sizeof(poll));
+	HostPort_AdvanceCycles(1000);
+	RunEmulation();
+	HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+
+	GCControllerEmulation_GetResponseCacheStats(0, &stats);
+	CHECK(stats.numOfResponses == numOfResponses + 1);
+	CHECK(stats.lastInputAge == 0);
+}
+
+static void TestOverlapSampling(void)
+{
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCResponseCacheStats_t stats;
+
+	HostPort_QueueCommand(poll, sizeof(poll));
+	HostPort_SetCyclesPerUartByte(100);
+	RunEmulation();
+	HostPort_SetCyclesPerUartByte(0);
+	HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+
+	/* Overlapped, only the last 2 GC bytes and the stop bit age the
+	 * inputs instead of the whole command
+	 */
+	GCControllerEmulation_GetResponseCacheStats(0, &stats);
+#if GC_USE_OVERLAP_SAMPLING
+	CHECK(stats.lastInputAge == ((2 * GC_UART_BYTES_PER_GC_BYTE) + 1) * 100);
+#else
+	CHECK(stats.lastInputAge == ((3 * GC_UART_BYTES_PER_GC_BYTE) + 1) * 100);
+#endif
+}
+
+#if !GC_USE_DMA_RX
+/* Bytes arriving faster than the refresh takes are lost to an overrun.
+ * The poll is then counted and dropped, not answered from a misframed
+ * command. A refresh before the command is harmless.
+ */
+static void TestReceiveOverrun(void)
+{
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCRxStats_t before, after;
+
+	GCControllerEmulation_GetRxStats(0, &before);
+	HostPort_QueueCommand(poll, sizeof(poll));
+	HostPort_SetCyclesPerUartByte(100);
+	HostPort_SetCyclesPerFrame(250);
+	RunEmulation();
+	HostPort_SetCyclesPerFrame(0);
+	HostPort_SetCyclesPerUartByte(0);
+	uint32_t numOfResponse = HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+
+	GCControllerEmulation_GetRxStats(0, &after);
+#if GC_USE_OVERLAP_SAMPLING
+	CHECK(numOfResponse == 0);
+	CHECK(after.overrunErrors == before.overrunErrors + 1);
+	CHECK(after.numOfBadCommands == before.numOfBadCommands + 1);
+#else
+	CHECK(numOfResponse == (8 * GC_UART_BYTES_PER_GC_BYTE) + 1);
+	CHECK(after.overrunErrors == before.overrunErrors);
+	CHECK(after.numOfCommands == before.numOfCommands + 1);
+#endif
+}
+#endif
+
+/* One axis of the SOCD reference, lastPushed is 1 or 2 for a single
+ * direction and 3 for both pushed at once
+ */
+typedef struct
+{
+	uint32_t lastInputs;
+	uint32_t lastPushed;
+	uint32_t suppressed;
+} SocdAxisReference_t;
+
+/* Resolves one axis the slow way, directions are bit 0 (up or left) and bit 1 */
+static uint32_t ReferenceSocdAxis(SocdAxisReference_t *axis, GCSocdPolicy_t policy, uint32_t isYAxis, uint32_t inputs)
+{
+	uint32_t newlyPushed = inputs & ~axis->lastInputs;
+	uint32_t resolved = inputs;
+
+	if(newlyPushed != 0)
+	{
+		axis->lastPushed = newlyPushed;
+	}
+	axis->lastInputs = inputs;
+	axis->suppressed &= inputs;
+
+	if(inputs == 3)
+	{
+		uint32_t single = (axis->lastPushed != 3);
+		switch(policy)
+		{
+			case GC_SOCD_LAST_INPUT:
+				resolved = single ? axis->lastPushed : 0;
+				break;
+			case GC_SOCD_FIRST_INPUT:
+				resolved = single ? (3 ^ axis->lastPushed) : 0;
+				break;
+			case GC_SOCD_UP_PRIORITY:
+				resolved = isYAxis ? 1 : 0;
+				break;
+			case GC_SOCD_SECOND_INPUT:
+				if(single)
+				{
+					axis->suppressed |= 3 ^ axis->lastPushed;
+				}
+				resolved = single ? axis->lastPushed : 0;
+				break;
+			default:
+				resolved = 0;
+				break;
+		}
+	}
+
+	if(policy == GC_SOCD_SECOND_INPUT)
+	{
+		resolved &= ~axis->suppressed;
+	}
+
+	return resolved;
+}
+
+/* Random input sequences through every policy must match the reference */
+static void TestSocdPolicies(void)
+{
+	static const GCButtonInput_t firstDirections[] =
+	{
+		GC_DPAD_UP, GC_DPAD_LEFT, GC_MAIN_STICK_UP, GC_MAIN_STICK_LEFT, GC_C_STICK_UP, GC_C_STICK_LEFT
+	};
+	static const GCSocdGroup_t groups[] =
+	{
+		GC_SOCD_GROUP_DPAD, GC_SOCD_GROUP_DPAD, GC_SOCD_GROUP_MAIN_STICK,
+		GC_SOCD_GROUP_MAIN_STICK, GC_SOCD_GROUP_C_STICK, GC_SOCD_GROUP_C_STICK
+	};
+	uint32_t numOfMismatches = 0;
+	uint32_t random = 12345;
+	uint32_t pushed = 0;
+
+	for(uint32_t dpad = 0; dpad < NUM_OF_GC_SOCD_POLICIES; dpad++)
+	{
+		/* The stick groups are offset so every group sees every policy */
+		GCSocdPolicy_t policies[NUM_OF_GC_SOCD_GROUPS];
+		policies[GC_SOCD_GROUP_DPAD] = (GCSocdPolicy_t)dpad;
+		policies[GC_SOCD_GROUP_MAIN_STICK] = (GCSocdPolicy_t)((dpad + 1) % NUM_OF_GC_SOCD_POLICIES);
+		policies[GC_SOCD_GROUP_C_STICK] = (GCSocdPolicy_t)((dpad + 2) % NUM_OF_GC_SOCD_POLICIES);
+
+		GCSocd_t socd;
+		GCSocd_Init(&socd, policies[0], policies[1], policies[2]);
+		SocdAxisReference_t axes[6] = {0};
+
+		for(uint32_t step = 0; step < 100000; step++)
+		{
+			// Flip a couple of random inputs each step, like a player would
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			pushed ^= GC_BUTTON_MASK(random % (GC_TILT + 1));
+			pushed ^= GC_BUTTON_MASK((random >> 8) % (GC_TILT + 1)) & ((random & 0x10000) ? ~0UL : 0);
+
+			uint32_t expected = pushed;
+			for(uint32_t i = 0; i < 6; i++)
+			{
+				uint32_t axisInputs = (pushed >> firstDirections[i]) & 3;
+				uint32_t isYAxis = (firstDirections[i] == GC_DPAD_UP) || (firstDirections[i] == GC_MAIN_STICK_UP) ||
+								   (firstDirections[i] == GC_C_STICK_UP);
+				uint32_t resolved = ReferenceSocdAxis(&axes[i], policies[groups[i]], isYAxis, axisInputs);
+				expected = (expected & ~(3UL << firstDirections[i])) | (resolved << firstDirections[i]);
+			}
+
+			if(GCSocd_Resolve(&socd, pushed) != expected)
+			{
+				numOfMismatches++;
+			}
+		}
+	}
+
+	CHECK(numOfMismatches == 0);
+}
+
+#if GC_USE_PROFILING
+static void TestProfile(void)
+{
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCProfileStats_t stats;
+
+	/* Min, max, total and the log2 buckets */
+	GCProfile_Reset();
+	GCProfile_Record(GC_PROFILE_ENCODE, 0);
+	GCProfile_Record(GC_PROFILE_ENCODE, 100);
+	GCProfile_Record(GC_PROFILE_ENCODE, 127);
+	GCProfile_Record(GC_PROFILE_ENCODE, 0xFFFFFFFF);
+	GCProfile_GetStats(GC_PROFILE_ENCODE, &stats);
+	CHECK(stats.numOfSamples == 4);
+	CHECK(stats.minCycles == 0);
+	CHECK(stats.maxCycles == 0xFFFFFFFF);
+	CHECK(stats.totalCycles == 227ULL + 0xFFFFFFFFULL);
+	CHECK(stats.histogram[0] == 1);
+	CHECK(stats.histogram[7] == 2);
+	CHECK(stats.histogram[32] == 1);
+
+	/* Every phase of a poll is timed, the host port has no stop bit pin.
+	 * An overlapped refresh times the refresh phases once more.
+	 */
+	GCProfile_Reset();
+	HostPort_QueueCommand(poll, sizeof(poll));
+	RunEmulation();
+	HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+	for(uint32_t phase = 0; phase < NUM_OF_GC_PROFILE_PHASES; phase++)
+	{
+		GCProfile_GetStats((GCProfilePhase_t)phase, &stats);
+		uint32_t isTimed = (phase != GC_PROFILE_STOP_BIT) && ((phase != GC_PROFILE_DEBOUNCE) || GC_USE_DEBOUNCE);
+		uint32_t isRefresh = (phase >= GC_PROFILE_SWITCH_SNAPSHOT) && (phase <= GC_PROFILE_ENCODE);
+		CHECK(stats.numOfSamples == (isTimed * ((isRefresh && GC_USE_OVERLAP_SAMPLING) ? 2 : 1)));
+	}
+}
+#endif
+
+#if GC_USE_TELEMETRY
+/* Runs first so the telemetry ring starts out empty */
+static void TestTelemetry(void)
+{
+	static const uint8_t probe[] = {GC_JOYBUS_COMMAND_PROBE};
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x01};
+	static uint8_t telemetry[HOST_PORT_MAX_TELEMETRY_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCTelemetryRecord_t record;
+	GCTelemetryStats_t stats;
+
+	/* A record goes out while waiting for the next command */
+	HostPort_SetInputs(GC_BUTTON_MASK(GC_A));
+	Exchange(poll, sizeof(poll), response);
+	Exchange(probe, sizeof(probe), response);
+	CHECK(HostPort_TakeTelemetryBytes(telemetry, sizeof(telemetry)) == GC_TELEMETRY_RECORD_BYTES);
+
+	memcpy(&record, telemetry, sizeof(record));
+	uint16_t checksum = 0;
+	for(uint32_t i = 0; i < (GC_TELEMETRY_RECORD_BYTES - 2); i++)
+	{
+		checksum += telemetry[i];
+	}
+	CHECK(record.sync == GC_TELEMETRY_SYNC);
+	CHECK(record.sequence == 0);
+	CHECK(record.command == 3);
+	CHECK(record.flags == (GC_TELEMETRY_FLAG_RESPONDED | GC_TELEMETRY_FLAG_RUMBLE));
+	CHECK(record.numOfGCBytes == 3);
+	CHECK(memcmp(record.gcBytes, poll, sizeof(poll)) == 0);
+	CHECK(record.inputs == GC_BUTTON_MASK(GC_A));
+	CHECK(record.numOfDropped == 0);
+	CHECK(record.checksum == checksum);
+
+	/* A stalled expansion port drops records but never holds up a response */
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	static const uint8_t probeResponse[] = {0x09, 0x00, 0x03};
+	uint32_t numOfExpected = ExpectedUartBytes(probeResponse, sizeof(probeResponse), expected);
+
+	HostPort_SetTelemetryStalled(1);
+	for(uint32_t i = 0; i < GC_TELEMETRY_RING_SIZE + 4; i++)
+	{
+		CHECK(Exchange(probe, sizeof(probe), response) == numOfExpected);
+		CHECK(memcmp(response, expected, numOfExpected) == 0);
+	}
+	GCTelemetry_GetStats(&stats);
+	CHECK(stats.numOfDropped != 0);
+
+	/* Once the port catches up the ring drains in whole records, and the
+	 * sequence gaps match the drop count of the last record
+	 */
+	HostPort_SetTelemetryStalled(0);
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		Exchange(probe, sizeof(probe), response);
+	}
+	uint32_t numOfBytes = HostPort_TakeTelemetryBytes(telemetry, sizeof(telemetry));
+	CHECK((numOfBytes != 0) && ((numOfBytes % GC_TELEMETRY_RECORD_BYTES) == 0));
+
+	uint32_t numOfGaps = 0;
+	uint8_t nextSequence = 1;
+	for(uint32_t i = 0; i < numOfBytes; i += GC_TELEMETRY_RECORD_BYTES)
+	{
+		memcpy(&record, &telemetry[i], sizeof(record));
+		CHECK(record.sync == GC_TELEMETRY_SYNC);
+		numOfGaps += (uint8_t)(record.sequence - nextSequence);
+		nextSequence = record.sequence + 1;
+	}
+	CHECK(numOfGaps != 0);
+	CHECK(numOfGaps == record.numOfDropped);
+
+	HostPort_SetInputs(0);
+}
+#endif
+
+#if GC_USE_INPUT_EDGES
+/* A tap between two polls is sent once, and both of its edges are timed */
+static void TestInputEdges(void)
+{
+	GCInputEdgeStats_t before, after;
+	GCInputEdge_t edge;
+
+	HostPort_SetInputs(0);
+	IsPollResponse(0);
+	while(GCInputEdges_Read(&edge)){};
+	GCInputEdges_GetStats(&before);
+
+	/* The pin interrupts see A go down and up again before the next poll */
+	HostPort_AdvanceCycles(1000);
+	uint32_t pressTime = GCPort_GetCycles();
+	GCControllerEmulation_CaptureInputs(GC_BUTTON_MASK(GC_A), pressTime);
+	HostPort_AdvanceCycles(100);
+	GCControllerEmulation_CaptureInputs(0, GCPort_GetCycles());
+	HostPort_AdvanceCycles(1000);
+
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_A)));
+
+	/* Only one response carries it */
+	CHECK(IsPollResponse(0));
+
+	CHECK(GCInputEdges_Read(&edge) && (edge.button == GC_A) && edge.pushed && (edge.timestamp == pressTime));
+	CHECK(GCInputEdges_Read(&edge) && (edge.button == GC_A) && !edge.pushed && (edge.timestamp == pressTime + 100));
+	CHECK(!GCInputEdges_Read(&edge));
+
+	GCInputEdges_GetStats(&after);
+	CHECK(after.numOfEdges == before.numOfEdges + 2);
+	CHECK(after.numOfPresses == before.numOfPresses + 1);
+	CHECK(after.numOfStretchedPresses == before.numOfStretchedPresses + 1);
+	CHECK(after.numOfLatencies == before.numOfLatencies + 1);
+	CHECK(after.totalLatency == before.totalLatency + 1100);
+	CHECK(after.maxLatency >= 1100);
+}
+#endif
+
+#if GC_USE_DEBOUNCE
+/* Sets every debounce group to pass straight through */
+static void BypassDebounce(void)
+{
+	for(uint32_t group = 0; group < NUM_OF_GC_DEBOUNCE_GROUPS; group++)
+	{
+		GCControllerEmulation_SetDebounce((GCDebounceGroup_t)group, GC_DEBOUNCE_EAGER, 0);
+	}
+}
+
+/* Chatter never makes an input, and presses are held or delayed by
+ * whole ticks
+ */
+static void TestDebounce(void)
+{
+	HostPort_SetInputs(0);
+	CHECK(IsPollResponse(0));
+	GCControllerEmulation_SetDebounce(GC_DEBOUNCE_GROUP_BUTTONS, GC_DEBOUNCE_DEFERRED, 3);
+	GCControllerEmulation_SetDebounce(GC_DEBOUNCE_GROUP_DPAD, GC_DEBOUNCE_EAGER, 2);
+
+	/* DEFERRED: a press bouncing every tick is never sent */
+	for(uint32_t i = 0; i < 10; i++)
+	{
+		HostPort_SetInputs((i & 1) ? 0 : GC_BUTTON_MASK(GC_A));
+		CHECK(IsPollResponse(0));
+		HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES);
+		CHECK(IsPollResponse(0));
+	}
+
+	/* It is sent after 3 ticks held, and let go after 3 ticks released */
+	HostPort_SetInputs(GC_BUTTON_MASK(GC_A));
+	CHECK(IsPollResponse(0));
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES * 2);
+	CHECK(IsPollResponse(0));
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES);
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_A)));
+	HostPort_SetInputs(0);
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES * 2);
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_A)));
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES);
+	CHECK(IsPollResponse(0));
+
+	/* EAGER: the first edge is sent at once and the chatter after it
+	 * is ignored for 2 ticks
+	 */
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES / 2);
+	HostPort_SetInputs(GC_BUTTON_MASK(GC_DPAD_UP));
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_DPAD_UP)));
+	HostPort_SetInputs(0);
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_DPAD_UP)));
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES);
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_DPAD_UP)));
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES);
+	CHECK(IsPollResponse(0));
+
+	/* Other groups still pass straight through */
+	HostPort_SetInputs(GC_BUTTON_MASK(GC_C_STICK_UP));
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_C_STICK_UP)));
+
+	HostPort_SetInputs(0);
+	HostPort_AdvanceCycles(GC_DEBOUNCE_TICK_CYCLES * 100);
+	BypassDebounce();
+	CHECK(IsPollResponse(0));
+}
+#endif
+
+#if GC_USE_POLL_CADENCE
+/* Steady polls lock the tracker, and the response is refreshed once,
+ * just in time for the predicted poll
+ */
+static void TestPollCadence(void)
+{
+	const uint32_t period = 1000000;
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCCadenceStats_t before, stats;
+
+	/* Polls 200 cycles early and late in turn. Earlier tests may have
+	 * locked it already, so it is only counted once it settled.
+	 */
+	HostPort_SetInputs(0);
+	for(uint32_t i = 0; i < 32; i++)
+	{
+		HostPort_AdvanceCycles((i & 1) ? (period + 200) : (period - 200));
+		CHECK(IsPollResponse(0));
+		if(i == 3)
+		{
+			GCControllerEmulation_GetCadenceStats(0, &before);
+		}
+	}
+	GCControllerEmulation_GetCadenceStats(0, &stats);
+	CHECK(before.isLocked && stats.isLocked);
+	CHECK((stats.numOfLocks == before.numOfLocks) && (stats.numOfUnlocks == before.numOfUnlocks));
+	CHECK((stats.period >= period - 50) && (stats.period <= period + 50));
+	CHECK((stats.jitter >= 100) && (stats.jitter <= 300));
+	CHECK(stats.maxError <= 500);
+
+	/* A pass well before the poll only idles. The next one, within the
+	 * guard time of the refresh, waits for it and sends the B pressed
+	 * by then, where refreshing at once would have sent A.
+	 */
+	uint32_t refreshTime = GCPort_GetCycles() + stats.period - GC_POLL_GUARD_CYCLES - (stats.jitter * 2);
+	HostPort_AdvanceCycles(stats.period - (GC_POLL_GUARD_CYCLES * 4));
+	RunEmulation();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == 0);
+	HostPort_AdvanceCycles(GC_POLL_GUARD_CYCLES * 2);
+	HostPort_SetInputs(GC_BUTTON_MASK(GC_A));
+	HostPort_SetInputsAt(refreshTime, GC_BUTTON_MASK(GC_B));
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_B)));
+	CHECK(GCPort_GetCycles() == refreshTime);
+
+	/* Once refreshed, a change before the poll is only sent by a later
+	 * refresh, which happens when the command is received in the
+	 * background or overlapped. The stretched press of A comes with it.
+	 */
+#if GC_USE_DMA_RX || GC_USE_OVERLAP_SAMPLING
+	uint32_t late = GC_BUTTON_MASK(GC_B) | ((GC_USE_INPUT_EDGES && GC_INPUT_STRETCH_POLLS) ? GC_BUTTON_MASK(GC_A) : 0);
+#else
+	uint32_t late = GC_BUTTON_MASK(GC_A);
+#endif
+	GCControllerEmulation_GetCadenceStats(0, &stats);
+	refreshTime = GCPort_GetCycles() + stats.period - GC_POLL_GUARD_CYCLES - (stats.jitter * 2);
+	HostPort_AdvanceCycles(stats.period - (GC_POLL_GUARD_CYCLES * 2));
+	HostPort_SetInputsAt(refreshTime, GC_BUTTON_MASK(GC_A));
+	RunEmulation();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == 0);
+	CHECK(GCPort_GetCycles() == refreshTime);
+	HostPort_AdvanceCycles(GC_POLL_GUARD_CYCLES);
+	HostPort_SetInputs(GC_BUTTON_MASK(GC_B));
+	CHECK(IsPollResponse(late));
+
+	/* A console that stops polling unlocks it, and every refresh is
+	 * sent again
+	 */
+	HostPort_AdvanceCycles(period * 5);
+	HostPort_SetInputs(0);
+	IsPollResponse(GC_BUTTON_MASK(GC_B));
+	GCControllerEmulation_GetCadenceStats(0, &stats);
+	CHECK(!stats.isLocked && (stats.numOfUnlocks == before.numOfUnlocks + 1));
+	CHECK(IsPollResponse(0));
+}
+#endif
+
+#if GC_USE_DMA_SAMPLING && (GC_SAMPLE_WINDOW > 1)
+/* A button only changes once the whole sample window agrees */
+static void TestInputSampling(void)
+{
+	CHECK(GCPort_GetInputSampleRate() == GC_SAMPLE_RATE_HZ);
+
+	HostPort_SetInputs(0);
+	CHECK(IsPollResponse(0));
+
+	/* A bouncing press is sent once it settles for a whole window */
+	HostPort_AddInputSample(GC_BUTTON_MASK(GC_B));
+	HostPort_AddInputSample(0);
+	HostPort_AddInputSample(GC_BUTTON_MASK(GC_B));
+	CHECK(IsPollResponse(0));
+	for(uint32_t i = 2; i < GC_SAMPLE_WINDOW; i++)
+	{
+		HostPort_AddInputSample(GC_BUTTON_MASK(GC_B));
+		CHECK(IsPollResponse(0));
+	}
+	HostPort_AddInputSample(GC_BUTTON_MASK(GC_B));
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_B)));
+
+	/* The release bounces too */
+	HostPort_AddInputSample(0);
+	HostPort_AddInputSample(GC_BUTTON_MASK(GC_B));
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_B)));
+	for(uint32_t i = 0; i < GC_SAMPLE_WINDOW; i++)
+	{
+		HostPort_AddInputSample(0);
+	}
+	CHECK(IsPollResponse(0));
+}
+#endif
+
+#if GC_USE_MACROS
+/* The sequence of MACRO + X in gc_macro_profile.h goes out one step per
+ * poll, starting with the poll after the pick
+ */
+static void TestMacros(void)
+{
+	const uint32_t pick = GC_BUTTON_MASK(GC_MACRO) | GC_BUTTON_MASK(GC_X);
+	const uint32_t airDodge = GC_BUTTON_MASK(GC_MAIN_STICK_DOWN) | GC_BUTTON_MASK(GC_MAIN_STICK_RIGHT) | GC_BUTTON_MASK(GC_R);
+
+	HostPort_SetInputs(0);
+	CHECK(IsPollResponse(0));
+
+	HostPort_SetInputs(pick);
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_MACRO)));
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_X)));
+	CHECK(IsPollResponse(0));
+	CHECK(IsPollResponse(0));
+	CHECK(IsPollResponse(airDodge));
+	CHECK(IsPollResponse(airDodge));
+
+	/* Then the player again, X still only picks while MACRO is held */
+	CHECK(IsPollResponse(GC_BUTTON_MASK(GC_MACRO)));
+	HostPort_SetInputs(0);
+	CHECK(IsPollResponse(0));
+}
+#endif
+
+#if GC_USE_RECORDING
+/* Every poll of a session is in flash soon after it was answered, and
+ * the next session goes after it
+ */
+static void TestRecording(void)
+{
+	static const struct
+	{
+		uint32_t inputs;
+		uint32_t numOfPolls;
+	} session[] =
+	{
+		{0, 200},
+		{GC_BUTTON_MASK(GC_A), 3},
+		{GC_BUTTON_MASK(GC_A) | GC_BUTTON_MASK(GC_B), 2},
+		{GC_BUTTON_MASK(GC_B), 1},
+		{GC_BUTTON_MASK(GC_MAIN_STICK_LEFT) | GC_BUTTON_MASK(GC_TILT), 50},
+		{GC_BUTTON_MASK(GC_C_STICK_UP) | GC_BUTTON_MASK(GC_DPAD_UP), 1},
+		{0, 10}
+	};
+	const uint32_t afterwards[] = {GC_BUTTON_MASK(GC_Z), GC_BUTTON_MASK(GC_Z) | GC_BUTTON_MASK(GC_L), GC_BUTTON_MASK(GC_L)};
+	const uint32_t nextSession = GC_BUTTON_MASK(GC_START) | GC_BUTTON_MASK(GC_R);
+	const uint32_t period = 1000000;
+	const uint8_t *flash = GCPort_GetRecordingFlash();
+	GCRecordingReader_t reader;
+	uint32_t numOfBadWrites = HostPort_GetNumOfBadFlashWrites();
+	uint32_t word;
+
+	/* Flash without the magic is made a recording */
+	GCPort_EraseRecordingFlash();
+	GCControllerEmulation_Init();
+#if GC_USE_DEBOUNCE
+	BypassDebounce();
+#endif
+	CHECK(GCRecording_HasMagic(flash));
+
+	uint32_t numOfPolls = 0;
+	for(uint32_t i = 0; i < (sizeof(session) / sizeof(session[0])); i++)
+	{
+		HostPort_SetInputs(session[i].inputs);
+		for(uint32_t j = 0; j < session[i].numOfPolls; j++)
+		{
+			/* A steady rate and a pass between polls, with more
+			 * consoles only a locked cadence leaves room for the flush
+			 */
+			HostPort_AdvanceCycles(period);
+			CHECK(IsPollResponse(session[i].inputs));
+			RunEmulation();
+			numOfPolls++;
+		}
+	}
+
+	/* The last polls of the session end its last record, and a command
+	 * that never comes gives the chance to program it
+	 */
+	for(uint32_t i = 0; i < (sizeof(afterwards) / sizeof(afterwards[0])); i++)
+	{
+		HostPort_SetInputs(afterwards[i]);
+		HostPort_AdvanceCycles(period);
+		CHECK(IsPollResponse(afterwards[i]));
+	}
+	RunEmulation();
+
+	GCRecording_InitReader(&reader, flash + GC_RECORDING_HEADER_BYTES, GC_RECORDING_FLASH_BYTES - GC_RECORDING_HEADER_BYTES);
+	for(uint32_t i = 0; i < (sizeof(session) / sizeof(session[0])); i++)
+	{
+		for(uint32_t j = 0; j < session[i].numOfPolls; j++)
+		{
+			CHECK(GCRecording_Next(&reader, &word) && (word == session[i].inputs));
+		}
+	}
+	GCRecording_InitReader(&reader, flash + GC_RECORDING_HEADER_BYTES, GC_RECORDING_FLASH_BYTES - GC_RECORDING_HEADER_BYTES);
+	uint32_t end = GCRecording_SkipToEnd(&reader);
+	CHECK(end < 32);
+
+	/* A power cycle appends, and the polls after it follow the first
+	 * session
+	 */
+	GCControllerEmulation_Init();
+#if GC_USE_DEBOUNCE
+	BypassDebounce();
+#endif
+	HostPort_SetInputs(nextSession);
+	HostPort_AdvanceCycles(period);
+	CHECK(IsPollResponse(nextSession));
+	for(uint32_t i = 0; i < (sizeof(afterwards) / sizeof(afterwards[0])); i++)
+	{
+		HostPort_SetInputs(afterwards[i]);
+		HostPort_AdvanceCycles(period);
+		CHECK(IsPollResponse(afterwards[i]));
+	}
+	RunEmulation();
+
+	GCRecording_InitReader(&reader, flash + GC_RECORDING_HEADER_BYTES, GC_RECORDING_FLASH_BYTES - GC_RECORDING_HEADER_BYTES);
+	uint32_t numOfWords = 0;
+	uint32_t nextSessionAt = 0;
+	while(GCRecording_Next(&reader, &word))
+	{
+		numOfWords++;
+		if( (word == nextSession) && (nextSessionAt == 0) )
+		{
+			nextSessionAt = numOfWords;
+		}
+	}
+	CHECK(nextSessionAt > numOfPolls);
+	CHECK(reader.offset > end);
+	CHECK(HostPort_GetNumOfBadFlashWrites() == numOfBadWrites);
+
+	HostPort_SetInputs(0);
+}
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+/* With more consoles, the recording is not programmed right after a
+ * poll of port 0 while another port is about to be polled
+ */
+static void TestRecordingFlushWindow(void)
+{
+	const uint32_t period = 1000000;
+	const uint32_t offset = GC_POLL_GUARD_CYCLES;
+	const uint32_t pushed = GC_BUTTON_MASK(GC_A) | GC_BUTTON_MASK(GC_B);
+	GCCadenceStats_t stats;
+
+	/* Both consoles poll at the same rate, port 1 right after port 0 */
+	HostPort_SetInputs(0);
+	for(uint32_t i = 0; i < 8; i++)
+	{
+		HostPort_AdvanceCycles(period - offset);
+		HostPort_SelectConsolePort(0);
+		CHECK(IsPollResponse(0));
+		HostPort_AdvanceCycles(offset);
+		HostPort_SelectConsolePort(1);
+		CHECK(IsPollResponse(0));
+		RunEmulation();
+	}
+	for(uint32_t i = 0; i < 2; i++)
+	{
+		GCControllerEmulation_GetCadenceStats(i, &stats);
+		CHECK(stats.isLocked);
+	}
+
+	/* Pressing two buttons queues a whole word */
+	HostPort_AdvanceCycles(period - offset);
+	HostPort_SelectConsolePort(0);
+	HostPort_SetInputs(pushed);
+	CHECK(IsPollResponse(pushed));
+	uint32_t numOfWrites = HostPort_GetNumOfFlashWrites();
+	RunEmulation();
+	CHECK(HostPort_GetNumOfFlashWrites() == numOfWrites);
+
+	/* Port 1 leaves room once it was polled */
+	HostPort_AdvanceCycles(offset);
+	HostPort_SelectConsolePort(1);
+	CHECK(IsPollResponse(pushed));
+	CHECK(HostPort_GetNumOfFlashWrites() == numOfWrites);
+	RunEmulation();
+	CHECK(HostPort_GetNumOfFlashWrites() > numOfWrites);
+
+	/* The consoles stop polling, which unlocks both for the tests after */
+	HostPort_AdvanceCycles(period * 5);
+	HostPort_SetInputs(0);
+	for(uint32_t i = 0; i < 2; i++)
+	{
+		HostPort_SelectConsolePort(i);
+		CHECK(IsPollResponse(0));
+		GCControllerEmulation_GetCadenceStats(i, &stats);
+		CHECK(!stats.isLocked);
+	}
+	HostPort_SelectConsolePort(0);
+}
+#endif
+#endif
+
+#if GC_USE_REPLAY
+/* The recording in flash is sent one recorded poll for every poll from
+ * power up, then the inputs again
+ */
+static void TestReplay(void)
+{
+	const uint32_t recorded[] =
+	{
+		0, 0, GC_BUTTON_MASK(GC_A), GC_BUTTON_MASK(GC_A) | GC_BUTTON_MASK(GC_X),
+		GC_BUTTON_MASK(GC_MAIN_STICK_RIGHT) | GC_BUTTON_MASK(GC_TILT), GC_BUTTON_MASK(GC_MAIN_STICK_RIGHT),
+		GC_BUTTON_MASK(GC_C_STICK_DOWN), GC_BUTTON_MASK(GC_C_STICK_DOWN), 0
+	};
+	const uint32_t live = GC_BUTTON_MASK(GC_Z);
+	static uint8_t bytes[GC_RECORDING_FLASH_BYTES];
+	GCRecordingWriter_t writer;
+
+	/* Record, and end with polls that finish the last record */
+	memset(bytes, 0xFF, sizeof(bytes));
+	GCRecording_InitWriter(&writer, 0);
+	for(uint32_t i = 0; i < (sizeof(recorded) / sizeof(recorded[0])); i++)
+	{
+		GCRecording_Record(&writer, recorded[i]);
+	}
+	GCRecording_Record(&writer, live);
+	GCRecording_Record(&writer, 0);
+	GCRecording_Record(&writer, live);
+	uint32_t end = TakeRecordedWords(&writer, bytes, 0);
+
+	GCPort_EraseRecordingFlash();
+	GCPort_ProgramRecordingWord(0, GC_RECORDING_MAGIC);
+	for(uint32_t i = 0; i < end; i += 4)
+	{
+		GCPort_ProgramRecordingWord(GC_RECORDING_HEADER_BYTES + i,
+			(uint32_t)bytes[i] | ((uint32_t)bytes[i + 1] << 8) | ((uint32_t)bytes[i + 2] << 16) | ((uint32_t)bytes[i + 3] << 24));
+	}
+
+	/* Not the inputs, from the first poll on */
+	GCControllerEmulation_Init();
+	HostPort_SetInputs(live);
+	for(uint32_t i = 0; i < (sizeof(recorded) / sizeof(recorded[0])); i++)
+	{
+		CHECK(IsPollResponse(recorded[i]));
+	}
+
+	/* Then the polls after them, as far as they were programmed */
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		IsPollResponse(live);
+	}
+	CHECK(IsPollResponse(live));
+	CHECK(IsPollResponse(live));
+
+	/* Without a recording the inputs are sent as always */
+	GCPort_EraseRecordingFlash();
+	GCControllerEmulation_Init();
+	HostPort_SetInputs(live);
+	CHECK(IsPollResponse(live));
+	HostPort_SetInputs(0);
+}
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+/* Every console port is a controller of its own, and a command still
+ * arriving on one port does not hold up the others
+ */
+static void TestConsolePorts(void)
+{
+	static const uint8_t probe[] = {GC_JOYBUS_COMMAND_PROBE};
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	static const uint8_t pollMode1[] = {GC_JOYBUS_COMMAND_POLL, 0x01, 0x00};
+	static const uint8_t stopBit = GC_BITS_STOP_BIT;
+	const uint32_t pushed = GC_BUTTON_MASK(GC_X) | GC_BUTTON_MASK(GC_C_STICK_LEFT);
+	const uint32_t lastPort = GC_NUM_OF_CONSOLE_PORTS - 1;
+	uint32_t commandFrame[sizeof(poll)];
+	uint8_t standard[GC_MAX_RESPONSE_BYTES];
+	uint8_t gcBytes[GC_MAX_RESPONSE_BYTES];
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t response[HOST_PORT_MAX_UART_BYTES];
+	GCRxStats_t before[GC_NUM_OF_CONSOLE_PORTS], after;
+
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		GCControllerEmulation_GetRxStats(i, &before[i]);
+	}
+	HostPort_SetInputs(pushed);
+	ReferenceControllerState(pushed, standard);
+
+	/* A poll mode asked for on one port is only used there */
+	HostPort_SelectConsolePort(lastPort);
+	ReferencePollMode(standard, 1, gcBytes);
+	uint32_t numOfExpected = ExpectedUartBytes(gcBytes, 8, expected);
+	for(uint32_t i = 0; i < 2; i++)
+	{
+		uint32_t numOfResponse = Exchange(pollMode1, sizeof(pollMode1), response);
+		CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+	}
+	HostPort_SelectConsolePort(0);
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == 0);
+	CHECK(IsPollResponse(pushed));
+
+	/* Port 0 is in the middle of a poll while the last port is probed */
+	GCJoybus_EncodeFrame(poll, sizeof(poll), commandFrame);
+	HostPort_QueueUartBytes((const uint8_t *)commandFrame, sizeof(poll) * GC_UART_BYTES_PER_GC_BYTE);
+	HostPort_DeliverUartBytes();
+	CHECK(HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES) == 0);
+
+	HostPort_SelectConsolePort(lastPort);
+	numOfExpected = ExpectedUartBytes((const uint8_t[]){0x09, 0x00, 0x03}, 3, expected);
+	uint32_t numOfResponse = Exchange(probe, sizeof(probe), response);
+	CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+
+	HostPort_SelectConsolePort(0);
+	HostPort_QueueUartBytes(&stopBit, 1);
+	HostPort_DeliverUartBytes();
+	numOfExpected = ExpectedUartBytes(standard, 8, expected);
+	numOfResponse = HostPort_TakeSentBytes(response, HOST_PORT_MAX_UART_BYTES);
+	CHECK((numOfResponse == numOfExpected) && (memcmp(response, expected, numOfExpected) == 0));
+
+	/* Commands are counted on the port they came in on */
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		GCControllerEmulation_GetRxStats(i, &after);
+		CHECK(after.numOfBadCommands == before[i].numOfBadCommands);
+		CHECK(after.numOfCommands - before[i].numOfCommands == ((i == 0) ? 2 : (i == lastPort) ? 3 : 0));
+
+		HostPort_SelectConsolePort(i);
+		CHECK(HostPort_GetNumOfUnpreparedFrames() == 0);
+	}
+
+	/* Back to the standard mode and port 0 */
+	HostPort_SelectConsolePort(lastPort);
+	Exchange(poll, sizeof(poll), response);
+	HostPort_SelectConsolePort(0);
+	HostPort_SetInputs(0);
+
+#if GC_USE_INPUT_EDGES
+	/* A tap between polls reaches every console, not only the one that
+	 * polls first, and each of them sees it once. The first round still
+	 * sends the buttons let go above to the ports that did not see them.
+	 */
+	for(uint32_t round = 0; round < 2; round++)
+	{
+		for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+		{
+			HostPort_SelectConsolePort(i);
+			uint32_t isReleased = IsPollResponse(0);
+			CHECK(isReleased || (round == 0));
+		}
+	}
+	HostPort_AdvanceCycles(1000);
+	GCControllerEmulation_CaptureInputs(GC_BUTTON_MASK(GC_A), GCPort_GetCycles());
+	HostPort_AdvanceCycles(100);
+	GCControllerEmulation_CaptureInputs(0, GCPort_GetCycles());
+
+	for(uint32_t round = 0; round < 2; round++)
+	{
+		for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+		{
+			HostPort_SelectConsolePort(i);
+			CHECK(IsPollResponse((round == 0) ? GC_BUTTON_MASK(GC_A) : 0));
+		}
+	}
+	HostPort_SelectConsolePort(0);
+#endif
+}
+#endif
+
+#if !GC_USE_DMA_RX
+/* Queues a controller response, encoded and ended with a stop bit */
+static void QueueControllerResponse(const uint8_t *gcBytes, uint32_t numOfGCBytes)
+{
+	uint8_t uartBytes[HOST_PORT_MAX_UART_BYTES];
+	HostPort_QueueUartBytes(uartBytes, ExpectedUartBytes(gcBytes, numOfGCBytes, uartBytes));
+}
+
+/* Runs the reader and returns 1 if it sent the command, then moves the
+ * cycle counter on to the time of the next one
+ */
+static uint32_t IsReaderCommand(const uint8_t *command, uint32_t numOfCommandBytes)
+{
+	uint8_t expected[HOST_PORT_MAX_UART_BYTES];
+	uint8_t sent[HOST_PORT_MAX_UART_BYTES];
+	uint32_t start = GCPort_GetCycles();
+
+	uint32_t isSent = GCControllerReader_RunOnce();
+	uint32_t numOfExpected = ExpectedUartBytes(command, numOfCommandBytes, expected);
+	uint32_t numOfSent = HostPort_TakeSentBytes(sent, HOST_PORT_MAX_UART_BYTES);
+	HostPort_AdvanceCycles(GC_READER_POLL_PERIOD_CYCLES - (GCPort_GetCycles() - start));
+
+	return isSent && (numOfSent == numOfExpected) && (memcmp(sent, expected, numOfExpected) == 0);
+}
+
+static void TestControllerReader(void)
+{
+	static const uint8_t probe[] = {GC_JOYBUS_COMMAND_PROBE};
+	static const uint8_t origin[] = {GC_JOYBUS_COMMAND_PROBE_ORIGIN};
+	static const uint8_t poll[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x00};
+	static const uint8_t pollAndRumble[] = {GC_JOYBUS_COMMAND_POLL, 0x03, 0x01};
+	static const uint8_t deviceId[] = {0x09, 0x00, 0x03};
+	static const uint8_t originBytes[] = {0x00, 0x80, 0x7E, 0x83, 0x81, 0x7F, 0x1A, 0x1C, 0x00, 0x00};
+	static const uint8_t state[] = {0x01, 0x80, 0x20, 0x83, 0x81, 0x7F, 0x1A, 0xC4};
+	static const uint8_t originWanted[] = {0x21, 0x80, 0x20, 0x83, 0x81, 0x7F, 0x1A, 0xC4};
+	const uint32_t cyclesPerUartByte = 800;
+	uint8_t uartBytes[HOST_PORT_MAX_UART_BYTES];
+	GCReaderController_t controller;
+	GCReaderStats_t stats;
+
+	GCControllerReader_Init();
+	HostPort_SetCyclesPerUartByte(cyclesPerUartByte);
+
+	/* Nothing plugged in is probed for until it answers */
+	CHECK(IsReaderCommand(probe, sizeof(probe)));
+	GCControllerReader_GetController(&controller);
+	CHECK(!controller.isConnected);
+
+	QueueControllerResponse(deviceId, sizeof(deviceId));
+	CHECK(IsReaderCommand(probe, sizeof(probe)));
+	QueueControllerResponse(originBytes, sizeof(originBytes));
+	CHECK(IsReaderCommand(origin, sizeof(origin)));
+	QueueControllerResponse(state, sizeof(state));
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+	CHECK(!HostPort_IsReceiving());
+
+	GCControllerReader_GetController(&controller);
+	GCControllerReader_GetStats(&stats);
+	CHECK(controller.isConnected);
+	CHECK(memcmp(controller.deviceId, deviceId, sizeof(deviceId)) == 0);
+	CHECK(memcmp(controller.origin, originBytes, sizeof(originBytes)) == 0);
+	CHECK(memcmp(controller.state, state, sizeof(state)) == 0);
+	CHECK((stats.numOfPolls == 1) && (stats.numOfTimeouts == 1) && (stats.numOfBadResponses == 0));
+	CHECK((stats.numOfConnects == 1) && (stats.numOfStateChanges == 1));
+	CHECK((stats.lastResponseDelay == cyclesPerUartByte) && (stats.minResponseDelay == cyclesPerUartByte));
+	CHECK((stats.maxResponseDelay == cyclesPerUartByte) && (stats.maxLateCycles == 0));
+
+	/* Nothing is sent before its time */
+	HostPort_AdvanceCycles((uint32_t)-1);
+	CHECK(GCControllerReader_RunOnce() == 0);
+	HostPort_AdvanceCycles(1);
+
+	/* Rumble goes out with every poll, an unchanged state is not a change */
+	GCControllerReader_SetRumble(0x01);
+	QueueControllerResponse(state, sizeof(state));
+	CHECK(IsReaderCommand(pollAndRumble, sizeof(pollAndRumble)));
+	GCControllerReader_SetRumble(0x00);
+	GCControllerReader_GetStats(&stats);
+	CHECK((stats.numOfPolls == 2) && (stats.numOfStateChanges == 1));
+
+	/* An invalid bit and a response cut short are bad, not missing */
+	uint32_t numOfUartBytes = ExpectedUartBytes(state, sizeof(state), uartBytes);
+	uartBytes[5] = 0x00;
+	HostPort_QueueUartBytes(uartBytes, numOfUartBytes);
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+	QueueControllerResponse(state, sizeof(state) - 1);
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+	GCControllerReader_GetStats(&stats);
+	CHECK((stats.numOfBadResponses == 2) && (stats.numOfTimeouts == 1));
+	GCControllerReader_GetController(&controller);
+	CHECK(controller.isConnected);
+
+	/* The third miss in a row has the controller probed again */
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+	GCControllerReader_GetController(&controller);
+	CHECK(!controller.isConnected);
+	QueueControllerResponse(deviceId, sizeof(deviceId));
+	CHECK(IsReaderCommand(probe, sizeof(probe)));
+	QueueControllerResponse(originBytes, sizeof(originBytes));
+	CHECK(IsReaderCommand(origin, sizeof(origin)));
+
+	/* A controller can ask for its origin to be read again */
+	QueueControllerResponse(originWanted, sizeof(originWanted));
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+	QueueControllerResponse(originBytes, sizeof(originBytes));
+	CHECK(IsReaderCommand(origin, sizeof(origin)));
+	QueueControllerResponse(state, sizeof(state));
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+
+	/* A late poll keeps to the grid, one a whole period late starts it over */
+	HostPort_AdvanceCycles(3000);
+	QueueControllerResponse(state, sizeof(state));
+	CHECK(IsReaderCommand(poll, sizeof(poll)));
+	GCControllerReader_GetStats(&stats);
+	CHECK(stats.maxLateCycles == 3000);
+
+	HostPort_AdvanceCycles(2 * GC_READER_POLL_PERIOD_CYCLES);
+	QueueControllerResponse(state, sizeof(state));
+	CHECK(GCControllerReader_RunOnce() == 1);
+	CHECK(GCControllerReader_RunOnce() == 0);
+	GCControllerReader_GetStats(&stats);
+	CHECK(stats.maxLateCycles == ((2 * GC_READER_POLL_PERIOD_CYCLES) + 3000));
+	CHECK((stats.numOfConnects == 2) && (stats.numOfTimeouts == 2) && (stats.numOfBadResponses == 2));
+	CHECK(HostPort_GetNumOfUnpreparedFrames() == 0);
+}
+#endif
+
+int main(void)
+{
+	GCControllerEmulation_Init();
+#if GC_USE_DEBOUNCE
+	// Only TestDebounce moves the cycle counter along with the inputs
+	BypassDebounce();
+#endif
+
+#if GC_USE_TELEMETRY
+	TestTelemetry();
+#endif
+	TestJoybusTables();
+	TestProbe();
+	TestProbeOriginAndRumble();
+	TestPollModes();
+	TestResetAndCalibrate();
+	TestIgnoredCommands();
+	TestBitErrorTolerance();
+	TestCaptureRx();
+	TestResponseCacheStats();
+	TestOverlapSampling();
+	TestSocdPolicies();
+	TestPollAllInputs();
+#if GC_USE_PROFILING
+	TestProfile();
+#endif
+#if GC_USE_INPUT_EDGES
+	TestInputEdges();
+#endif
+#if GC_USE_DEBOUNCE
+	TestDebounce();
+#endif
+#if GC_USE_DMA_SAMPLING && (GC_SAMPLE_WINDOW > 1)
+	TestInputSampling();
+#endif
+#if GC_USE_POLL_CADENCE
+	TestPollCadence();
+#endif
+#if GC_USE_MACROS
+	TestMacros();
+#endif
+#if GC_USE_RECORDING
+	TestRecording();
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	TestRecordingFlushWindow();
+#endif
+#endif
+#if GC_USE_REPLAY
+	TestReplay();
+#endif
+	TestWaveform();
+	TestMacroBytecode();
+	TestRecordingCodec();
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	TestConsolePorts();
+#endif
+#if !GC_USE_DMA_RX
+	// Its slow refreshes would move the refresh time of the cadence test
+	TestReceiveOverrun();
+
+	// Last, the reader takes over the port
+	TestControllerReader();
+#endif
+
+	if(numOfFailures != 0)
+	{
+		printf("%u checks failed\n", numOfFailures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,95 @@
+#ifndef GC_CADENCE_H_
+#define GC_CADENCE_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module follows the rate the console polls at. Every POLL is
+ * time stamped with the cycle counter and compared with the time it
+ * was predicted for. Like a PLL, the phase follows each poll right
+ * away while the period only moves by 1/16 of the error, so one late
+ * poll barely moves the prediction. Jitter is the mean of the absolute
+ * error, filtered the same way.
+ *
+ * Polls are time stamped when the POLL command has been received, so
+ * the predicted time is the end of the next POLL command.
+ */
+
+/* NOTE 2:
+ * ~ Refresh Time ~
+ * While locked, the response the console gets is built by one refresh
+ * started just in time. GCCadence_GetRefreshTime gives the cycle it has
+ * to start at to end the guard time plus twice the jitter before the
+ * predicted poll. The main loop idles until then instead of refreshing,
+ * and GCCadence_SetRefreshed marks it done until the next poll. Once
+ * the poll is later than that margin there is no refresh time, so a
+ * console that stops polling gets every refresh again.
+ */
+
+/* NOTE 3:
+ * Two intervals in a row within 1/8 of each other lock the tracker. A
+ * poll more than a quarter period off the prediction unlocks it, and it
+ * starts over from that poll.
+ */
+
+// Public Structures //
+/* Measured poll rate, all times in cycles */
+typedef struct
+{
+	uint32_t period;
+	uint32_t jitter;
+	uint32_t maxError;		/* Largest error while locked */
+	uint32_t numOfPolls;
+	uint32_t numOfLocks;
+	uint32_t numOfUnlocks;
+	uint32_t isLocked;
+} GCCadenceStats_t;
+
+/* Poll tracking of one controller. The period and jitter are kept with
+ * 4 fractional bits.
+ */
+typedef struct
+{
+	uint32_t periodQ4;
+	uint32_t jitterQ4;
+	uint32_t lastPoll;
+	uint32_t predictedPoll;
+	uint32_t hasPeriod;
+	uint32_t minPeriod;
+	uint32_t maxPeriod;
+	uint32_t guardCycles;
+	uint32_t isRefreshed;
+	GCCadenceStats_t stats;
+} GCCadence_t;
+
+// Public Function Prototypes //
+/* Starts unlocked with the shortest and longest period taken as a poll
+ * rate, and the guard time before a poll, all in cycles
+ */
+void GCCadence_Init(GCCadence_t *, uint32_t, uint32_t, uint32_t);
+
+/* Time stamps a POLL received at the given cycle */
+void GCCadence_Poll(GCCadence_t *, uint32_t);
+
+/* Gets the cycle the last refresh of the given number of cycles before
+ * the predicted poll has to start at. Returns 0 if there is none, while
+ * unlocked or once the poll is late at the given cycle.
+ */
+uint32_t GCCadence_GetRefreshTime(const GCCadence_t *, uint32_t, uint32_t, uint32_t *);
+
+/* Marks the last refresh before the predicted poll as started */
+void GCCadence_SetRefreshed(GCCadence_t *);
+
+/* Returns 1 once the last refresh before the predicted poll started */
+uint32_t GCCadence_IsRefreshed(const GCCadence_t *);
+
+/* Returns 1 if a poll came within the longest period before the given
+ * cycle
+ */
+uint32_t GCCadence_IsPolled(const GCCadence_t *, uint32_t);
+
+/* Gets the measured poll rate */
+void GCCadence_GetStats(const GCCadence_t *, GCCadenceStats_t *);
+
+#endif /* GC_CADENCE_H_ */
@@ -0,0 +1,60 @@
+#ifndef GC_CAPTURE_RX_H_
+#define GC_CAPTURE_RX_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module decodes the GC data line from the time stamps of its
+ * edges instead of from UART bytes. Every GC bit starts with a falling
+ * edge and is low for 1 us (a 1) or 3 us (a 0) of its about 4 us. A bit
+ * is a 1 if it was low for less time than it was high, so only the
+ * ratio matters and not how fast the console clock runs.
+ *
+ * The high time of a bit is only known at the falling edge of the next
+ * one, so every bit is decoded one edge late. The last bit, the stop
+ * bit, is only ended by the line staying idle.
+ */
+
+/* NOTE 2:
+ * Decoded bits come out as the UART bytes the USART1 receiver would
+ * give for them (the CASE1 byte of every bit pair and the stop bit
+ * byte), so the emulation does not know which receiver is used. A bit
+ * left over when the line goes idle comes out as an invalid UART byte
+ * before the stop bit, the same as a broken UART byte.
+ *
+ * Time stamps are free running 16 bit timer counts, any rate where a
+ * bit is well below 65536 counts works.
+ */
+
+// Public Macros //
+/* Most UART bytes GCCaptureRx_Idle gives */
+#define GC_CAPTURE_RX_MAX_IDLE_BYTES	2
+
+// Public Structures //
+/* Decoding state of the data line */
+typedef struct
+{
+	uint16_t fallTime;		/* Start of the bit being received */
+	uint16_t riseTime;
+	uint8_t isLow;			/* Next edge is a rising edge */
+	uint8_t hasBit;			/* A bit waits for the next falling edge */
+	uint8_t numOfBits;		/* Bits of bitPair already decoded */
+	uint8_t bitPair;
+} GCCaptureRx_t;
+
+// Public Function Prototypes //
+/* Starts over, waiting for the falling edge of a command's first bit */
+void GCCaptureRx_Reset(GCCaptureRx_t *);
+
+/* Takes the time stamp of the next edge. Returns 1 with the UART byte
+ * once a bit pair is complete.
+ */
+uint32_t GCCaptureRx_Edge(GCCaptureRx_t *, uint16_t, uint8_t *);
+
+/* Ends a command once the line went idle, and starts over. Returns the
+ * number of UART bytes given, 0 if no bit was being received.
+ */
+uint32_t GCCaptureRx_Idle(GCCaptureRx_t *, uint8_t *);
+
+#endif /* GC_CAPTURE_RX_H_ */
@@ -2,26 +2,301 @@
 #define GC_CONTROLLER_EMULATION_H_
 
 #include <stdint.h>
-#include "stm32f4xx_hal.h"
-#include "io_mapping_stm32f411ce_blackpill_weactstudio_v3_0.h"
 #include "shared_enums.h"
+#include "gc_joybus.h"
+#include "gc_socd.h"
+#include "gc_debounce.h"
+#include "gc_cadence.h"
+
+// Build Options //
+/* Set to 1 to send responses with DMA2 stream 7 instead of writing
+ * every UART byte by hand. The stop bit is then sent from the USART1
+ * transmission complete interrupt.
+ */
+#ifndef GC_USE_DMA_TX
+#define GC_USE_DMA_TX	0
+#endif
+
+/* Set to 1 to have the stop bit made by a timer in one pulse mode on
+ * the GC_STOP pin, so sending it costs no CPU time. Set to 0 to hold
+ * the pin low by hand while counting CPU cycles.
+ */
+#ifndef GC_USE_TIMER_STOP_BIT
+#define GC_USE_TIMER_STOP_BIT	1
+#endif
+
+/* Set to 1 to receive commands with DMA2 stream 2 in a circular buffer.
+ * A command is decoded and answered from the USART1 interrupt once the
+ * line goes idle after its stop bit, so GCControllerEmulation_Run only
+ * refreshes the ready response. Best used with GC_USE_DMA_TX so the
+ * interrupt does not wait for the response to be sent.
+ */
+#ifndef GC_USE_DMA_RX
+#define GC_USE_DMA_RX	0
+#endif
+
+/* Set to 1 to receive commands by time stamping every edge of the data
+ * line with TIM4 channel 2 and DMA1 stream 3 instead of with the USART1
+ * receiver, see gc_capture_rx.h. Bits are told apart by how long they
+ * are low compared to high, so the console clock and the UART baud rate
+ * do not have to agree. USART1 then only sends. Not supported together
+ * with GC_USE_DMA_RX.
+ */
+#ifndef GC_USE_CAPTURE_RX
+#define GC_USE_CAPTURE_RX	0
+#endif
+
+/* Set to 1 to send responses as a waveform of GPIO BSRR words, one per
+ * microsecond, written to the TX pin by DMA2 stream 5 on every TIM1
+ * update, see gc_waveform.h. The stop bit is part of the waveform so
+ * the GC_STOP pin is not used, and the CPU only starts the DMA. The
+ * waveform is rendered whenever the response is refreshed. With
+ * GC_USE_DMA_RX, receiving starts again from the transfer complete
+ * interrupt of the stream. Not supported together with GC_USE_DMA_TX,
+ * which sends with the UART instead, or GC_USE_DMA_SAMPLING, which also
+ * uses TIM1 and DMA2 stream 5.
+ */
+#ifndef GC_USE_WAVEFORM_TX
+#define GC_USE_WAVEFORM_TX	0
+#endif
+
+/* Set to 1 to time every phase of answering the console with the cycle
+ * counter and keep histograms of them in RAM, see gc_profile.h. When 0
+ * the timing compiles to nothing.
+ */
+#ifndef GC_USE_PROFILING
+#define GC_USE_PROFILING	0
+#endif
+
+/* Set to 1 to stream a binary record of every console command out of
+ * the expansion port with USART6, see gc_telemetry.h.
+ */
+#ifndef GC_USE_TELEMETRY
+#define GC_USE_TELEMETRY	0
+#endif
+
+/* SOCD policy of each axis group, one of GCSocdPolicy_t */
+#ifndef GC_SOCD_DPAD_POLICY
+#define GC_SOCD_DPAD_POLICY			GC_SOCD_NEUTRAL
+#endif
+
+#ifndef GC_SOCD_MAIN_STICK_POLICY
+#define GC_SOCD_MAIN_STICK_POLICY	GC_SOCD_NEUTRAL
+#endif
+
+#ifndef GC_SOCD_C_STICK_POLICY
+#define GC_SOCD_C_STICK_POLICY		GC_SOCD_NEUTRAL
+#endif
+
+/* Set to 1 to time stamp every press and release, from the EXTI
+ * interrupts of the input pins on the uC, see gc_input_edges.h.
+ */
+#ifndef GC_USE_INPUT_EDGES
+#define GC_USE_INPUT_EDGES	0
+#endif
+
+/* Number of responses a press is kept in with GC_USE_INPUT_EDGES, even
+ * if the button is let go first. 0 turns pulse stretching off.
+ */
+#ifndef GC_INPUT_STRETCH_POLLS
+#define GC_INPUT_STRETCH_POLLS	1
+#endif
+
+/* Set to 1 to have TIM1 and DMA2 copy the input ports to RAM at
+ * GC_SAMPLE_RATE_HZ without the CPU. The snapshot then uses the newest
+ * GC_SAMPLE_WINDOW samples, and a button only changes state once all
+ * of them agree.
+ */
+#ifndef GC_USE_DMA_SAMPLING
+#define GC_USE_DMA_SAMPLING	0
+#endif
+
+#ifndef GC_SAMPLE_RATE_HZ
+#define GC_SAMPLE_RATE_HZ	8000
+#endif
+
+#ifndef GC_SAMPLE_WINDOW
+#define GC_SAMPLE_WINDOW	1
+#endif
+
+/* Set to 1 to debounce the snapshot before it is processed, see
+ * gc_debounce.h. Thresholds are in ticks of GC_DEBOUNCE_TICK_CYCLES
+ * (1 ms at 100 MHz), up to GC_DEBOUNCE_MAX_TICKS.
+ */
+#ifndef GC_USE_DEBOUNCE
+#define GC_USE_DEBOUNCE		0
+#endif
+
+#ifndef GC_DEBOUNCE_TICK_CYCLES
+#define GC_DEBOUNCE_TICK_CYCLES		100000
+#endif
+
+/* Mode of every group, one of GCDebounceMode_t */
+#ifndef GC_DEBOUNCE_MODE
+#define GC_DEBOUNCE_MODE			GC_DEBOUNCE_EAGER
+#endif
+
+#ifndef GC_DEBOUNCE_BUTTONS_MS
+#define GC_DEBOUNCE_BUTTONS_MS		5
+#endif
+
+#ifndef GC_DEBOUNCE_DPAD_MS
+#define GC_DEBOUNCE_DPAD_MS			5
+#endif
+
+#ifndef GC_DEBOUNCE_MAIN_STICK_MS
+#define GC_DEBOUNCE_MAIN_STICK_MS	3
+#endif
+
+#ifndef GC_DEBOUNCE_C_STICK_MS
+#define GC_DEBOUNCE_C_STICK_MS		3
+#endif
+
+#ifndef GC_DEBOUNCE_MODIFIERS_MS
+#define GC_DEBOUNCE_MODIFIERS_MS	5
+#endif
+
+/* Set to 1 to follow the rate the console polls at and refresh the
+ * response just in time for the predicted poll, see gc_cadence.h. The
+ * main loop idles until the refresh that ends GC_POLL_GUARD_CYCLES
+ * before the predicted end of the POLL command, which itself takes
+ * about 10000 cycles (100 us) on the line. Without GC_USE_DMA_RX it
+ * then only listens for the command.
+ */
+#ifndef GC_USE_POLL_CADENCE
+#define GC_USE_POLL_CADENCE		0
+#endif
+
+#ifndef GC_POLL_GUARD_CYCLES
+#define GC_POLL_GUARD_CYCLES		15000
+#endif
+
+/* Intervals taken as a poll rate, 0.5 ms to 50 ms at 100 MHz */
+#ifndef GC_POLL_MIN_PERIOD_CYCLES
+#define GC_POLL_MIN_PERIOD_CYCLES	50000
+#endif
+
+#ifndef GC_POLL_MAX_PERIOD_CYCLES
+#define GC_POLL_MAX_PERIOD_CYCLES	5000000
+#endif
+
+/* Refreshes the response as soon as the first GC byte of a command
+ * reads as a POLL, while its other 2 bytes and stop bit are still on
+ * the line. The inputs sent are then about 70 us newer. This only
+ * applies without GC_USE_DMA_RX, which refreshes from the main loop
+ * during reception anyway.
+ *
+ * The UART holds one byte besides the one arriving, so the refresh has
+ * to end within about 900 cycles (one UART byte) or the command is
+ * overrun. An overrun is counted in overrunErrors of
+ * GCControllerEmulation_GetRxStats and the command is not answered.
+ * Check the snapshot, debounce, process and encode phases of
+ * GC_USE_PROFILING before turning on slow options with this.
+ */
+#ifndef GC_USE_OVERLAP_SAMPLING
+#define GC_USE_OVERLAP_SAMPLING		0
+#endif
+
+/* Number of console ports served at once, from 1 to 3. Port 0 is on
+ * USART1 as always, port 1 on USART2 and port 2 on USART6, see Note 6.
+ * More than 1 needs GC_USE_DMA_RX and GC_USE_DMA_TX so every port is
+ * answered from its own interrupt.
+ */
+#ifndef GC_NUM_OF_CONSOLE_PORTS
+#define GC_NUM_OF_CONSOLE_PORTS		1
+#endif
+
+/* Set to 1 to play back the input sequences of gc_macro_profile.h,
+ * picked with MACRO held and one of A, B, X or Y, see gc_macro.h. A
+ * sequence steps once per POLL of console port 0.
+ */
+#ifndef GC_USE_MACROS
+#define GC_USE_MACROS		0
+#endif
+
+/* Set to 1 to record the inputs sent with every POLL of console port 0
+ * into flash sectors 6 and 7, see gc_recording.h. A session goes after
+ * the ones already recorded, and holding START at power up erases them
+ * first. Recording stops once the 256 KB are full, which at 60 polls
+ * per second is hours of normal play.
+ */
+#ifndef GC_USE_RECORDING
+#define GC_USE_RECORDING	0
+#endif
+
+/* Most words of the recording programmed after one poll. Words are only
+ * programmed right after a response, and each stalls the CPU for about
+ * 16 us, so this bounds the stall well inside the time to the next poll.
+ */
+#ifndef GC_RECORDING_WORDS_PER_POLL
+#define GC_RECORDING_WORDS_PER_POLL	4
+#endif
+
+/* Cycles one word of the recording stalls the CPU for, about 16 us at
+ * 100 MHz. With more than one console port, words are only programmed
+ * while the poll cadence of every port leaves room for all of them.
+ */
+#ifndef GC_RECORDING_WORD_CYCLES
+#define GC_RECORDING_WORD_CYCLES	1600
+#endif
+
+/* Set to 1 to send the recording in flash instead of the inputs, one
+ * recorded poll for every POLL of console port 0 from power up, and go
+ * back to the inputs once it ends. Not supported together with
+ * GC_USE_RECORDING.
+ */
+#ifndef GC_USE_REPLAY
+#define GC_USE_REPLAY		0
+#endif
+
+/* Set to 1 to act as the console instead, and poll a real controller
+ * plugged into console port 0, see gc_controller_reader.h. Commands go
+ * out the same way responses do, so GC_USE_DMA_TX or GC_USE_WAVEFORM_TX
+ * send them with DMA. Responses are waited for by the reader itself, so
+ * it cannot be used with GC_USE_DMA_RX.
+ */
+#ifndef GC_USE_READER_MODE
+#define GC_USE_READER_MODE				0
+#endif
+
+/* Time between two polls of the controller, 1 ms (1 kHz) at 100 MHz */
+#ifndef GC_READER_POLL_PERIOD_CYCLES
+#define GC_READER_POLL_PERIOD_CYCLES	100000
+#endif
+
+/* Longest wait for the first UART byte of a response after the stop bit
+ * of the command, and for every UART byte after it, 100 us and 50 us at
+ * 100 MHz. A UART byte takes about 8 us on the line.
+ */
+#ifndef GC_READER_RESPONSE_TIMEOUT_CYCLES
+#define GC_READER_RESPONSE_TIMEOUT_CYCLES	10000
+#endif
+
+#ifndef GC_READER_BYTE_TIMEOUT_CYCLES
+#define GC_READER_BYTE_TIMEOUT_CYCLES	5000
+#endif
 
 // Notes //
 /* NOTE 1:
- * This module will emulate a GC controller. It currently will
- * only process some commands from the console, and that is the
- * PROBE, PROBE_ORIGIN, and POLL commands. Other commands can be
- * easily extended but there might be a slight change to how the
- * input data is stored.
+ * This module will emulate a GC controller. It processes the
+ * commands a standard controller answers, and that is the PROBE,
+ * RESET, PROBE_ORIGIN, CALIBRATE and POLL commands. Other commands
+ * can be easily extended by adding a handler for the first byte of
+ * the command in gcCommandHandlers.
  *
  * The trick this module employs is that it uses a UART to emulate
  * the GC controller protocol, which is 1-wire, going at a
  * pretty fast speed.
+ *
+ * All hardware access goes through gc_port.h, so this module builds
+ * on a PC as well (see the Host folder).
  */
 
 /* NOTE 2:
- * ~ PROBE Command ~
- * This command sent from the console as: 0x00, STOP.
+ * ~ PROBE and RESET Commands ~
+ * These commands are sent from the console as: 0x00, STOP and
+ * 0xFF, STOP. RESET also stops rumble and sets the poll mode back to
+ * the standard one.
  * When responding to a PROBE command, below is the controller
  * response byte structure. MSB is sent first. Terminate with
  * stop bit after all bytes are sent.
@@ -32,8 +307,10 @@
  */
 
 /* NOTE 3:
- * ~ PROBE ORIGIN Command ~
- * This command sent from the console as: 0x41, STOP.
+ * ~ PROBE ORIGIN and CALIBRATE Commands ~
+ * These commands are sent from the console as: 0x41, STOP and
+ * 0x42, 0x00, 0x00, STOP. The sticks are digital so calibrating
+ * changes nothing and both get the same answer.
  * When responding to a PROBE ORIGIN command, below is the
  * controller response byte structure. MSB is sent first.
  * Terminate with stop bit after all bytes are sent. Terminate
@@ -48,16 +325,17 @@
  * BYTE  5:               Y AXIS: C STICK
  * BYTE  6:               L TRIGGER
  * BYTE  7:               R TRIGGER
- * BYTE  8:                  0x00
- * BYTE  9:                  0x00
+ * BYTE  8:               ANALOG A (0x00)
+ * BYTE  9:               ANALOG B (0x00)
  */
 
 /* NOTE 4:
  * ~ POLL Command ~
- * This command sent from the console as: 0x40, 0x03, (0x00 or 0x01), STOP.
- * 0x00 means turn rumble off, and 0x01 means turns rumble on.
- * When responding to a POLL command, below is the
- * controller response byte structure. MSB is sent first.
+ * This command sent from the console as: 0x40, (0x00 to 0x07), (0x00, 0x01 or 0x02), STOP.
+ * The second byte is the poll mode. For the third byte 0x00 means turn
+ * rumble off, 0x01 means turns rumble on and 0x02 means brake it.
+ * When responding to a POLL command in the standard mode 0x03, below
+ * is the controller response byte structure. MSB is sent first.
  * Terminate with stop bit after all bytes are sent. Terminate
  * with stop bit after all bytes are sent.
  *
@@ -70,6 +348,19 @@
  * BYTE  5:               C STICK Y AXIS
  * BYTE  6:               L TRIGGER
  * BYTE  7:               R TRIGGER
+ *
+ * The other modes trade precision of some values for analog A and B.
+ * Bytes 0 to 3 never change, and a value with only 4 bits is the top
+ * half of the full one, the first value in the high nibble:
+ *
+ * MODE 0, 5, 6, 7: CX, CY, L/R 4 bits, A/B 4 bits
+ * MODE 1:          CX/CY 4 bits, L, R, A/B 4 bits
+ * MODE 2:          CX/CY 4 bits, L/R 4 bits, A, B
+ * MODE 4:          CX, CY, A, B
+ *
+ * Each mode has a packer in gcPollPackers. The ready response is built
+ * by the packer of the last poll, so only a change of mode packs the
+ * response while the console waits.
  */
 
 /* Note 5:
@@ -81,26 +372,57 @@
  * Since a UART byte is two GC bits, the left bit is send first and
  * the right bit is sent second. For example 01 as bit pair. This means
  * Z = 0 & START = 1. Or Z = RELEASED & START = PUSHED.
+ *
+ * GC_USE_CAPTURE_RX avoids this error by timing the bits instead, and
+ * only ever gives the CASE1 bytes.
+ */
+
+/* Note 6:
+ * Every console port has its own command decoder, ready responses,
+ * poll mode and stats, so each one is a controller of its own to its
+ * console. They all send the same inputs, which are sampled, debounced
+ * and processed once per pass of the main loop and encoded into the
+ * ready response of each port. Only a port that waits for its refresh
+ * time with GC_USE_POLL_CADENCE samples them again.
+ *
+ * A port is answered from the interrupt of its own USART with a
+ * response that is already encoded, so a busy port only delays another
+ * one by the few cycles its interrupt takes. The main loop refreshes
+ * the ports one after the other and a port that is still sending is
+ * skipped until the next pass.
  */
 
 // Public Macros //
-/* Byte order for GC console response */
-#define GC_CONSOLE_BYTE_0_BIT7_BIT6	0
-#define GC_CONSOLE_BYTE_0_BIT5_BIT4	1
-#define GC_CONSOLE_BYTE_0_BIT3_BIT2	2
-#define GC_CONSOLE_BYTE_0_BIT1_BIT0	3
-#define GC_CONSOLE_BYTE_1_BIT7_BIT6	4
-#define GC_CONSOLE_BYTE_1_BIT5_BIT4	5
-#define GC_CONSOLE_BYTE_1_BIT3_BIT2	6
-#define GC_CONSOLE_BYTE_1_BIT1_BIT0	7
-#define GC_CONSOLE_BYTE_2_BIT7_BIT6	8
-#define GC_CONSOLE_BYTE_2_BIT5_BIT4	9
-#define GC_CONSOLE_BYTE_2_BIT3_BIT2	10
-#define GC_CONSOLE_BYTE_2_BIT1_BIT0	11
-#define GC_CONSOLE_TEMP_BITS		12
-
-/* Number of maximum UART bytes to receive from console */
-#define MAX_GC_CONSOLE_BYTES	13
+/* Bit of a button inside a packed input word. Bit n holds the input
+ * n of GCButtonInput_t and a set bit means the input is PUSHED.
+ */
+#define GC_BUTTON_MASK(gcButton)	(1UL << (gcButton))
+
+/* Number of maximum GC bytes in a command from the console */
+#define MAX_GC_CONSOLE_COMMAND_BYTES	3
+
+// Public Structures //
+/* How old the sampled inputs were when a ready-to-send response went
+ * out to the console. Ages are in CPU cycles.
+ */
+typedef struct
+{
+	uint32_t lastInputAge;
+	uint32_t maxInputAge;
+	uint32_t numOfResponses;
+} GCResponseCacheStats_t;
+
+/* Receive errors from the USART status register and decoded command counts. The error
+ * counts are not kept with GC_USE_CAPTURE_RX.
+ */
+typedef struct
+{
+	uint32_t framingErrors;
+	uint32_t overrunErrors;
+	uint32_t noiseErrors;
+	uint32_t numOfCommands;
+	uint32_t numOfBadCommands;
+} GCRxStats_t;
 
 // Public Function Prototypes //
 /* Call before using this module */
@@ -109,10 +431,31 @@ void GCControllerEmulation_Init(void);
 /* Call to run the controller emulation forever */
 void GCControllerEmulation_Run(void);
 
+/* One pass of the emulation loop, waits for and answers one command
+ * unless GC_USE_DMA_RX is set
+ */
+void GCControllerEmulation_RunOnce(void);
+
 /* Get all button states*/
 void GCControllerEmulation_GetSwitchSnapshot(void);
 
-/* Get a particular button state */
-ButtonState_t GCControllerEmulation_GetButtonState(GCButtonInput_t);
+/* Get receive errors and command counts of a console port */
+void GCControllerEmulation_GetRxStats(uint32_t, GCRxStats_t *);
+
+/* Get how old inputs were when responses were sent on a console port */
+void GCControllerEmulation_GetResponseCacheStats(uint32_t, GCResponseCacheStats_t *);
+
+/* Get the measured poll period and jitter of a console port, with
+ * GC_USE_POLL_CADENCE
+ */
+void GCControllerEmulation_GetCadenceStats(uint32_t, GCCadenceStats_t *);
+
+/* Change how an axis group resolves opposite directions */
+void GCControllerEmulation_SetSocdPolicy(GCSocdGroup_t, GCSocdPolicy_t);
+
+/* Change the debounce mode and threshold in ticks of an input group,
+ * with GC_USE_DEBOUNCE
+ */
+void GCControllerEmulation_SetDebounce(GCDebounceGroup_t, GCDebounceMode_t, uint32_t);
 
 #endif /* GC_CONTROLLER_EMULATION_H_ */
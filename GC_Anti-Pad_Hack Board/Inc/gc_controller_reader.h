@@ -0,0 +1,104 @@
+#ifndef GC_CONTROLLER_READER_H_
+#define GC_CONTROLLER_READER_H_
+
+#include <stdint.h>
+#include "gc_controller_emulation.h"
+
+// Notes //
+/* NOTE 1:
+ * This module is the other end of gc_controller_emulation.c: it acts
+ * as the console and polls a real controller plugged into console
+ * port 0, with GC_USE_READER_MODE. The same UART 1-wire trick is used,
+ * commands are encoded with gcJoybusEncodeTable and sent like a
+ * response, and the response is decoded with gcJoybusDecodeTable until
+ * the controller stop bit.
+ *
+ * This is where the separate stop bit pin matters (see
+ * GCControllerEmulation_GetConsoleCommand). A controller answers a few
+ * microseconds after the stop bit of the command, so the receiver is
+ * turned back on right after the pin releases the line.
+ */
+
+/* NOTE 2:
+ * ~ Connecting ~
+ * A controller is sent a PROBE until it answers, then a PROBE ORIGIN
+ * for the values of its sticks and triggers at rest. From then on it is
+ * sent a POLL in the standard mode 3 every GC_READER_POLL_PERIOD_CYCLES.
+ * GC_READER_MAX_MISSES polls in a row without a good response, and the
+ * controller is probed again. A controller that sets bit 5 of the first
+ * POLL response byte asks for its origin to be read again.
+ */
+
+/* NOTE 3:
+ * ~ Timing ~
+ * Polls are scheduled on a fixed grid of GC_READER_POLL_PERIOD_CYCLES.
+ * How late a poll starts is measured against the grid, and a poll more
+ * than a whole period late starts the grid over from it.
+ *
+ * The response delay of a poll is from the end of the stop bit of the
+ * command to the first UART byte of the response being received, so it
+ * includes the 8 us of that UART byte. Compared between controllers or
+ * between polls it shows how fast and how steady a controller answers.
+ */
+
+// Public Macros //
+/* Number of GC bytes in each response of a controller */
+#define GC_READER_PROBE_BYTES	3
+#define GC_READER_ORIGIN_BYTES	10
+#define GC_READER_POLL_BYTES	8
+
+/* Polls in a row without a good response before probing again */
+#define GC_READER_MAX_MISSES	3
+
+// Public Structures //
+/* What the reader knows of the controller. The state and origin are
+ * the GC bytes of the POLL and PROBE ORIGIN responses, see Note 3 and
+ * Note 4 of gc_controller_emulation.h.
+ */
+typedef struct
+{
+	uint8_t deviceId[GC_READER_PROBE_BYTES];
+	uint8_t origin[GC_READER_ORIGIN_BYTES];
+	uint8_t state[GC_READER_POLL_BYTES];
+	uint32_t stateTime;			/* Cycle the state was polled at */
+	uint32_t isConnected;
+} GCReaderController_t;
+
+/* Counts of the exchanges with the controller, times in cycles */
+typedef struct
+{
+	uint32_t numOfPolls;
+	uint32_t numOfTimeouts;			/* Commands without any response */
+	uint32_t numOfBadResponses;		/* Responses with invalid bits, cut short or of the wrong length */
+	uint32_t numOfConnects;
+	uint32_t numOfStateChanges;		/* Polls whose state differed from the last one */
+	uint32_t lastResponseDelay;		/* See Note 3 */
+	uint32_t minResponseDelay;
+	uint32_t maxResponseDelay;
+	uint32_t maxLateCycles;			/* Latest a command started after its time */
+} GCReaderStats_t;
+
+// Public Function Prototypes //
+/* Sets up console port 0 and starts probing for a controller */
+void GCControllerReader_Init(void);
+
+/* Polls the controller forever */
+void GCControllerReader_Run(void);
+
+/* Sends the next command once it is time to. Returns 1 if a command
+ * was sent, 0 if it is not time yet.
+ */
+uint32_t GCControllerReader_RunOnce(void);
+
+/* Sets the rumble byte sent with every POLL, 0x00 off, 0x01 on and
+ * 0x02 brake
+ */
+void GCControllerReader_SetRumble(uint8_t);
+
+/* Gets what is known of the controller */
+void GCControllerReader_GetController(GCReaderController_t *);
+
+/* Gets the counts of the exchanges so far */
+void GCControllerReader_GetStats(GCReaderStats_t *);
+
+#endif /* GC_CONTROLLER_READER_H_ */
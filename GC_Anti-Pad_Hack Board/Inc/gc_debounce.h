@@ -0,0 +1,81 @@
+#ifndef GC_DEBOUNCE_H_
+#define GC_DEBOUNCE_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module debounces a packed input word, see GC_BUTTON_MASK. Every
+ * input has a 4 bit counter, stored as vertical counters: bit n of
+ * count[b] is bit b of the counter of input n. All 22 counters are then
+ * stepped at once with a few bitwise operations per counter bit.
+ *
+ * Counters step once per tick of the cycle counter (1 ms by default),
+ * however often the snapshot is taken. A threshold of 0 passes the
+ * inputs of a group straight through.
+ */
+
+/* NOTE 2:
+ * ~ Modes ~
+ * EAGER:    an input follows its first edge at once, then ignores the
+ *           pin until threshold ticks went by. Nothing is added to the
+ *           press, but chatter after it is not seen.
+ * DEFERRED: an input only changes once the pin has read the other way
+ *           for threshold ticks in a row. Any bounce back starts the
+ *           count over, so chatter never makes an input.
+ */
+
+// Public Macros //
+/* Bits of each counter, which sets the highest threshold */
+#define GC_DEBOUNCE_COUNTER_BITS	4
+#define GC_DEBOUNCE_MAX_TICKS		((1UL << GC_DEBOUNCE_COUNTER_BITS) - 1)
+
+// Public Enums //
+typedef enum
+{
+	GC_DEBOUNCE_EAGER = 0,
+	GC_DEBOUNCE_DEFERRED,
+	NUM_OF_GC_DEBOUNCE_MODES
+} GCDebounceMode_t;
+
+/* Inputs that share a mode and threshold */
+typedef enum
+{
+	GC_DEBOUNCE_GROUP_BUTTONS = 0,		/* A, B, X, Y, L, R, Z and START */
+	GC_DEBOUNCE_GROUP_DPAD,
+	GC_DEBOUNCE_GROUP_MAIN_STICK,
+	GC_DEBOUNCE_GROUP_C_STICK,
+	GC_DEBOUNCE_GROUP_MODIFIERS,		/* MACRO and TILT */
+	NUM_OF_GC_DEBOUNCE_GROUPS
+} GCDebounceGroup_t;
+
+// Public Structures //
+/* Debounce state of one controller. The threshold of each input is
+ * stored like its counter, one bit per word.
+ */
+typedef struct
+{
+	uint32_t state;
+	uint32_t count[GC_DEBOUNCE_COUNTER_BITS];
+	uint32_t threshold[GC_DEBOUNCE_COUNTER_BITS];
+	uint32_t eager;			/* Inputs in EAGER mode */
+	uint32_t bypass;		/* Inputs with a threshold of 0 */
+	uint32_t locked;		/* EAGER inputs ignoring their pin */
+	uint32_t tickCycles;
+	uint32_t lastTick;
+} GCDebounce_t;
+
+// Public Function Prototypes //
+/* Starts from the given inputs at the given cycle, with ticks of the
+ * given number of cycles. Every group passes straight through until
+ * it is set.
+ */
+void GCDebounce_Init(GCDebounce_t *, uint32_t, uint32_t, uint32_t);
+
+/* Changes the mode and threshold in ticks of a group */
+void GCDebounce_SetGroup(GCDebounce_t *, GCDebounceGroup_t, GCDebounceMode_t, uint32_t);
+
+/* Debounces a packed input word sampled at the given cycle */
+uint32_t GCDebounce_Process(GCDebounce_t *, uint32_t, uint32_t);
+
+#endif /* GC_DEBOUNCE_H_ */
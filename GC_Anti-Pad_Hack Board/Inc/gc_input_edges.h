@@ -0,0 +1,95 @@
+#ifndef GC_INPUT_EDGES_H_
+#define GC_INPUT_EDGES_H_
+
+#include <stdint.h>
+#include "gc_controller_emulation.h"
+
+// Notes //
+/* NOTE 1:
+ * This module keeps track of every press and release with the cycle
+ * counter time it was seen at. Inputs are captured both by the main
+ * loop snapshot and, on the uC, by the EXTI interrupt of a pin, so an
+ * edge is usually timed to within a few cycles.
+ *
+ * It is only built with GC_USE_INPUT_EDGES.
+ */
+
+/* NOTE 2:
+ * ~ Pulse Stretching ~
+ * A press is held in the pending word of every console port until it
+ * went out in GC_INPUT_STRETCH_POLLS responses of that port, even if
+ * the button was let go before that. A tap shorter than the time
+ * between two polls is then still seen by every console. The sampled
+ * inputs are shared by the ports, so they keep a press until the last
+ * port is done with it. Only ports that sent a response within
+ * GC_POLL_MAX_PERIOD_CYCLES hold presses, so a port without a console
+ * does not hold them forever. With GC_INPUT_STRETCH_POLLS at 0 presses
+ * are only timed.
+ */
+
+/* NOTE 3:
+ * ~ Latency ~
+ * The first response that carries a press, on any port, ends its
+ * press-to-poll latency, the time from the edge to the start of that
+ * response.
+ */
+
+/* NOTE 4:
+ * Captures come from interrupts and the main loop, so every function
+ * here runs with GCPort_LockInputs held.
+ */
+
+// Public Macros //
+/* Edges the ring can hold, must be a power of 2 */
+#define GC_INPUT_EDGE_RING_SIZE		64
+
+// Public Structures //
+/* One press or release */
+typedef struct
+{
+	uint32_t timestamp;
+	uint8_t button;			/* GCButtonInput_t */
+	uint8_t pushed;			/* 1 for a press, 0 for a release */
+} GCInputEdge_t;
+
+/* Counts and press-to-poll latency in cycles */
+typedef struct
+{
+	uint32_t numOfEdges;
+	uint32_t numOfDroppedEdges;
+	uint32_t numOfPresses;
+	uint32_t numOfStretchedPresses;	/* Let go before the console saw them */
+	uint32_t minLatency;
+	uint32_t maxLatency;
+	uint64_t totalLatency;
+	uint32_t numOfLatencies;
+} GCInputEdgeStats_t;
+
+// Public Function Prototypes //
+#if GC_USE_INPUT_EDGES
+/* Starts from the given inputs without making edges for them */
+void GCInputEdges_Init(uint32_t);
+
+/* Compares inputs sampled at the given cycle with the last ones and
+ * records every edge
+ */
+void GCInputEdges_Capture(uint32_t, uint32_t);
+
+/* Captures inputs sampled at the given cycle and returns them with the
+ * stretched presses added
+ */
+uint32_t GCInputEdges_Sample(uint32_t, uint32_t);
+
+/* Tells which inputs went out in a response of a console port started
+ * at the given cycle
+ */
+void GCInputEdges_Delivered(uint32_t, uint32_t, uint32_t);
+
+/* Takes the oldest edge from the ring, returns 0 if there is none */
+uint32_t GCInputEdges_Read(GCInputEdge_t *);
+
+/* Gets the counts and latency */
+void GCInputEdges_GetStats(GCInputEdgeStats_t *);
+#endif
+
+#endif /* GC_INPUT_EDGES_H_ */
@@ -0,0 +1,106 @@
+#ifndef GC_JOYBUS_H_
+#define GC_JOYBUS_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module converts between GC bytes and the UART bytes used to
+ * fake the GC 1-wire protocol. It does not touch any hardware so it
+ * can be used anywhere the conversion is needed.
+ *
+ * One UART byte carries two GC bits (see Note 5 in
+ * gc_controller_emulation.h), so one GC byte is four UART bytes.
+ */
+
+/* NOTE 2:
+ * The encode table holds the four UART bytes of every GC byte packed
+ * in a uint32_t. The UART byte for BIT 7 & BIT 6 is in the lowest
+ * byte and the one for BIT 1 & BIT 0 in the highest byte. Since the
+ * uC is little endian, an array of these words in memory is already
+ * the UART byte stream in the order it must be sent.
+ */
+
+/* NOTE 3:
+ * The decode table turns a received UART byte back into its GC bit
+ * pair. Both CASE1 and CASE2 bytes of a pair decode to the same bits
+ * so the bit error tolerance in Note 5 of gc_controller_emulation.h
+ * is kept. The console stop bit decodes to GC_JOYBUS_STOP_BIT and
+ * every other byte to GC_JOYBUS_INVALID_BITS.
+ */
+
+// Public Macros //
+/* Number of UART bytes needed to send one GC byte */
+#define GC_UART_BYTES_PER_GC_BYTE	4
+
+/* Number of GC bytes in the biggest response to the console */
+#define GC_MAX_RESPONSE_BYTES		10
+
+/* UART byte for a GC bit pair (left bit is sent first) */
+#define GC_JOYBUS_BITS_TO_UART(bitPair) \
+	( ((bitPair) == 0) ? GC_BITS_00_CASE1 : \
+	  ((bitPair) == 1) ? GC_BITS_01_CASE1 : \
+	  ((bitPair) == 2) ? GC_BITS_10_CASE1 : GC_BITS_11_CASE1 )
+
+/* Four UART bytes of a GC byte, see Note 2 */
+#define GC_JOYBUS_ENCODE(gcByte) \
+	( ((uint32_t)GC_JOYBUS_BITS_TO_UART(((gcByte) >> 6) & 0x03)) | \
+	  ((uint32_t)GC_JOYBUS_BITS_TO_UART(((gcByte) >> 4) & 0x03) << 8) | \
+	  ((uint32_t)GC_JOYBUS_BITS_TO_UART(((gcByte) >> 2) & 0x03) << 16) | \
+	  ((uint32_t)GC_JOYBUS_BITS_TO_UART((gcByte) & 0x03) << 24) )
+
+/* Decoded values that are not a GC bit pair */
+#define GC_JOYBUS_STOP_BIT			0x10
+#define GC_JOYBUS_INVALID_BITS		0x20
+
+/* GC bit pair of a UART byte, see Note 3 */
+#define GC_JOYBUS_DECODE(uartByte) \
+	( (((uartByte) == GC_BITS_00_CASE1) || ((uartByte) == GC_BITS_00_CASE2)) ? 0 : \
+	  (((uartByte) == GC_BITS_01_CASE1) || ((uartByte) == GC_BITS_01_CASE2)) ? 1 : \
+	  (((uartByte) == GC_BITS_10_CASE1) || ((uartByte) == GC_BITS_10_CASE2)) ? 2 : \
+	  (((uartByte) == GC_BITS_11_CASE1) || ((uartByte) == GC_BITS_11_CASE2)) ? 3 : \
+	  ((uartByte) == GC_BITS_STOP_BIT) ? GC_JOYBUS_STOP_BIT : GC_JOYBUS_INVALID_BITS )
+
+// Enumerations //
+/* GC Bits to UART Bytes */
+typedef enum
+{
+	GC_BITS_00_CASE1 = 0x08,
+	GC_BITS_00_CASE2 = 0x88,
+	GC_BITS_01_CASE1 = 0xE8,
+	GC_BITS_01_CASE2 = 0xC8,
+	GC_BITS_10_CASE1 = 0x0F,
+	GC_BITS_10_CASE2 = 0x8F,
+	GC_BITS_11_CASE1 = 0xEF,
+	GC_BITS_11_CASE2 = 0xCF,
+	GC_BITS_STOP_BIT = 0xFF
+} GCBitsUartByte_t;
+
+/* First byte of commands sent by the console */
+typedef enum
+{
+	GC_JOYBUS_COMMAND_PROBE = 0x00,
+	GC_JOYBUS_COMMAND_POLL = 0x40,
+	GC_JOYBUS_COMMAND_PROBE_ORIGIN = 0x41,
+	GC_JOYBUS_COMMAND_CALIBRATE = 0x42,
+	GC_JOYBUS_COMMAND_RESET = 0xFF
+} GCJoybusCommand_t;
+
+// Public Variables //
+/* GC byte to four UART bytes, see Note 2 */
+extern const uint32_t gcJoybusEncodeTable[256];
+
+/* UART byte to GC bit pair, see Note 3 */
+extern const uint8_t gcJoybusDecodeTable[256];
+
+// Public Function Prototypes //
+/* Encodes GC bytes into a frame of UART bytes ready to be sent */
+static inline void GCJoybus_EncodeFrame(const uint8_t *gcBytes, uint32_t numOfGCBytes, uint32_t *frame)
+{
+	for(uint32_t i = 0; i < numOfGCBytes; i++)
+	{
+		frame[i] = gcJoybusEncodeTable[gcBytes[i]];
+	}
+}
+
+#endif /* GC_JOYBUS_H_ */
@@ -0,0 +1,112 @@
+#ifndef GC_MACRO_H_
+#define GC_MACRO_H_
+
+#include <stdint.h>
+#include "gc_stick.h"
+
+// Notes //
+/* NOTE 1:
+ * This module plays back input sequences with GC_USE_MACROS. A sequence
+ * is bytecode in flash, built at compile time with the macros below
+ * (see gc_macro_profile.h), and steps once per POLL answered instead of
+ * by time, so every step goes out in exactly one response.
+ *
+ * PRESS and RELEASE hold or let go of the inputs of a packed input word
+ * (see GC_BUTTON_MASK), STICK sets every stick and modifier input at
+ * once from a gcStickTable index, and WAIT sends what is held for the
+ * given number of polls. END lets go of everything and hands the
+ * controller back to the player. A sequence must end with END.
+ */
+
+/* NOTE 2:
+ * ~ Timing ~
+ * GCMacro_Poll runs right after a POLL is answered and executes the
+ * bytecode up to the next WAIT, so the response to the next POLL is
+ * built from what it leaves held. It never executes more than
+ * GC_MACRO_MAX_OPS_PER_POLL ops; a step without a WAIT that has more
+ * ops goes on at the next poll as if it had a WAIT of 1.
+ *
+ * GCMacro_Apply runs with every refresh and only reads the published
+ * output word, so its cost does not depend on the sequence. While a
+ * sequence plays it replaces the player's inputs.
+ */
+
+/* NOTE 3:
+ * ~ Starting a Sequence ~
+ * While MACRO is held, A, B, X and Y pick a sequence instead of being
+ * sent, and pressing one starts its sequence at the next POLL.
+ * Presses while a sequence plays are ignored.
+ *
+ * GCMacro_Apply and GCMacro_Poll may run in the main loop and in an
+ * interrupt. Each word is written by only one of them, so a press is
+ * handed over as a request count and the held inputs as one word.
+ */
+
+// Public Macros //
+/* Opcodes */
+#define GC_MACRO_OP_END			0x00
+#define GC_MACRO_OP_PRESS		0x01
+#define GC_MACRO_OP_RELEASE		0x02
+#define GC_MACRO_OP_STICK		0x03
+#define GC_MACRO_OP_WAIT		0x04
+
+/* Most ops executed for one POLL, see Note 2 */
+#define GC_MACRO_MAX_OPS_PER_POLL	8
+
+/* Sequences that can be picked, one per button of Note 3 */
+#define GC_MACRO_NUM_OF_SLOTS	4
+
+/* Packed input word as the three bytes of an operand, low byte first */
+#define GC_MACRO_WORD_BYTES(buttonWord) \
+	(uint8_t)(buttonWord), (uint8_t)((buttonWord) >> 8), (uint8_t)((buttonWord) >> 16)
+
+/* Bytecode of each op */
+#define GC_MACRO_END()				GC_MACRO_OP_END
+#define GC_MACRO_PRESS(buttonWord)		GC_MACRO_OP_PRESS, GC_MACRO_WORD_BYTES(buttonWord)
+#define GC_MACRO_RELEASE(buttonWord)	GC_MACRO_OP_RELEASE, GC_MACRO_WORD_BYTES(buttonWord)
+#define GC_MACRO_STICK(buttonWord) \
+	GC_MACRO_OP_STICK, (uint8_t)GC_STICK_INDEX(buttonWord), (uint8_t)(GC_STICK_INDEX(buttonWord) >> 8)
+#define GC_MACRO_WAIT(polls)		GC_MACRO_OP_WAIT, (uint8_t)(polls)
+
+// Public Structures //
+/* Playback state of one controller */
+typedef struct
+{
+	const uint8_t * const *sequences;
+
+	/* Written by GCMacro_Poll */
+	const uint8_t *sequence;		/* Sequence playing, NULL when none is */
+	uint32_t pc;
+	uint32_t waitPolls;				/* Polls left to send what is held */
+	uint32_t held;					/* Inputs held by the sequence */
+	volatile uint32_t output;		/* What is held, and GC_MACRO_PLAYING */
+	uint32_t numOfStarts;
+
+	/* Written by GCMacro_Apply */
+	volatile uint32_t requestedSlot;
+	volatile uint32_t numOfRequests;
+	uint32_t lastInputs;
+} GCMacro_t;
+
+// Public Variables //
+/* Sequences of gc_macro_profile.h, in the order of Note 3 */
+extern const uint8_t * const gcMacroSequences[GC_MACRO_NUM_OF_SLOTS];
+
+// Public Function Prototypes //
+/* Starts with nothing playing, picking from the given
+ * GC_MACRO_NUM_OF_SLOTS sequences
+ */
+void GCMacro_Init(GCMacro_t *, const uint8_t * const *);
+
+/* Takes processed inputs, starts a sequence if one is picked and
+ * returns the inputs to send
+ */
+uint32_t GCMacro_Apply(GCMacro_t *, uint32_t);
+
+/* Steps the sequence playing, called once per POLL answered */
+void GCMacro_Poll(GCMacro_t *);
+
+/* Returns 1 while a sequence plays */
+uint32_t GCMacro_IsPlaying(const GCMacro_t *);
+
+#endif /* GC_MACRO_H_ */
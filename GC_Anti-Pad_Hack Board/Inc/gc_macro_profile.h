@@ -0,0 +1,43 @@
+#ifndef GC_MACRO_PROFILE_H_
+#define GC_MACRO_PROFILE_H_
+
+// Notes //
+/* NOTE 1:
+ * These are the sequences gcMacroSequences in gc_macro.c is built from
+ * at compile time, one for each button picked with MACRO held (see
+ * gc_macro.h). Each is a list of the ops of gc_macro.h and must end
+ * with GC_MACRO_END(). A WAIT counts polls, which most games make once
+ * per frame.
+ *
+ * For example to hold A for 3 polls then let go for 1:
+ *
+ *   GC_MACRO_PRESS(GC_BUTTON_MASK(GC_A)), GC_MACRO_WAIT(3),
+ *   GC_MACRO_RELEASE(GC_BUTTON_MASK(GC_A)), GC_MACRO_WAIT(1),
+ *   GC_MACRO_END()
+ */
+
+// Sequences //
+/* MACRO + A and MACRO + B: nothing */
+#define GC_MACRO_PROFILE_A				\
+	GC_MACRO_END()
+
+#define GC_MACRO_PROFILE_B				\
+	GC_MACRO_END()
+
+/* MACRO + X: jump, then air dodge down and right after 3 polls */
+#define GC_MACRO_PROFILE_X														\
+	GC_MACRO_PRESS(GC_BUTTON_MASK(GC_X)), GC_MACRO_WAIT(1),						\
+	GC_MACRO_RELEASE(GC_BUTTON_MASK(GC_X)), GC_MACRO_WAIT(2),					\
+	GC_MACRO_STICK(GC_BUTTON_MASK(GC_MAIN_STICK_DOWN) | GC_BUTTON_MASK(GC_MAIN_STICK_RIGHT)),	\
+	GC_MACRO_PRESS(GC_BUTTON_MASK(GC_R)), GC_MACRO_WAIT(2),						\
+	GC_MACRO_END()
+
+/* MACRO + Y: the same to the left */
+#define GC_MACRO_PROFILE_Y														\
+	GC_MACRO_PRESS(GC_BUTTON_MASK(GC_X)), GC_MACRO_WAIT(1),						\
+	GC_MACRO_RELEASE(GC_BUTTON_MASK(GC_X)), GC_MACRO_WAIT(2),					\
+	GC_MACRO_STICK(GC_BUTTON_MASK(GC_MAIN_STICK_DOWN) | GC_BUTTON_MASK(GC_MAIN_STICK_LEFT)),	\
+	GC_MACRO_PRESS(GC_BUTTON_MASK(GC_R)), GC_MACRO_WAIT(2),						\
+	GC_MACRO_END()
+
+#endif /* GC_MACRO_PROFILE_H_ */
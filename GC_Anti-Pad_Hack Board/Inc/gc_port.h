@@ -0,0 +1,165 @@
+#ifndef GC_PORT_H_
+#define GC_PORT_H_
+
+#include <stdint.h>
+#include "shared_enums.h"
+
+// Notes //
+/* NOTE 1:
+ * This is everything gc_controller_emulation.c needs from the hardware.
+ * The controller emulation itself (commands, input processing and
+ * encoding) does not touch a register, so the same source can be built
+ * for the uC with gc_port_stm32f411.c or for a PC with the port in the
+ * Host folder.
+ */
+
+/* NOTE 2:
+ * Frames are in UART bytes as built by gc_joybus.h. Sending a frame
+ * always ends with the controller stop bit. The port is busy until that
+ * stop bit is done, and nothing must be received while busy since RX
+ * and TX share the GC data line.
+ *
+ * A port that sends from a form of its own, like the waveform of
+ * GC_USE_WAVEFORM_TX, builds it in GCPort_PrepareFrame. The emulation
+ * calls it whenever a frame it will send changed, so sending only has
+ * to start.
+ */
+
+/* NOTE 3:
+ * With GC_USE_DMA_RX, the port receives in the background and hands the
+ * UART bytes to GCControllerEmulation_ReceiveUartByte from its interrupt.
+ * Without it, the emulation asks for every UART byte itself.
+ */
+
+/* NOTE 4:
+ * Every function about the GC data line takes the console port it is
+ * for, from 0 to GC_NUM_OF_CONSOLE_PORTS - 1, and so do the callbacks
+ * the port makes with what it received. Without GC_USE_DMA_RX only
+ * port 0 is used.
+ */
+
+/* NOTE 5:
+ * With GC_USE_DMA_SAMPLING, the port samples the inputs on its own at a
+ * fixed rate and GCPort_ReadInputWindow combines the newest samples.
+ * GCPort_ReadInputs still reads the pins right away.
+ */
+
+/* NOTE 6:
+ * With GC_USE_RECORDING or GC_USE_REPLAY, the port keeps a flash region
+ * of GC_RECORDING_FLASH_BYTES for gc_recording.h. It reads like memory,
+ * and a word can only be programmed once after the region is erased.
+ * Both stall the CPU while the flash is busy.
+ */
+
+// Public Macros //
+/* Most samples GCPort_ReadInputWindow can combine */
+#define GC_MAX_SAMPLE_WINDOW	8
+
+/* Size of the recording region, flash sectors 6 and 7 on the uC */
+#define GC_RECORDING_FLASH_BYTES	(256UL * 1024UL)
+
+// Public Structures //
+/* Newest background samples of all inputs, packed like
+ * GCPort_ReadInputs
+ */
+typedef struct
+{
+	uint32_t allPushed;		/* Pushed in every sample */
+	uint32_t anyPushed;		/* Pushed in at least one sample */
+	uint32_t sampleTime;	/* Cycle of the newest sample */
+} GCInputWindow_t;
+
+// Public Function Prototypes //
+/* Sets up the GC data line and stop bit of every console port, and
+ * every button input
+ */
+void GCPort_Init(void);
+
+/* Gets all button inputs packed with one bit per GCButtonInput_t,
+ * set means PUSHED
+ */
+uint32_t GCPort_ReadInputs(void);
+
+/* Combines the given number of the newest background samples, with
+ * GC_USE_DMA_SAMPLING
+ */
+void GCPort_ReadInputWindow(uint32_t, GCInputWindow_t *);
+
+/* Background samples taken per second, 0 if inputs are only read when
+ * asked for
+ */
+uint32_t GCPort_GetInputSampleRate(void);
+
+/* Free running cycle counter, used to time stamp samples */
+uint32_t GCPort_GetCycles(void);
+
+/* Waits until the cycle counter reaches the given cycle, returns at
+ * once if it already has
+ */
+void GCPort_WaitForCycles(uint32_t);
+
+/* Starts listening to the console of a port */
+void GCPort_StartReceiving(uint32_t);
+
+/* Stops listening to the console of a port */
+void GCPort_StopReceiving(uint32_t);
+
+/* Returns 1 if a UART byte has been received on a port */
+uint32_t GCPort_IsByteReceived(uint32_t);
+
+/* Waits for and gets the next received UART byte of a port */
+uint8_t GCPort_ReceiveByte(uint32_t);
+
+/* Gets the given number of GC bytes of a frame ready to be sent on a
+ * port. The frame must not change again until it is prepared again.
+ */
+void GCPort_PrepareFrame(uint32_t, const uint32_t *, uint32_t);
+
+/* Sends a frame of UART bytes followed by a stop bit on a port */
+void GCPort_SendFrame(uint32_t, const uint32_t *, uint32_t);
+
+/* Returns 1 while a frame or its stop bit is still going out on a port */
+uint32_t GCPort_IsBusy(uint32_t);
+
+/* Keeps interrupts from capturing inputs until unlocked, returns what
+ * GCPort_UnlockInputs needs. Locks can be nested.
+ */
+uint32_t GCPort_LockInputs(void);
+
+/* Undoes GCPort_LockInputs */
+void GCPort_UnlockInputs(uint32_t);
+
+/* Starts sending bytes out of the expansion port with GC_USE_TELEMETRY.
+ * The bytes must stay untouched until the port is no longer busy.
+ */
+void GCPort_SendTelemetry(const uint8_t *, uint32_t);
+
+/* Returns 1 while the expansion port still needs the telemetry bytes */
+uint32_t GCPort_IsTelemetryBusy(void);
+
+/* Gets the start of the recording region */
+const uint8_t *GCPort_GetRecordingFlash(void);
+
+/* Erases the whole recording region, which takes seconds */
+void GCPort_EraseRecordingFlash(void);
+
+/* Programs an erased word of the recording region at the given offset */
+void GCPort_ProgramRecordingWord(uint32_t, uint32_t);
+
+// Emulation Callbacks //
+/* Called by the port with every UART byte received in the background
+ * on a console port. Returns 1 once the byte ended a command.
+ */
+uint32_t GCControllerEmulation_ReceiveUartByte(uint32_t, uint8_t);
+
+/* Called by the port when the UART of a console port reports receive
+ * errors, from GCPort_ReceiveByte without GC_USE_DMA_RX
+ */
+void GCControllerEmulation_ReceiveErrors(uint32_t, uint32_t, uint32_t, uint32_t);
+
+/* Called by the port with all inputs and the cycle they were read at
+ * when an input pin changes, with GC_USE_INPUT_EDGES
+ */
+void GCControllerEmulation_CaptureInputs(uint32_t, uint32_t);
+
+#endif /* GC_PORT_H_ */
@@ -0,0 +1,93 @@
+#ifndef GC_PROFILE_H_
+#define GC_PROFILE_H_
+
+#include <stdint.h>
+#include "gc_controller_emulation.h"
+#include "gc_port.h"
+
+// Notes //
+/* NOTE 1:
+ * This module times every phase of answering the console with the
+ * cycle counter of gc_port.h (DWT->CYCCNT on the uC). Each phase keeps
+ * its min, max, total and a histogram in RAM that can be read with a
+ * debugger or GCProfile_GetStats.
+ *
+ * It is only built with GC_USE_PROFILING. Without it GC_PROFILE_START
+ * and GC_PROFILE_END are empty and the module has no code or data.
+ */
+
+/* NOTE 2:
+ * Histogram bucket n counts the samples that took 2^(n-1) to 2^n - 1
+ * cycles, bucket 0 counts samples of 0 cycles. At 100 MHz bucket 7
+ * (64 to 127 cycles) is about one UART byte worth of CPU time and
+ * bucket 17 (65536 cycles and up) is over half a millisecond.
+ */
+
+/* NOTE 3:
+ * A phase may start and end in different functions, or even in the
+ * main loop and an interrupt, since only its start time is kept. A
+ * phase that ends without a start records whatever time it last
+ * started at, so only pair them where the order is certain.
+ */
+
+// Public Macros //
+/* Number of histogram buckets, one per bit of the cycle count plus 0 */
+#define GC_PROFILE_NUM_OF_BUCKETS	33
+
+#if GC_USE_PROFILING
+#define GC_PROFILE_START(phase)		GCProfile_Start(phase)
+#define GC_PROFILE_END(phase)		GCProfile_End(phase)
+#else
+#define GC_PROFILE_START(phase)
+#define GC_PROFILE_END(phase)
+#endif
+
+// Public Enums //
+typedef enum
+{
+	GC_PROFILE_COMMAND_RX = 0,		/* First UART byte of a command to its stop bit */
+	GC_PROFILE_DECODE,				/* Checking the command and finding its handler */
+	GC_PROFILE_SWITCH_SNAPSHOT,		/* GCControllerEmulation_GetSwitchSnapshot */
+	GC_PROFILE_DEBOUNCE,			/* Debouncing the snapshot, with GC_USE_DEBOUNCE */
+	GC_PROFILE_PROCESS_SNAPSHOT,	/* GCControllerEmulation_ProcessSwitchSnapshot */
+	GC_PROFILE_ENCODE,				/* GCControllerEmulation_EncodeControllerState */
+	GC_PROFILE_TURNAROUND,			/* Stop bit of a command to the first UART byte of the response */
+	GC_PROFILE_TX,					/* Sending the UART bytes of the response */
+	GC_PROFILE_STOP_BIT,			/* Sending the controller stop bit */
+	NUM_OF_GC_PROFILE_PHASES
+} GCProfilePhase_t;
+
+// Public Structures //
+/* Cycle statistics of a phase. The mean is totalCycles / numOfSamples. */
+typedef struct
+{
+	uint32_t lastCycles;
+	uint32_t minCycles;
+	uint32_t maxCycles;
+	uint64_t totalCycles;
+	uint32_t numOfSamples;
+	uint32_t histogram[GC_PROFILE_NUM_OF_BUCKETS];
+} GCProfileStats_t;
+
+// Public Function Prototypes //
+#if GC_USE_PROFILING
+/* Marks the start of a phase */
+void GCProfile_Start(GCProfilePhase_t);
+
+/* Marks the end of a phase and records its length */
+void GCProfile_End(GCProfilePhase_t);
+
+/* Records a phase length in cycles */
+void GCProfile_Record(GCProfilePhase_t, uint32_t);
+
+/* Gets the statistics of a phase */
+void GCProfile_GetStats(GCProfilePhase_t, GCProfileStats_t *);
+
+/* Gets the length of the last recorded run of a phase */
+uint32_t GCProfile_GetLastCycles(GCProfilePhase_t);
+
+/* Clears the statistics of every phase */
+void GCProfile_Reset(void);
+#endif
+
+#endif /* GC_PROFILE_H_ */
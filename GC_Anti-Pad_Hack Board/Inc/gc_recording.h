@@ -0,0 +1,119 @@
+#ifndef GC_RECORDING_H_
+#define GC_RECORDING_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module compresses the processed input word sent with every POLL
+ * (see GC_BUTTON_MASK) into a byte stream, and reads it back one poll
+ * at a time. Consecutive polls are mostly the same, and a change is
+ * mostly one button, so each record only says how a poll differs from
+ * the one before it:
+ *
+ * 0x00 to 0x7F: RUN, the last word again for 1 to 128 polls
+ * 0x80 to 0x9F: FLIP, the last word with bit (byte & 0x1F) toggled
+ * 0xC0, 3 bytes: XOR, the last word XORed with the 3 bytes
+ * 0xC1, 3 bytes: KEY, the 3 bytes are the word
+ * 0xFF:         END, erased flash
+ *
+ * The 3 bytes are low byte first. FLIP, XOR and KEY are one poll each.
+ * Every session starts with a KEY, so sessions can be appended.
+ */
+
+/* NOTE 2:
+ * A poll that changes nothing costs 1/128 of a byte, and a poll that
+ * presses or releases one button 1 byte plus the RUN before it. A
+ * session of 60 polls per second with 10 single button changes per
+ * second takes about 20 bytes per second.
+ *
+ * Records are queued in a RAM ring and taken out a word at a time to
+ * be programmed into flash, so only whole words are ever written. The
+ * ring has one producer (GCRecording_Record) and one consumer
+ * (GCRecording_TakeWord), so they may run in an interrupt and the main
+ * loop. A record that does not fit stops the recording, since the
+ * stream after a lost record would decode to the wrong inputs.
+ */
+
+/* NOTE 3:
+ * A recording region starts with GC_RECORDING_MAGIC and the records of
+ * every session follow one after the other. A session ends when the
+ * power does, so the last word programmed may end in the middle of an
+ * XOR or KEY. The next session then starts with 0x00 bytes that finish
+ * that record without changing the word, and its KEY sets the word
+ * again, see GCRecording_InitWriter.
+ */
+
+// Public Macros //
+/* First word of a recording region, "GCR1" */
+#define GC_RECORDING_MAGIC			0x31524347UL
+
+/* Bytes of the magic, the records start right after it */
+#define GC_RECORDING_HEADER_BYTES	4
+
+/* RAM queued before flash, must be a power of 2 */
+#define GC_RECORDING_RING_BYTES		1024
+
+/* Longest RUN of one record */
+#define GC_RECORDING_MAX_RUN		128
+
+// Public Structures //
+/* Encoding state of a recording */
+typedef struct
+{
+	uint8_t ring[GC_RECORDING_RING_BYTES];
+	volatile uint32_t head;			/* Written by GCRecording_Record */
+	volatile uint32_t tail;			/* Written by GCRecording_TakeWord */
+	uint32_t lastWord;
+	uint32_t runLength;				/* Polls of lastWord not written yet */
+	uint32_t hasKey;
+	uint32_t isStopped;
+	uint32_t numOfPolls;
+	uint32_t numOfRecordBytes;
+} GCRecordingWriter_t;
+
+/* Decoding state of a recording */
+typedef struct
+{
+	const uint8_t *data;
+	uint32_t size;
+	uint32_t offset;				/* Of the next record */
+	uint32_t word;
+	uint32_t runLeft;				/* Polls of word left in the current RUN */
+} GCRecordingReader_t;
+
+// Public Function Prototypes //
+/* Starts a session after records that end at the given offset, as
+ * found by GCRecording_SkipToEnd, 0 if there are none. The first poll
+ * is written as a KEY. Returns the offset the first word taken goes to,
+ * see Note 3.
+ */
+uint32_t GCRecording_InitWriter(GCRecordingWriter_t *, uint32_t);
+
+/* Adds the word of one poll. Returns 0 once the recording stopped. */
+uint32_t GCRecording_Record(GCRecordingWriter_t *, uint32_t);
+
+/* Gets the next whole word of record bytes, in the order they go into
+ * flash. Returns 0 if fewer than 4 bytes are queued.
+ */
+uint32_t GCRecording_TakeWord(GCRecordingWriter_t *, uint32_t *);
+
+/* Stops the recording, like a full ring would */
+void GCRecording_Stop(GCRecordingWriter_t *);
+
+/* Returns 1 if a recording region starts with GC_RECORDING_MAGIC */
+uint32_t GCRecording_HasMagic(const uint8_t *);
+
+/* Starts reading the records of the given bytes */
+void GCRecording_InitReader(GCRecordingReader_t *, const uint8_t *, uint32_t);
+
+/* Gets the word of the next poll. Returns 0 at the end of the records. */
+uint32_t GCRecording_Next(GCRecordingReader_t *, uint32_t *);
+
+/* Skips to the end of the records without expanding them, and returns
+ * the offset of the END. Records that stop at anything but erased flash
+ * end at the size given, so nothing is ever written after them.
+ */
+uint32_t GCRecording_SkipToEnd(GCRecordingReader_t *);
+
+#endif /* GC_RECORDING_H_ */
@@ -0,0 +1,75 @@
+#ifndef GC_SOCD_H_
+#define GC_SOCD_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module resolves SOCD (simultaneous opposite cardinal directions)
+ * on a packed input word, see GC_BUTTON_MASK. The two directions of an
+ * axis are neighbouring bits in GCButtonInput_t, so every axis of the
+ * d-pad, main stick and c stick is resolved at once with a handful of
+ * bitwise operations. There are no branches on the inputs, so resolving
+ * takes the same time whatever is pushed.
+ */
+
+/* NOTE 2:
+ * ~ Policies ~
+ * What an axis sends while both of its directions are held:
+ *
+ * NEUTRAL:        nothing.
+ * LAST_INPUT:     the direction pushed last. Letting go of it brings
+ *                 back the one still held.
+ * FIRST_INPUT:    the direction pushed first.
+ * UP_PRIORITY:    up on the y-axes, nothing on the x-axes.
+ * SECOND_INPUT:   the direction pushed last, like LAST_INPUT. Letting go
+ *                 of it does not bring back the one still held, that
+ *                 one stays off until it is let go and pushed again.
+ *
+ * Both directions pushed in the same snapshot count as no input for the
+ * history based policies, so the axis is neutral until one is let go.
+ */
+
+// Public Enums //
+typedef enum
+{
+	GC_SOCD_NEUTRAL = 0,
+	GC_SOCD_LAST_INPUT,
+	GC_SOCD_FIRST_INPUT,
+	GC_SOCD_UP_PRIORITY,
+	GC_SOCD_SECOND_INPUT,
+	NUM_OF_GC_SOCD_POLICIES
+} GCSocdPolicy_t;
+
+/* Axes that share a policy */
+typedef enum
+{
+	GC_SOCD_GROUP_DPAD = 0,
+	GC_SOCD_GROUP_MAIN_STICK,
+	GC_SOCD_GROUP_C_STICK,
+	NUM_OF_GC_SOCD_GROUPS
+} GCSocdGroup_t;
+
+// Public Structures //
+/* Policy selection and press history of one controller. Each mask in
+ * policyAxes holds both direction bits of every axis using that policy.
+ */
+typedef struct
+{
+	uint32_t policyAxes[NUM_OF_GC_SOCD_POLICIES];
+	uint32_t lastInputs;
+	uint32_t lastPushed;
+	uint32_t suppressed;
+} GCSocd_t;
+
+// Public Function Prototypes //
+/* Clears the history and sets the policy of every group */
+void GCSocd_Init(GCSocd_t *, GCSocdPolicy_t, GCSocdPolicy_t, GCSocdPolicy_t);
+
+/* Changes the policy of a group */
+void GCSocd_SetPolicy(GCSocd_t *, GCSocdGroup_t, GCSocdPolicy_t);
+
+/* Resolves every axis of a packed input word, call once per snapshot */
+uint32_t GCSocd_Resolve(GCSocd_t *, uint32_t);
+
+#endif /* GC_SOCD_H_ */
@@ -0,0 +1,41 @@
+#ifndef GC_STICK_H_
+#define GC_STICK_H_
+
+#include <stdint.h>
+#include "shared_enums.h"
+
+// Notes //
+/* NOTE 1:
+ * The main stick, c stick and modifier buttons are neighbouring bits of
+ * a packed input word, from GC_MAIN_STICK_UP to GC_TILT. Those ten bits
+ * index gcStickTable, which holds every analog byte of the response for
+ * that combination, so making the analog bytes is a single load.
+ *
+ * The table is built by the compiler from gc_stick_profile.h and lives
+ * in flash (1024 entries of 6 bytes).
+ */
+
+// Public Macros //
+/* Number of input bits used as the table index */
+#define GC_STICK_INDEX_BITS		10
+
+/* Table index of a packed input word */
+#define GC_STICK_INDEX(buttonWord) \
+	( ((buttonWord) >> GC_MAIN_STICK_UP) & ((1UL << GC_STICK_INDEX_BITS) - 1) )
+
+// Public Structures //
+/* Analog bytes in the order they are sent */
+typedef struct
+{
+	uint8_t mainStickX;
+	uint8_t mainStickY;
+	uint8_t cStickX;
+	uint8_t cStickY;
+	uint8_t lTrigger;
+	uint8_t rTrigger;
+} GCStickCoordinates_t;
+
+// Public Variables //
+extern const GCStickCoordinates_t gcStickTable[1UL << GC_STICK_INDEX_BITS];
+
+#endif /* GC_STICK_H_ */
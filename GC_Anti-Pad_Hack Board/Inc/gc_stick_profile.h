@@ -0,0 +1,53 @@
+#ifndef GC_STICK_PROFILE_H_
+#define GC_STICK_PROFILE_H_
+
+// Notes //
+/* NOTE 1:
+ * This is the description gcStickTable in gc_stick.c is built from at
+ * compile time. Each macro gives one analog byte sent to the console for
+ * a direction and the modifier buttons:
+ *
+ * dx:    -1 for left, 1 for right and 0 for neither
+ * dy:    -1 for down, 1 for up and 0 for neither
+ * tilt:  1 while the TILT button is pushed
+ * macro: 1 while the MACRO button is pushed
+ *
+ * Left wins over right and down over up if both are pushed, which SOCD
+ * cleaning normally prevents. Every macro can look at both dx and dy,
+ * so diagonals can have their own angle and magnitude. For example to
+ * send a 45 degree diagonal at 0.7 of the full main stick range:
+ *
+ *   ((dx) && (dy)) ? (GC_STICK_NEUTRAL + (dx) * 89) : ...
+ */
+
+// Stick Values //
+#define GC_STICK_MIN			0x00
+#define GC_STICK_TILT_LOW		0x4C
+#define GC_STICK_NEUTRAL		0x80
+#define GC_STICK_TILT_HIGH		0xB1
+#define GC_STICK_MAX			0xFF
+#define GC_TRIGGER_RELEASED		0x00
+
+// Main Stick //
+#define GC_STICK_PROFILE_MAIN_X(dx, dy, tilt, macro)						\
+	( ((dx) < 0) ? ((tilt) ? GC_STICK_TILT_LOW : GC_STICK_MIN) :			\
+	  ((dx) > 0) ? ((tilt) ? GC_STICK_TILT_HIGH : GC_STICK_MAX) :			\
+	  GC_STICK_NEUTRAL )
+
+#define GC_STICK_PROFILE_MAIN_Y(dx, dy, tilt, macro)						\
+	( ((dy) < 0) ? ((tilt) ? GC_STICK_TILT_LOW : GC_STICK_MIN) :			\
+	  ((dy) > 0) ? ((tilt) ? GC_STICK_MAX : GC_STICK_TILT_HIGH) :			\
+	  GC_STICK_NEUTRAL )
+
+// C Stick //
+#define GC_STICK_PROFILE_C_X(dx, dy, tilt, macro)							\
+	( ((dx) < 0) ? GC_STICK_MIN : ((dx) > 0) ? GC_STICK_MAX : GC_STICK_NEUTRAL )
+
+#define GC_STICK_PROFILE_C_Y(dx, dy, tilt, macro)							\
+	( ((dy) < 0) ? GC_STICK_MIN : ((dy) > 0) ? GC_STICK_TILT_HIGH : GC_STICK_NEUTRAL )
+
+// Triggers //
+#define GC_STICK_PROFILE_L_TRIGGER(tilt, macro)		GC_TRIGGER_RELEASED
+#define GC_STICK_PROFILE_R_TRIGGER(tilt, macro)		GC_TRIGGER_RELEASED
+
+#endif /* GC_STICK_PROFILE_H_ */
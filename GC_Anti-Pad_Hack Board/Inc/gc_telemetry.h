@@ -0,0 +1,121 @@
+#ifndef GC_TELEMETRY_H_
+#define GC_TELEMETRY_H_
+
+#include <stdint.h>
+#include "gc_controller_emulation.h"
+
+// Notes //
+/* NOTE 1:
+ * This module streams a binary record for every console command out of
+ * the expansion port (USART6 on COMMS_TX, see gc_port.h). Records are
+ * put in a ring buffer by GCTelemetry_Push and sent by DMA from
+ * GCTelemetry_Service, so the GC response path never waits on the
+ * expansion port. When the ring is full the record is dropped and
+ * counted instead.
+ *
+ * It is only built with GC_USE_TELEMETRY. Host/gc_telemetry_decode.c
+ * turns the stream back into text on a PC.
+ */
+
+/* NOTE 2:
+ * The ring has a single writer and a single reader. GCTelemetry_Push is
+ * called where commands are answered (the main loop, or the USART
+ * interrupts with GC_USE_DMA_RX, which share a priority so they never
+ * preempt each other) and GCTelemetry_Service from the main loop only.
+ * The writer only moves the head and the reader only moves the tail,
+ * so no lock is needed. Records being sent by DMA stay inside the ring
+ * until the DMA is done with them.
+ */
+
+/* NOTE 3:
+ * ~ Record Layout ~
+ * Every record is GC_TELEMETRY_RECORD_BYTES long, little endian, with
+ * the fields of GCTelemetryRecord_t in order and no padding. A record
+ * starts with GC_TELEMETRY_SYNC and ends with checksum, the 16 bit sum
+ * of every byte before it. The sequence counts every record including
+ * dropped ones, so a gap in it on the PC side means lost records.
+ *
+ * The command is the GCCommand_t of gc_controller_emulation.c: 0 PROBE,
+ * 1 PROBE ORIGIN, 2 POLL with rumble off, 3 POLL with rumble on, 4 for
+ * a command that got no response, 5 RESET, 6 CALIBRATE and 7 POLL with
+ * the rumble brake. The poll mode is the second of the command bytes.
+ *
+ * The top two bits of the flags are the console port the command came
+ * from. Error counters are the low 16 bits of the GCRxStats_t of that
+ * port. Phase times are in cycles and stop at 0xFFFF, they are 0
+ * without GC_USE_PROFILING.
+ */
+
+// Public Macros //
+/* First byte of every record */
+#define GC_TELEMETRY_SYNC				0xA5
+
+/* Size of a record on the wire */
+#define GC_TELEMETRY_RECORD_BYTES		40
+
+/* First GC bytes of the command kept in a record */
+#define GC_TELEMETRY_COMMAND_BYTES		3
+
+/* Records the ring can hold, must be a power of 2 */
+#define GC_TELEMETRY_RING_SIZE			32
+
+/* Counter or cycle count cut down to a 16 bit record field */
+#define GC_TELEMETRY_LOW_16(count)		((uint16_t)(count))
+#define GC_TELEMETRY_CLAMP_16(cycles)	( ((cycles) > 0xFFFF) ? (uint16_t)0xFFFF : (uint16_t)(cycles) )
+
+/* Record flags */
+#define GC_TELEMETRY_FLAG_RESPONDED		0x01	/* A response was sent */
+#define GC_TELEMETRY_FLAG_BAD_COMMAND	0x02	/* The command was not made of whole, valid GC bytes */
+#define GC_TELEMETRY_FLAG_RUMBLE		0x04	/* The console last asked for rumble on */
+
+/* Console port of the record, in the top two bits of the flags */
+#define GC_TELEMETRY_FLAG_PORT_SHIFT	6
+#define GC_TELEMETRY_FLAGS_PORT(consolePort)	((uint8_t)((consolePort) << GC_TELEMETRY_FLAG_PORT_SHIFT))
+#define GC_TELEMETRY_PORT(flags)		((uint32_t)(flags) >> GC_TELEMETRY_FLAG_PORT_SHIFT)
+
+// Public Structures //
+typedef struct
+{
+	uint8_t sync;
+	uint8_t sequence;
+	uint8_t command;			/* GCCommand_t of gc_controller_emulation.c that was answered */
+	uint8_t flags;
+	uint8_t gcBytes[GC_TELEMETRY_COMMAND_BYTES];
+	uint8_t numOfGCBytes;
+	uint32_t timestamp;			/* Cycles when the command was answered */
+	uint32_t inputs;			/* Processed buttons of the response, bit n is GCButtonInput_t n */
+	uint32_t inputAge;			/* Cycles between sampling and sending the inputs */
+	uint16_t framingErrors;
+	uint16_t overrunErrors;
+	uint16_t noiseErrors;
+	uint16_t numOfBadCommands;
+	uint16_t numOfDropped;		/* Records dropped so far */
+	uint16_t commandRxCycles;
+	uint16_t turnaroundCycles;
+	uint16_t txCycles;
+	uint16_t refreshCycles;		/* Snapshot, debounce, processing and encoding */
+	uint16_t checksum;
+} GCTelemetryRecord_t;
+
+/* Records sent and dropped so far */
+typedef struct
+{
+	uint32_t numOfRecords;
+	uint32_t numOfDropped;
+} GCTelemetryStats_t;
+
+// Public Function Prototypes //
+#if GC_USE_TELEMETRY
+/* Adds a record to the ring, or drops it if the ring is full.
+ * Sync, sequence, numOfDropped and checksum are filled in.
+ */
+void GCTelemetry_Push(GCTelemetryRecord_t *);
+
+/* Releases records the DMA is done with and starts sending the next ones */
+void GCTelemetry_Service(void);
+
+/* Gets the record counts */
+void GCTelemetry_GetStats(GCTelemetryStats_t *);
+#endif
+
+#endif /* GC_TELEMETRY_H_ */
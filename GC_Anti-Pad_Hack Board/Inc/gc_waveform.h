@@ -0,0 +1,55 @@
+#ifndef GC_WAVEFORM_H_
+#define GC_WAVEFORM_H_
+
+#include <stdint.h>
+
+// Notes //
+/* NOTE 1:
+ * This module renders a frame of UART bytes (see gc_joybus.h) as the
+ * level of the GC data line in every microsecond it takes to send. A
+ * slot is one word, either the low or the high word given to
+ * GCWaveform_Init, so on the uC the slots can be written one by one to
+ * a GPIO BSRR by DMA.
+ *
+ * A GC bit is 4 slots: a 1 is low for 1 slot then high, a 0 is low for
+ * 3 slots then high. The controller stop bit is low for 1 slot and then
+ * releases the line.
+ */
+
+/* NOTE 2:
+ * Every UART byte of a frame is a bit pair, so rendering only copies
+ * one of four 8 slot patterns per UART byte. The stop bit is separate
+ * so the same slots can be sent with a stop bit after fewer GC bytes.
+ */
+
+// Public Macros //
+/* Slots of each GC bit and of the stop bit */
+#define GC_WAVEFORM_SLOTS_PER_BIT		4
+#define GC_WAVEFORM_STOP_BIT_SLOTS		2
+
+/* Slots of a GC byte, and of a response with its stop bit */
+#define GC_WAVEFORM_SLOTS_PER_GC_BYTE	(8 * GC_WAVEFORM_SLOTS_PER_BIT)
+#define GC_WAVEFORM_SLOTS(numOfGCBytes)	(((numOfGCBytes) * GC_WAVEFORM_SLOTS_PER_GC_BYTE) + GC_WAVEFORM_STOP_BIT_SLOTS)
+
+// Public Structures //
+/* Slots of every GC bit pair, left bit first */
+typedef struct
+{
+	uint32_t bitPairs[4][2 * GC_WAVEFORM_SLOTS_PER_BIT];
+	uint32_t low;
+	uint32_t high;
+} GCWaveform_t;
+
+// Public Function Prototypes //
+/* Builds the patterns from the words that pull the line low and
+ * release it
+ */
+void GCWaveform_Init(GCWaveform_t *, uint32_t, uint32_t);
+
+/* Renders the given number of GC bytes of a frame, without a stop bit */
+void GCWaveform_Render(const GCWaveform_t *, const uint32_t *, uint32_t, uint32_t *);
+
+/* Writes the stop bit at the given slot */
+void GCWaveform_StopBit(const GCWaveform_t *, uint32_t *);
+
+#endif /* GC_WAVEFORM_H_ */
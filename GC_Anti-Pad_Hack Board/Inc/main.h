@@ -6,6 +6,7 @@
 #include "io_mapping_stm32f411ce_blackpill_weactstudio_v3_0.h"
 #include "shared_enums.h"
 #include "gc_controller_emulation.h"
+#include "gc_controller_reader.h"
 
 /* Public Functions */
 void Main_Init(void);
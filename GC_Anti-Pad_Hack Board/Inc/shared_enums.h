@@ -40,4 +40,7 @@ typedef enum
 	GC_TILT = 21
 } GCButtonInput_t;
 
+/* Number of inputs in GCButtonInput_t */
+#define NUM_OF_GC_BUTTON_INPUTS		22
+
 #endif
@@ -0,0 +1,103 @@
+#include "gc_cadence.h"
+
+// Macros //
+/* Fractional bits of the filtered values, which also sets the filter
+ * gain to 1/16
+ */
+#define GC_CADENCE_Q	4
+
+// Public Function Implementations //
+void GCCadence_Init(GCCadence_t *cadence, uint32_t minPeriod, uint32_t maxPeriod, uint32_t guardCycles)
+{
+	*cadence = (GCCadence_t){0};
+	cadence->minPeriod = minPeriod;
+	cadence->maxPeriod = maxPeriod;
+	cadence->guardCycles = guardCycles;
+}
+
+void GCCadence_Poll(GCCadence_t *cadence, uint32_t cycles)
+{
+	uint32_t interval = cycles - cadence->lastPoll;
+	uint32_t period = cadence->periodQ4 >> GC_CADENCE_Q;
+	int32_t error = (int32_t)(cycles - cadence->predictedPoll);
+	uint32_t absError = (error < 0) ? (uint32_t)-error : (uint32_t)error;
+
+	cadence->lastPoll = cycles;
+	cadence->isRefreshed = 0;
+	cadence->stats.numOfPolls++;
+
+	if(cadence->stats.isLocked && (absError <= (period >> 2)))
+	{
+		/* Phase follows the poll, period and jitter follow the error */
+		cadence->periodQ4 += error;
+		cadence->jitterQ4 += absError - (cadence->jitterQ4 >> GC_CADENCE_Q);
+		if(absError > cadence->stats.maxError)
+		{
+			cadence->stats.maxError = absError;
+		}
+	}
+	else
+	{
+		if(cadence->stats.isLocked)
+		{
+			cadence->stats.isLocked = 0;
+			cadence->stats.numOfUnlocks++;
+		}
+
+		/* Lock once two intervals in a row agree */
+		if( (interval >= cadence->minPeriod) && (interval <= cadence->maxPeriod) )
+		{
+			uint32_t difference = (interval > period) ? (interval - period) : (period - interval);
+			if(cadence->hasPeriod && (difference <= (period >> 3)))
+			{
+				cadence->stats.isLocked = 1;
+				cadence->stats.numOfLocks++;
+			}
+			cadence->periodQ4 = interval << GC_CADENCE_Q;
+			cadence->jitterQ4 = difference << GC_CADENCE_Q;
+			cadence->hasPeriod = 1;
+		}
+		else
+		{
+			cadence->hasPeriod = 0;
+		}
+	}
+
+	cadence->predictedPoll = cycles + (cadence->periodQ4 >> GC_CADENCE_Q);
+	cadence->stats.period = cadence->periodQ4 >> GC_CADENCE_Q;
+	cadence->stats.jitter = cadence->jitterQ4 >> GC_CADENCE_Q;
+}
+
+uint32_t GCCadence_GetRefreshTime(const GCCadence_t *cadence, uint32_t cycles, uint32_t refreshCycles, uint32_t *refreshTime)
+{
+	uint32_t margin = cadence->guardCycles + (cadence->stats.jitter * 2);
+
+	/* A poll that is later than the margin may not come at all */
+	if( !cadence->stats.isLocked || ((int32_t)(cycles - cadence->predictedPoll) > (int32_t)margin) )
+	{
+		return 0;
+	}
+
+	*refreshTime = cadence->predictedPoll - margin - refreshCycles;
+	return 1;
+}
+
+void GCCadence_SetRefreshed(GCCadence_t *cadence)
+{
+	cadence->isRefreshed = 1;
+}
+
+uint32_t GCCadence_IsRefreshed(const GCCadence_t *cadence)
+{
+	return cadence->isRefreshed;
+}
+
+uint32_t GCCadence_IsPolled(const GCCadence_t *cadence, uint32_t cycles)
+{
+	return (cadence->stats.numOfPolls != 0) && ((cycles - cadence->lastPoll) <= cadence->maxPeriod);
+}
+
+void GCCadence_GetStats(const GCCadence_t *cadence, GCCadenceStats_t *stats)
+{
+	*stats = cadence->stats;
+}
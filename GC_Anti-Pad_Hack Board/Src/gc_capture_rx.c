@@ -0,0 +1,65 @@
+#include "gc_capture_rx.h"
+#include "gc_joybus.h"
+
+// Macros //
+/* UART byte of a bit left over when the line went idle */
+#define GC_CAPTURE_RX_INVALID_BYTE	0x00
+
+// Public Function Implementations //
+void GCCaptureRx_Reset(GCCaptureRx_t *rx)
+{
+	*rx = (GCCaptureRx_t){0};
+}
+
+uint32_t GCCaptureRx_Edge(GCCaptureRx_t *rx, uint16_t time, uint8_t *uartByte)
+{
+	if(rx->isLow)
+	{
+		rx->riseTime = time;
+		rx->isLow = 0;
+		rx->hasBit = 1;
+		return 0;
+	}
+
+	/* A falling edge ends the bit before it, if there was one */
+	uint32_t isDecoded = 0;
+	if(rx->hasBit)
+	{
+		uint16_t lowTime = (uint16_t)(rx->riseTime - rx->fallTime);
+		uint16_t highTime = (uint16_t)(time - rx->riseTime);
+
+		rx->bitPair = (uint8_t)((rx->bitPair << 1) | ((lowTime < highTime) ? 1 : 0));
+		if(++rx->numOfBits == 2)
+		{
+			*uartByte = GC_JOYBUS_BITS_TO_UART(rx->bitPair);
+			rx->bitPair = 0;
+			rx->numOfBits = 0;
+			isDecoded = 1;
+		}
+	}
+
+	rx->fallTime = time;
+	rx->isLow = 1;
+	rx->hasBit = 0;
+
+	return isDecoded;
+}
+
+uint32_t GCCaptureRx_Idle(GCCaptureRx_t *rx, uint8_t *uartBytes)
+{
+	uint32_t numOfBytes = 0;
+
+	/* The bit waiting is the stop bit. A line held low is no command. */
+	if(rx->hasBit)
+	{
+		if(rx->numOfBits != 0)
+		{
+			uartBytes[numOfBytes++] = GC_CAPTURE_RX_INVALID_BYTE;
+		}
+		uartBytes[numOfBytes++] = GC_BITS_STOP_BIT;
+	}
+
+	GCCaptureRx_Reset(rx);
+
+	return numOfBytes;
+}
@@ -1,23 +1,76 @@
-#include "GC_controller_emulation.h"
+#include <stddef.h>
+#include "gc_controller_emulation.h"
+#include "gc_port.h"
+#include "gc_profile.h"
+#include "gc_telemetry.h"
+#include "gc_socd.h"
+#include "gc_debounce.h"
+#include "gc_cadence.h"
+#include "gc_stick.h"
+#include "gc_input_edges.h"
+#include "gc_macro.h"
+#include "gc_recording.h"
+
+_Static_assert((GC_SAMPLE_WINDOW >= 1) && (GC_SAMPLE_WINDOW <= GC_MAX_SAMPLE_WINDOW), "GC_SAMPLE_WINDOW must be from 1 to GC_MAX_SAMPLE_WINDOW");
+
+#if GC_USE_INPUT_EDGES && GC_USE_DMA_SAMPLING && (GC_SAMPLE_WINDOW > 1)
+/* The pin interrupts see every edge before the window would agree on it */
+#error "GC_SAMPLE_WINDOW must be 1 with GC_USE_INPUT_EDGES"
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS < 1
+#error "GC_NUM_OF_CONSOLE_PORTS must be at least 1"
+#endif
+
+#if (GC_NUM_OF_CONSOLE_PORTS > 1) && !(GC_USE_DMA_RX && GC_USE_DMA_TX)
+/* Waiting for a command on one port would leave the others unanswered */
+#error "GC_NUM_OF_CONSOLE_PORTS above 1 needs GC_USE_DMA_RX and GC_USE_DMA_TX"
+#endif
+
+#if GC_USE_RECORDING && GC_USE_REPLAY
+/* Both use the same flash region */
+#error "GC_USE_RECORDING and GC_USE_REPLAY cannot be used together"
+#endif
+
+#if GC_USE_RECORDING && (GC_NUM_OF_CONSOLE_PORTS > 1) && !GC_USE_POLL_CADENCE
+/* Only the cadence tells when no console polls during the flash stalls */
+#error "GC_USE_RECORDING with more than one console port needs GC_USE_POLL_CADENCE"
+#endif
 
 // Macros //
-#define NUM_OF_BUTTON_INPUTS	22
+/* Moves the state of one button to a bit of a GC byte */
+#define GC_BUTTON_TO_GC_BIT(buttonWord, gcButton, bitPosition) \
+	( (uint8_t)((((buttonWord) >> (gcButton)) & 1UL) << (bitPosition)) )
 
-// Enumerations //
-/* GC Bits to UART Bytes */
-typedef enum
-{
-	GC_BITS_00_CASE1 = 0x08,
-	GC_BITS_00_CASE2 = 0x88,
-	GC_BITS_01_CASE1 = 0xE8,
-	GC_BITS_01_CASE2 = 0xC8,
-	GC_BITS_10_CASE1 = 0x0F,
-	GC_BITS_10_CASE2 = 0x8F,
-	GC_BITS_11_CASE1 = 0xEF,
-	GC_BITS_11_CASE2 = 0xCF,
-	GC_BITS_STOP_BIT = 0xFF
-} GCBitsUartByte_t;
+/* Number of GC bytes in each response */
+#define GC_PROBE_RESPONSE_BYTES			3
+#define GC_POLL_RESPONSE_BYTES			8
+#define GC_PROBE_ORIGIN_RESPONSE_BYTES	10
+
+/* Poll modes the console can ask for with the second byte of a POLL.
+ * Mode 3 is the standard one, see Note 4 of gc_controller_emulation.h.
+ */
+#define GC_NUM_OF_POLL_MODES			8
+#define GC_POLL_MODE_STANDARD			3
+
+/* Third byte of a POLL */
+#define GC_RUMBLE_OFF					0x00
+#define GC_RUMBLE_ON					0x01
+#define GC_RUMBLE_BRAKE					0x02
 
+/* The A and B buttons are digital, so their analog values are released */
+#define GC_ANALOG_A						0x00
+#define GC_ANALOG_B						0x00
+
+/* Top 4 bits of two values in one GC byte, the first one high */
+#define GC_NIBBLES(high, low)			( (uint8_t)(((high) & 0xF0) | ((low) >> 4)) )
+
+/* Bit of the replayed inputs set while the recording lasts, above every
+ * input
+ */
+#define GC_REPLAY_PLAYING				(1UL << 31)
+
+// Enumerations //
 /* GC Commands */
 typedef enum
 {
@@ -25,431 +78,487 @@ typedef enum
 	GC_COMMAND_PROBE_ORIGIN = 1,
 	GC_COMMAND_POLL_AND_TURN_RUMBLE_OFF = 2,
 	GC_COMMAND_POLL_AND_TURN_RUMBLE_ON = 3,
-	GC_COMMAND_UNKNOWN = 4
+	GC_COMMAND_UNKNOWN = 4,
+	GC_COMMAND_RESET = 5,
+	GC_COMMAND_CALIBRATE = 6,
+	GC_COMMAND_POLL_AND_BRAKE_RUMBLE = 7
 } GCCommand_t;
 
+// Structures //
+/* Writes the third to eighth GC byte of a POLL response, in the layout
+ * of one poll mode, straight into a frame as UART bytes.
+ */
+typedef void (*GCPollPacker_t)(const GCStickCoordinates_t *, uint32_t *);
+
+/* Ready-to-send controller state, laid out by packer. The POLL response
+ * is the first GC_POLL_RESPONSE_BYTES of the frame. The standard
+ * packer adds the last two bytes of the PROBE ORIGIN response, so then
+ * it is the whole frame.
+ */
+typedef struct
+{
+	uint32_t frame[GC_PROBE_ORIGIN_RESPONSE_BYTES];
+	GCPollPacker_t packer;
+	uint32_t sampleTime;
+	uint32_t snapshot;
+	uint32_t inputs;
+} GCResponseCache_t;
+
+/* State of decoding the UART bytes of a console command */
+typedef struct
+{
+	uint32_t numOfGCBytes;
+	uint32_t numOfBitPairs;
+	uint32_t gcByte;
+	uint32_t decodeErrors;
+} GCCommandDecoder_t;
+
+/* Everything kept for one console port, see Note 6 of
+ * gc_controller_emulation.h
+ */
+typedef struct
+{
+	uint32_t index;								/* Console port number of gc_port.h */
+	GCCommandDecoder_t rxDecoder;				/* Decoding state kept between received UART bytes */
+	GCRxStats_t rxStats;
+	uint8_t consoleCommand[MAX_GC_CONSOLE_COMMAND_BYTES];	/* Command after its UART bytes are decoded to GC bytes */
+	GCCommand_t command;						/* Command after converted */
+
+	/* Double buffered responses to the POLL and PROBE ORIGIN commands.
+	 * One is rebuilt while the other is ready to be sent, and they are
+	 * swapped with a single pointer write so a poll never sees a half
+	 * written frame.
+	 */
+	GCResponseCache_t responseCache[2];
+	GCResponseCache_t * volatile readyResponse;
+
+	/* Layout of the poll mode the console last asked for, the ready
+	 * response is built with it
+	 */
+	volatile GCPollPacker_t pollPacker;
+
+	/* Response packed when it is needed, for a poll mode or a PROBE
+	 * ORIGIN the ready response is not laid out for
+	 */
+	uint32_t onDemandFrame[GC_PROBE_ORIGIN_RESPONSE_BYTES];
+
+	GCResponseCacheStats_t responseCacheStats;	/* How old the inputs of the sent responses were */
+#if GC_USE_POLL_CADENCE
+	GCCadence_t cadence;						/* Measured poll rate */
+	uint32_t refreshCycles;						/* Longest refresh of the ready response so far */
+#endif
+#if GC_USE_TELEMETRY
+	uint32_t rumble;							/* Last rumble state asked for by the console */
+	uint32_t sentInputs;						/* Inputs of the last controller state sent */
+#endif
+} GCConsolePort_t;
+
+/* Performs the request of a console command. The command bytes are in
+ * the consoleCommand of the port and the number of them is passed in.
+ */
+typedef void (*GCCommandHandler_t)(GCConsolePort_t *, uint32_t);
+
 // Variables //
-/* UART for faking 1-wire protocol */
-static UART_HandleTypeDef huart1;
+/* State of every console port */
+static GCConsolePort_t gcConsolePorts[GC_NUM_OF_CONSOLE_PORTS];
 
-/* Snapshot of button states */
-static ButtonState_t gcButtonInputSnapShot[NUM_OF_BUTTON_INPUTS] = {};
+/* Snapshot of button states (packed, see GC_BUTTON_MASK) */
+static uint32_t gcButtonInputSnapShot = 0;
 
-/* Processed snapshot button states */
-static ButtonState_t gcProcessedButtonStates[NUM_OF_BUTTON_INPUTS] = {};
+/* Snapshot as sampled, before it is debounced */
+static uint32_t gcSampledSnapShot = 0;
 
-/* Data from console before being converted into a command */
-static uint8_t gcConsoleResponse[MAX_GC_CONSOLE_BYTES];
+/* Cycle the snapshot was sampled at */
+static uint32_t gcSnapshotTime = 0;
 
-/* Command from console after converted */
-static GCCommand_t command;
+#if GC_USE_DMA_SAMPLING
+/* Button states the whole sample window agreed on */
+static uint32_t gcSampledInputs = 0;
+#endif
 
-// Function Prototypes //
-/* Gets a button state */
-ButtonState_t GCControllerEmulation_GetButtonState(GCButtonInput_t);
+/* Processed snapshot button states (packed, see GC_BUTTON_MASK) */
+static uint32_t gcProcessedButtonStates = 0;
+
+/* Response to the PROBE command, already in UART bytes */
+static const uint32_t gcProbeResponseFrame[GC_PROBE_RESPONSE_BYTES] =
+{
+	GC_JOYBUS_ENCODE(0x09),
+	GC_JOYBUS_ENCODE(0x00),
+	GC_JOYBUS_ENCODE(0x03)
+};
+
+/* SOCD policies and press history */
+static GCSocd_t gcSocd;
+
+#if GC_USE_DEBOUNCE
+/* Debounce counters of every input */
+static GCDebounce_t gcDebounce;
+#endif
+
+#if GC_USE_MACROS
+/* Sequence playing and the picks of the player */
+static GCMacro_t gcMacro;
+#endif
+
+#if GC_USE_RECORDING
+/* Session being recorded, and where its next word goes in flash */
+static GCRecordingWriter_t gcRecording;
+static uint32_t gcRecordingOffset = 0;
+
+/* Set by every poll of console port 0, words are only programmed then */
+static volatile uint32_t gcRecordingFlushDue = 0;
+#endif
+
+#if GC_USE_REPLAY
+/* Recording being replayed */
+static GCRecordingReader_t gcReplay;
+
+/* Inputs of the next poll, with GC_REPLAY_PLAYING while the recording
+ * lasts
+ */
+static volatile uint32_t gcReplayInputs = 0;
+#endif
 
-/* Waits for a command from the console. Not that this uses the UART
+// Function Prototypes //
+/* Waits for a command from the console of a port and decodes it into
+ * its consoleCommand. Returns the number of GC bytes received, or 0 if
+ * the command could not be decoded. Not that this uses the UART
  * module so if catching a falling edge in the middle of the
  * transmission, its garbage. But any functions that uses
  * the data from the console will know how to ignore it. So
  * calling it again next loop around self-corrects the issue.
  * That means getting in sync with the console is not necessary.
  */
-inline static uint8_t GCControllerEmulation_GetConsoleCommand(void);
+inline static uint32_t GCControllerEmulation_GetConsoleCommand(GCConsolePort_t *);
 
-/* Sends a stop bit to indicate end of GC data transmission */
-inline static void GCControllerEmulation_SendStopBit(void);
+/* Adds a received UART byte to a command. Returns 1 once the stop bit
+ * ends the command.
+ */
+inline static uint32_t GCControllerEmulation_DecodeCommandByte(GCConsolePort_t *, GCCommandDecoder_t *, uint8_t);
+
+/* Ends a decoded command and starts a new one. Returns the number of
+ * GC bytes in the consoleCommand of the port, or 0 if the command is
+ * not usable.
+ */
+inline static uint32_t GCControllerEmulation_FinishCommand(GCConsolePort_t *, GCCommandDecoder_t *);
+
+/* Performs the request of a decoded command */
+inline static void GCControllerEmulation_DispatchCommand(GCConsolePort_t *, uint32_t);
+
+/* Command handlers, called by the first byte of the command */
+static void GCControllerEmulation_HandleProbe(GCConsolePort_t *, uint32_t);
+static void GCControllerEmulation_HandleProbeOrigin(GCConsolePort_t *, uint32_t);
+static void GCControllerEmulation_HandlePoll(GCConsolePort_t *, uint32_t);
+static void GCControllerEmulation_HandleCalibrate(GCConsolePort_t *, uint32_t);
+static void GCControllerEmulation_HandleReset(GCConsolePort_t *, uint32_t);
 
 /* Sends correct response to poll command */
-inline static void GCControllerEmulation_SendProbeResponse(void);
+inline static void GCControllerEmulation_SendProbeResponse(GCConsolePort_t *);
+
+/* Sends current states of buttons and joystick to console, in the
+ * layout of the given packer and with the given number of GC bytes.
+ * Returns the packed inputs that were sent.
+ */
+inline static uint32_t GCControllerEmulation_SendControllerState(GCConsolePort_t *, GCPollPacker_t, uint32_t);
+
+/* Samples, debounces and processes the inputs shared by every port */
+inline static void GCControllerEmulation_UpdateInputs(void);
+
+/* Encodes the processed inputs into a new ready response of a port and
+ * swaps it in
+ */
+inline static void GCControllerEmulation_RefreshResponseCache(GCConsolePort_t *);
+
+/* Refreshes the ready response of a port, once per poll and just in
+ * time with GC_USE_POLL_CADENCE. The inputs are updated first unless
+ * the given flag says this pass already did, see Note 6 of
+ * gc_controller_emulation.h.
+ */
+inline static void GCControllerEmulation_RefreshIfDue(GCConsolePort_t *, uint32_t *);
+
+#if GC_USE_RECORDING
+/* Erases the recording region if asked to, and starts a session after
+ * the ones recorded
+ */
+static void GCControllerEmulation_StartRecording(void);
+
+/* Programs the words recorded since the last poll into flash, at most
+ * GC_RECORDING_WORDS_PER_POLL once per poll
+ */
+static void GCControllerEmulation_FlushRecording(void);
+
+#if GC_USE_DMA_RX
+/* Returns 1 if no console port is sending, and with more than one port
+ * if none of them is due to be polled or refreshed before the flash
+ * stalls of a flush end
+ */
+static uint32_t GCControllerEmulation_IsFlushClear(void);
+#endif
+#endif
 
-/* Sends current states of buttons and joystick to console */
-inline static void GCControllerEmulation_SendControllerState(GCCommand_t);
+#if GC_USE_REPLAY
+/* Moves the replay on to the inputs of the next poll */
+static void GCControllerEmulation_StepReplay(void);
+#endif
+
+/* Builds the UART bytes of the given processed inputs into a frame */
+inline static void GCControllerEmulation_EncodeControllerState(uint32_t, GCPollPacker_t, uint32_t *);
+
+/* Packers of every poll mode layout, see Note 4 of gc_controller_emulation.h */
+static void GCControllerEmulation_PackPollMode0(const GCStickCoordinates_t *, uint32_t *);
+static void GCControllerEmulation_PackPollMode1(const GCStickCoordinates_t *, uint32_t *);
+static void GCControllerEmulation_PackPollMode2(const GCStickCoordinates_t *, uint32_t *);
+static void GCControllerEmulation_PackPollMode3(const GCStickCoordinates_t *, uint32_t *);
+static void GCControllerEmulation_PackPollMode4(const GCStickCoordinates_t *, uint32_t *);
 
 /* Processes raw inputs to proper signals (example: socd cleaning) */
 inline static void GCControllerEmulation_ProcessSwitchSnapshot();
 
+#if GC_USE_TELEMETRY
+/* Streams what was done with the last command out of the expansion port */
+inline static void GCControllerEmulation_RecordTelemetry(GCConsolePort_t *, uint32_t);
+#endif
+
+// Constant Tables //
+/* Handler of every command byte. Commands without a handler are unknown
+ * and ignored, so adding a command costs no extra comparisons.
+ */
+static const GCCommandHandler_t gcCommandHandlers[256] =
+{
+	[GC_JOYBUS_COMMAND_PROBE] = GCControllerEmulation_HandleProbe,
+	[GC_JOYBUS_COMMAND_POLL] = GCControllerEmulation_HandlePoll,
+	[GC_JOYBUS_COMMAND_PROBE_ORIGIN] = GCControllerEmulation_HandleProbeOrigin,
+	[GC_JOYBUS_COMMAND_CALIBRATE] = GCControllerEmulation_HandleCalibrate,
+	[GC_JOYBUS_COMMAND_RESET] = GCControllerEmulation_HandleReset
+};
+
+/* Packer of every poll mode. Modes 5 to 7 are laid out as mode 0. */
+static const GCPollPacker_t gcPollPackers[GC_NUM_OF_POLL_MODES] =
+{
+	GCControllerEmulation_PackPollMode0,
+	GCControllerEmulation_PackPollMode1,
+	GCControllerEmulation_PackPollMode2,
+	GCControllerEmulation_PackPollMode3,
+	GCControllerEmulation_PackPollMode4,
+	GCControllerEmulation_PackPollMode0,
+	GCControllerEmulation_PackPollMode0,
+	GCControllerEmulation_PackPollMode0
+};
+
 // Function Implementations //
 /* Initializes this module to properly emulate a GC controller */
 void GCControllerEmulation_Init()
 {
-	/* Setup GC communication */
-	// Clocks
-	__HAL_RCC_GPIOB_CLK_ENABLE();
-	__HAL_RCC_USART1_CLK_ENABLE();
-
-	// Init structure
-	GPIO_InitTypeDef GPIO_InitStruct_GCControllerEmulation = {0};
-
-	// Stop bit control
-	GPIO_InitStruct_GCControllerEmulation.Pin = GC_STOP_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_OUTPUT_OD;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_NOPULL;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(GC_STOP_PORT, &GPIO_InitStruct_GCControllerEmulation);
-	GC_STOP_PORT->BSRR = GC_STOP_SET;
-
-	// USART1 TX/RX
-	GPIO_InitStruct_GCControllerEmulation.Pin = GC_TX_PIN_HAL | GC_RX_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_AF_OD;
-	GPIO_InitStruct_GCControllerEmulation.Alternate = GPIO_AF7_USART1;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_NOPULL;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(GC_TX_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// Configure USART1
-	huart1.Instance = USART1;
-	huart1.Init.BaudRate = 1100000; // 1100000 works
-	huart1.Init.WordLength = UART_WORDLENGTH_8B;
-	huart1.Init.StopBits = UART_STOPBITS_1;
-	huart1.Init.Parity = UART_PARITY_NONE;
-	huart1.Init.Mode = UART_MODE_TX_RX;
-	huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
-	huart1.Init.OverSampling = UART_OVERSAMPLING_8;
-	HAL_UART_Init(&huart1);
-
-	// Default command state from console
-	command = GC_COMMAND_UNKNOWN;
-
-	/* Setup buttons */
-	__HAL_RCC_GPIOA_CLK_ENABLE();
-	__HAL_RCC_GPIOB_CLK_ENABLE();
-	__HAL_RCC_GPIOC_CLK_ENABLE();
-
-	// A Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_A_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_A_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// B Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_B_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_B_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// X Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_X_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_X_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// Y Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_Y_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_Y_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// L Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_L_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_L_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// R Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_R_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_R_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// Z Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_Z_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_Z_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// START Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_START_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_START_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// DU Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_DU_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_DU_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// DD Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_DD_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_DD_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// DL Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_DL_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_DL_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// DR Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_DR_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_DR_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// LSU Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_LSU_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_LSU_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// LSD Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_LSD_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_LSD_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// LSL Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_LSL_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_LSL_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// LSR Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_LSR_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_LSR_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// CU Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_CU_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_CU_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// CD Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_CD_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_CD_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// CL Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_CL_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_CL_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// CR Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_CR_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_CR_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// MACRO Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_MACRO_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_MACRO_PORT, &GPIO_InitStruct_GCControllerEmulation);
-
-	// TILT Button
-	GPIO_InitStruct_GCControllerEmulation.Pin = BUTTON_TILT_PIN_HAL;
-	GPIO_InitStruct_GCControllerEmulation.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct_GCControllerEmulation.Pull = GPIO_PULLUP;
-	GPIO_InitStruct_GCControllerEmulation.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
-	HAL_GPIO_Init(BUTTON_TILT_PORT, &GPIO_InitStruct_GCControllerEmulation);
+	/* Setup GC communication and buttons */
+	GCPort_Init();
+
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		GCConsolePort_t *console = &gcConsolePorts[i];
+		GCPort_PrepareFrame(i, gcProbeResponseFrame, GC_PROBE_RESPONSE_BYTES);
+
+		// Default command state from console
+		*console = (GCConsolePort_t){0};
+		console->index = i;
+		console->command = GC_COMMAND_UNKNOWN;
+		console->readyResponse = &console->responseCache[0];
+		console->pollPacker = gcPollPackers[GC_POLL_MODE_STANDARD];
+
+#if GC_USE_POLL_CADENCE
+		GCCadence_Init(&console->cadence, GC_POLL_MIN_PERIOD_CYCLES, GC_POLL_MAX_PERIOD_CYCLES, GC_POLL_GUARD_CYCLES);
+#endif
+	}
+
+	// SOCD policies from the build options
+	GCSocd_Init(&gcSocd, GC_SOCD_DPAD_POLICY, GC_SOCD_MAIN_STICK_POLICY, GC_SOCD_C_STICK_POLICY);
+
+#if GC_USE_DEBOUNCE
+	// Debounce settings from the build options
+	GCDebounce_Init(&gcDebounce, GCPort_ReadInputs(), GCPort_GetCycles(), GC_DEBOUNCE_TICK_CYCLES);
+	GCDebounce_SetGroup(&gcDebounce, GC_DEBOUNCE_GROUP_BUTTONS, GC_DEBOUNCE_MODE, GC_DEBOUNCE_BUTTONS_MS);
+	GCDebounce_SetGroup(&gcDebounce, GC_DEBOUNCE_GROUP_DPAD, GC_DEBOUNCE_MODE, GC_DEBOUNCE_DPAD_MS);
+	GCDebounce_SetGroup(&gcDebounce, GC_DEBOUNCE_GROUP_MAIN_STICK, GC_DEBOUNCE_MODE, GC_DEBOUNCE_MAIN_STICK_MS);
+	GCDebounce_SetGroup(&gcDebounce, GC_DEBOUNCE_GROUP_C_STICK, GC_DEBOUNCE_MODE, GC_DEBOUNCE_C_STICK_MS);
+	GCDebounce_SetGroup(&gcDebounce, GC_DEBOUNCE_GROUP_MODIFIERS, GC_DEBOUNCE_MODE, GC_DEBOUNCE_MODIFIERS_MS);
+#endif
+
+#if GC_USE_INPUT_EDGES
+	// Buttons held at power up are not presses
+	GCInputEdges_Init(GCPort_ReadInputs());
+#endif
+
+#if GC_USE_MACROS
+	// Nothing plays until picked
+	GCMacro_Init(&gcMacro, gcMacroSequences);
+#endif
+
+#if GC_USE_RECORDING
+	// Erasing takes seconds, it is done before the console is answered
+	GCControllerEmulation_StartRecording();
+#endif
+
+#if GC_USE_REPLAY
+	/* The first ready response already holds the first recorded poll.
+	 * Flash without a recording replays nothing.
+	 */
+	const uint8_t *flash = GCPort_GetRecordingFlash();
+	GCRecording_InitReader(&gcReplay, flash + GC_RECORDING_HEADER_BYTES,
+						   GCRecording_HasMagic(flash) ? (GC_RECORDING_FLASH_BYTES - GC_RECORDING_HEADER_BYTES) : 0);
+	GCControllerEmulation_StepReplay();
+#endif
+
+	/* Have a response ready before the first poll */
+	GCControllerEmulation_UpdateInputs();
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		GCControllerEmulation_RefreshResponseCache(&gcConsolePorts[i]);
+	}
+
+#if GC_USE_DMA_RX
+	/* Start listening last so no command is answered before the
+	 * buttons are setup
+	 */
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		GCPort_StartReceiving(i);
+	}
+#endif
 }
 
 /* Emulate a GC controller forever. Note that this loop
  * is polling based. When the data is sent to the console,
  * we have about 11-12ms to do something else. That is
  * quite a bit of time for a fast uC. We use this time
- * to grab button states.
+ * to grab button states and keep a response ready to send,
+ * see GCControllerEmulation_GetConsoleCommand.
  */
 void GCControllerEmulation_Run()
 {
 	while(1)
 	{
-		/* Grab the GC console command */
-		command = GCControllerEmulation_GetConsoleCommand();
-
-
-		/* Performs command's request */
-		switch(command)
-		{
-			case GC_COMMAND_PROBE:
-				GCControllerEmulation_SendProbeResponse();
-				break;
-
-			case GC_COMMAND_PROBE_ORIGIN:
-				GCControllerEmulation_SendControllerState(GC_COMMAND_PROBE_ORIGIN);
-				break;
-
-			case GC_COMMAND_POLL_AND_TURN_RUMBLE_OFF:
-				GCControllerEmulation_SendControllerState(GC_COMMAND_POLL_AND_TURN_RUMBLE_OFF);
-				break;
-
-			case GC_COMMAND_POLL_AND_TURN_RUMBLE_ON:
-				GCControllerEmulation_SendControllerState(GC_COMMAND_POLL_AND_TURN_RUMBLE_ON);
-				break;
-
-			case GC_COMMAND_UNKNOWN:
-			default:
-				// Do nothing
-				break;
-		}
+		GCControllerEmulation_RunOnce();
 	}
 }
 
-/* Gets all inputs from GC Anti-Pad Hack Board */
-void GCControllerEmulation_GetSwitchSnapshot()
+/* One pass of the emulation loop */
+void GCControllerEmulation_RunOnce()
 {
-	/* Update all button input states */
-	gcButtonInputSnapShot[GC_A] = GCControllerEmulation_GetButtonState(GC_A);
-	gcButtonInputSnapShot[GC_B] = GCControllerEmulation_GetButtonState(GC_B);
-	gcButtonInputSnapShot[GC_X] = GCControllerEmulation_GetButtonState(GC_X);
-	gcButtonInputSnapShot[GC_Y] = GCControllerEmulation_GetButtonState(GC_Y);
-	gcButtonInputSnapShot[GC_L] = GCControllerEmulation_GetButtonState(GC_L);
-	gcButtonInputSnapShot[GC_R] = GCControllerEmulation_GetButtonState(GC_R);
-	gcButtonInputSnapShot[GC_Z] = GCControllerEmulation_GetButtonState(GC_Z);
-	gcButtonInputSnapShot[GC_START] = GCControllerEmulation_GetButtonState(GC_START);
-	gcButtonInputSnapShot[GC_DPAD_UP] = GCControllerEmulation_GetButtonState(GC_DPAD_UP);
-	gcButtonInputSnapShot[GC_DPAD_DOWN] = GCControllerEmulation_GetButtonState(GC_DPAD_DOWN);
-	gcButtonInputSnapShot[GC_DPAD_LEFT] = GCControllerEmulation_GetButtonState(GC_DPAD_LEFT);
-	gcButtonInputSnapShot[GC_DPAD_RIGHT] = GCControllerEmulation_GetButtonState(GC_DPAD_RIGHT);
-	gcButtonInputSnapShot[GC_MAIN_STICK_UP] = GCControllerEmulation_GetButtonState(GC_MAIN_STICK_UP);
-	gcButtonInputSnapShot[GC_MAIN_STICK_DOWN] = GCControllerEmulation_GetButtonState(GC_MAIN_STICK_DOWN);
-	gcButtonInputSnapShot[GC_MAIN_STICK_LEFT] = GCControllerEmulation_GetButtonState(GC_MAIN_STICK_LEFT);
-	gcButtonInputSnapShot[GC_MAIN_STICK_RIGHT] = GCControllerEmulation_GetButtonState(GC_MAIN_STICK_RIGHT);
-	gcButtonInputSnapShot[GC_C_STICK_UP] = GCControllerEmulation_GetButtonState(GC_C_STICK_UP);
-	gcButtonInputSnapShot[GC_C_STICK_DOWN] = GCControllerEmulation_GetButtonState(GC_C_STICK_DOWN);
-	gcButtonInputSnapShot[GC_C_STICK_LEFT] = GCControllerEmulation_GetButtonState(GC_C_STICK_LEFT);
-	gcButtonInputSnapShot[GC_C_STICK_RIGHT] = GCControllerEmulation_GetButtonState(GC_C_STICK_RIGHT);
-	gcButtonInputSnapShot[GC_MACRO] = GCControllerEmulation_GetButtonState(GC_MACRO);
-	gcButtonInputSnapShot[GC_TILT] = GCControllerEmulation_GetButtonState(GC_TILT);
+#if GC_USE_DMA_RX
+	/* Commands are received and answered from the USART interrupt of
+	 * each port, so the loop only has to keep the ready responses
+	 * current.
+	 */
+#if GC_USE_RECORDING
+	if(GCControllerEmulation_IsFlushClear())
+	{
+		GCControllerEmulation_FlushRecording();
+	}
+#endif
+	uint32_t isUpdated = 0;
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		GCControllerEmulation_RefreshIfDue(&gcConsolePorts[i], &isUpdated);
+	}
+#if GC_USE_TELEMETRY
+	GCTelemetry_Service();
+#endif
+#else
+	/* Grab the GC console command, only one port is served this way */
+	GCConsolePort_t *console = &gcConsolePorts[0];
+	uint32_t numOfGCBytes = GCControllerEmulation_GetConsoleCommand(console);
+
+	/* Performs command's request */
+	GCControllerEmulation_DispatchCommand(console, numOfGCBytes);
+#if GC_USE_TELEMETRY
+	GCControllerEmulation_RecordTelemetry(console, numOfGCBytes);
+#endif
+#endif
 }
 
-// Private Function Implementations //
-ButtonState_t GCControllerEmulation_GetButtonState(GCButtonInput_t gcButton)
+/* Gets all inputs from GC Anti-Pad Hack Board. Every button is
+ * sampled at the same instant.
+ */
+void GCControllerEmulation_GetSwitchSnapshot()
 {
-	ButtonState_t gcButtonState = RELEASED;
-
-	switch(gcButton)
-	{
-		case GC_A:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_A_PORT, BUTTON_A_PIN_HAL);
-			break;
-
-		case GC_B:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_B_PORT, BUTTON_B_PIN_HAL);
-			break;
-
-		case GC_X:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_X_PORT, BUTTON_X_PIN_HAL);
-			break;
-
-		case GC_Y:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_Y_PORT, BUTTON_Y_PIN_HAL);
-			break;
-
-		case GC_L:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_L_PORT, BUTTON_L_PIN_HAL);
-			break;
-
-		case GC_R:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_R_PORT, BUTTON_R_PIN_HAL);
-			break;
-
-		case GC_Z:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_Z_PORT, BUTTON_Z_PIN_HAL);
-			break;
-
-		case GC_START:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_START_PORT, BUTTON_START_PIN_HAL);
-			break;
-
-		case GC_DPAD_UP:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_DU_PORT, BUTTON_DU_PIN_HAL);
-			break;
-
-		case GC_DPAD_DOWN:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_DD_PORT, BUTTON_DD_PIN_HAL);
-			break;
-
-		case GC_DPAD_LEFT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_DL_PORT, BUTTON_DL_PIN_HAL);
-			break;
-
-		case GC_DPAD_RIGHT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_DR_PORT, BUTTON_DR_PIN_HAL);
-			break;
-
-		case GC_MAIN_STICK_UP:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_LSU_PORT, BUTTON_LSU_PIN_HAL);
-			break;
-
-		case GC_MAIN_STICK_DOWN:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_LSD_PORT, BUTTON_LSD_PIN_HAL);
-			break;
-
-		case GC_MAIN_STICK_LEFT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_LSL_PORT, BUTTON_LSL_PIN_HAL);
-			break;
-
-		case GC_MAIN_STICK_RIGHT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_LSR_PORT, BUTTON_LSR_PIN_HAL);
-			break;
-
-		case GC_C_STICK_UP:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_CU_PORT, BUTTON_CU_PIN_HAL);
-			break;
-
-		case GC_C_STICK_DOWN:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_CD_PORT, BUTTON_CD_PIN_HAL);
-			break;
-
-		case GC_C_STICK_LEFT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_CL_PORT, BUTTON_CL_PIN_HAL);
-			break;
+#if GC_USE_DMA_SAMPLING
+	/* The port already sampled the inputs. A button keeps its state
+	 * until every sample of the window says otherwise.
+	 */
+	GCInputWindow_t window;
+	GCPort_ReadInputWindow(GC_SAMPLE_WINDOW, &window);
+	gcSampledInputs = (gcSampledInputs & window.anyPushed) | window.allPushed;
+	gcSnapshotTime = window.sampleTime;
+	uint32_t inputs = gcSampledInputs;
+#else
+	gcSnapshotTime = GCPort_GetCycles();
+	uint32_t inputs = GCPort_ReadInputs();
+#endif
+
+#if GC_USE_INPUT_EDGES
+	/* Edges between two snapshots are timed by the pin interrupts, and
+	 * presses the console has not seen yet are added back in
+	 */
+	gcButtonInputSnapShot = GCInputEdges_Sample(inputs, gcSnapshotTime);
+#else
+	gcButtonInputSnapShot = inputs;
+#endif
+}
 
-		case GC_C_STICK_RIGHT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_CR_PORT, BUTTON_CR_PIN_HAL);
-			break;
+/* Gets receive errors and command counts of a console port */
+void GCControllerEmulation_GetRxStats(uint32_t consolePort, GCRxStats_t *stats)
+{
+	*stats = gcConsolePorts[consolePort].rxStats;
+}
 
-		case GC_MACRO:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_MACRO_PORT, BUTTON_MACRO_PIN_HAL);
-			break;
+/* Changes the SOCD policy of an axis group. Call from the main loop,
+ * the next refresh of the ready response uses it.
+ */
+void GCControllerEmulation_SetSocdPolicy(GCSocdGroup_t group, GCSocdPolicy_t policy)
+{
+	GCSocd_SetPolicy(&gcSocd, group, policy);
+}
 
-		case GC_TILT:
-			gcButtonState = (ButtonState_t)HAL_GPIO_ReadPin(BUTTON_TILT_PORT, BUTTON_TILT_PIN_HAL);
-			break;
+/* Changes the debounce of an input group. Call from the main loop,
+ * the next refresh of the ready response uses it.
+ */
+void GCControllerEmulation_SetDebounce(GCDebounceGroup_t group, GCDebounceMode_t mode, uint32_t ticks)
+{
+#if GC_USE_DEBOUNCE
+	GCDebounce_SetGroup(&gcDebounce, group, mode, ticks);
+#else
+	(void)group;
+	(void)mode;
+	(void)ticks;
+#endif
+}
 
-		default:
-			break;
-	}
+/* Gets statistics of the ready-to-send response cache of a console port */
+void GCControllerEmulation_GetResponseCacheStats(uint32_t consolePort, GCResponseCacheStats_t *stats)
+{
+	*stats = gcConsolePorts[consolePort].responseCacheStats;
+}
 
-	return gcButtonState;
+/* Gets the measured poll period and jitter of a console port */
+void GCControllerEmulation_GetCadenceStats(uint32_t consolePort, GCCadenceStats_t *stats)
+{
+#if GC_USE_POLL_CADENCE
+	GCCadence_GetStats(&gcConsolePorts[consolePort].cadence, stats);
+#else
+	(void)consolePort;
+	*stats = (GCCadenceStats_t){0};
+#endif
 }
 
-GCCommand_t GCControllerEmulation_GetConsoleCommand()
+// Private Function Implementations //
+uint32_t GCControllerEmulation_GetConsoleCommand(GCConsolePort_t *console)
 {
 	/* To receive or send bytes with the GC protocol, it must be understood
 	 * that 1 GC byte = 4 UART bytes.
 	 *
 	 * For receiving, note that the GC stop bit is interpreted as a UART byte.
-	 * Currently, we do nothing with it as this code only handles the polling
-	 * command from the GC console.
+	 * It marks the end of the command so any number of GC bytes can be
+	 * received. A stop bit that does not land right after a whole GC byte
+	 * means we started listening in the middle of a transmission.
 	 *
 	 * For sending, you need to send a stop bit. However, instead of sending
 	 * 0xFF from the UART we can tie another open drain output to the GC data
@@ -464,900 +573,518 @@ GCCommand_t GCControllerEmulation_GetConsoleCommand()
 	 * sending data on the TX line. Or else you receive your own data
 	 * possibly making hard to understand who sent what.
 	 */
-	/* Variable to hold return value */
-	GCCommand_t command;
-
-	/* Below is grabbing a response from the console */
-	// Enable the UART receiver
-	USART1->CR1 |= USART_CR1_RE;
-
-	/* First byte (possibly only byte) from console */
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 7 & BIT 6
-	gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 5 & BIT 4
-	gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 3 & BIT 2
-	gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 1 & BIT 0
-	gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Acquire the stop for later processing
-	gcConsoleResponse[GC_CONSOLE_TEMP_BITS] = USART1->DR;
-
-	// See if the last UART byte is a GC stop bit
-	if(gcConsoleResponse[GC_CONSOLE_TEMP_BITS] == GC_BITS_STOP_BIT)
-	{
-		// If it is, stop listening for commands and perform proper command conversion
-		if( ( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] == GC_BITS_00_CASE2) ) &&
-			( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] == GC_BITS_00_CASE2) ) &&
-			( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] == GC_BITS_00_CASE2) ) &&
-			( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] == GC_BITS_00_CASE2) )    )
-		{
-			// Interpreted command
-			command = GC_COMMAND_PROBE;
-		}
-		else if( ( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] == GC_BITS_01_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] == GC_BITS_01_CASE2) ) &&
-				 ( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] == GC_BITS_00_CASE2) ) &&
-				 ( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] == GC_BITS_00_CASE2) ) &&
-				 ( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] == GC_BITS_01_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] == GC_BITS_01_CASE2) )    )
-		{
-			// Interpreted command
-			command = GC_COMMAND_PROBE_ORIGIN;
-		}
-		else
-		{
-			// Unknown command
-			command = GC_COMMAND_UNKNOWN;
-		}
+	GCCommandDecoder_t *decoder = &console->rxDecoder;
 
-		// Disable the receiver
-		USART1->CR1 &= ~USART_CR1_RE;
+	// The line is ours until the stop bit of the last response is sent
+	while(GCPort_IsBusy(console->index)){};
 
-		// Return command
-		return command;
-	}
-	else
+#if GC_USE_RECORDING
+	// Flash stalls happen before listening, not during a command
+	GCControllerEmulation_FlushRecording();
+#endif
+
+	/* Below is grabbing a command from the console */
+	GCPort_StartReceiving(console->index);
+
+	// Keep the ready response current until the console starts talking
+	while(!GCPort_IsByteReceived(console->index))
 	{
-		// It was not a GC stop bit so keep reading the rest of the command bytes
+		uint32_t isUpdated = 0;
+		GCControllerEmulation_RefreshIfDue(console, &isUpdated);
+#if GC_USE_TELEMETRY
+		GCTelemetry_Service();
+#endif
 	}
 
-	/* Second byte from console */
-	// Remember that last UART byte isn't a stop bit so quickly re-map
-	gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT7_BIT6] = gcConsoleResponse[GC_CONSOLE_TEMP_BITS];
-
-    // Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 5 & BIT 4
-	gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT5_BIT4] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 3 & BIT 2
-	gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT3_BIT2] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 1 & BIT 0
-	gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT1_BIT0] = USART1->DR;
-
-	// There is no two byte GC command (afaik) so DO NOT interpret a stop bit next
-
-	/* Third byte from console */
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 7 & BIT 6
-	gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT7_BIT6] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 5 & BIT 4
-	gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT5_BIT4] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 3 & BIT 2
-	gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT3_BIT2] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Grab states for BIT 1 & BIT 0
-	gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT1_BIT0] = USART1->DR;
-
-	// Make sure the receive data register is not empty before receiving next byte
-	while(!(USART1->SR & USART_SR_RXNE)){};
-	// Acquire the stop bit and do nothing with it
-	gcConsoleResponse[GC_CONSOLE_TEMP_BITS] = USART1->DR;
-
-	/* This marks the end as three byte commands from GC console is as big as needed for this project.
-	 * Even though this code does not need to interpret all three bytes to perform the necessary action,
-	 * still do the comparison logic so that if future commands are necessary, it can be integrated
-	 * easily. But the lazy way out would be to only interpret the last byte to see if rumble needs to
-	 * occur. The really lazy way would be to just respond the button states and never investigate
-	 * any byte and rely on deduction.
-	 */
-	// Figure out first byte
-	if( ( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] == GC_BITS_01_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT7_BIT6] == GC_BITS_01_CASE2) ) &&
-		( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT5_BIT4] == GC_BITS_00_CASE2) ) &&
-		( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT3_BIT2] == GC_BITS_00_CASE2) ) &&
-		( (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_0_BIT1_BIT0] == GC_BITS_00_CASE2) )    )
+	GC_PROFILE_START(GC_PROFILE_COMMAND_RX);
+	while(1)
 	{
-		// So far we see 0x40, check possible next byte possibilities
-		if( ( (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT7_BIT6] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT7_BIT6] == GC_BITS_00_CASE2) ) &&
-		    ( (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT5_BIT4] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT5_BIT4] == GC_BITS_00_CASE2) ) &&
-		    ( (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT3_BIT2] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT3_BIT2] == GC_BITS_00_CASE2) ) &&
-		    ( (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT1_BIT0] == GC_BITS_11_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_1_BIT1_BIT0] == GC_BITS_11_CASE2) )    )
+		if(GCControllerEmulation_DecodeCommandByte(console, decoder, GCPort_ReceiveByte(console->index)))
 		{
-			// So far we see 0x40, 0x03, check possible next byte possibilities
-			if( ( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT7_BIT6] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT7_BIT6] == GC_BITS_00_CASE2) ) &&
-				( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT5_BIT4] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT5_BIT4] == GC_BITS_00_CASE2) ) &&
-				( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT3_BIT2] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT3_BIT2] == GC_BITS_00_CASE2) ) &&
-				( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT1_BIT0] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT1_BIT0] == GC_BITS_00_CASE2) )    )
-			{
-				// Interpreted command
-				command = GC_COMMAND_POLL_AND_TURN_RUMBLE_OFF;
-			}
-			else if( ( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT7_BIT6] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT7_BIT6] == GC_BITS_00_CASE2) ) &&
-					( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT5_BIT4] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT5_BIT4] == GC_BITS_00_CASE2) ) &&
-					( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT3_BIT2] == GC_BITS_00_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT3_BIT2] == GC_BITS_00_CASE2) ) &&
-					( (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT1_BIT0] == GC_BITS_01_CASE1) || (gcConsoleResponse[GC_CONSOLE_BYTE_2_BIT1_BIT0] == GC_BITS_01_CASE2) )    )
-			{
-				// Interpreted command
-				command = GC_COMMAND_POLL_AND_TURN_RUMBLE_ON;
-			}
-			else
-			{
-				// Unknown command - 0x40, 0x03, 0x??
-				command = GC_COMMAND_UNKNOWN;
-			}
+			break;
 		}
-		else
+#if GC_USE_OVERLAP_SAMPLING && !GC_USE_DMA_RX
+		/* A POLL is known from its first byte, and its response does not
+		 * depend on the rest. Refresh once, right after that byte. A
+		 * refresh longer than a UART byte overruns the receiver, which
+		 * drops the command, see GC_USE_OVERLAP_SAMPLING.
+		 */
+		if( (decoder->numOfGCBytes == 1) && (decoder->numOfBitPairs == 0) &&
+			(console->consoleCommand[0] == GC_JOYBUS_COMMAND_POLL) )
 		{
-			// Unknown command - 0x40, 0x??, 0x??
-			command = GC_COMMAND_UNKNOWN;
+			GCControllerEmulation_UpdateInputs();
+			GCControllerEmulation_RefreshResponseCache(console);
 		}
+#endif
 	}
-	else
-	{
-		// Unknown command
-		command = GC_COMMAND_UNKNOWN;
-	}
-
-	// Disable the receiver
-	USART1->CR1 &= ~USART_CR1_RE;
-
-	// Return command
-	return command;
-}
+	GC_PROFILE_END(GC_PROFILE_COMMAND_RX);
+	GC_PROFILE_START(GC_PROFILE_TURNAROUND);
 
-void GCControllerEmulation_SendStopBit()
-{
-	/* The timing of the stop bit does not need to be so precise. But
-	 * it has been optimized for this uC to be 1us. */
-	GC_STOP_PORT->BSRR = GC_STOP_CLEAR;
-	volatile uint32_t counter = 17;
-	while(counter--);
-	GC_STOP_PORT->BSRR = GC_STOP_SET;
-}
+	GCPort_StopReceiving(console->index);
 
-void GCControllerEmulation_SendProbeResponse()
-{
-	/* First byte to console - 0x09 */
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for A and B
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	//while(!(USART1->SR & USART_SR_TC)){};
-	// Send states for Z and START
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for DU and DD
-	USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for DL and DR
-	USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-
-	/* Second byte to console 0x00 */
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for RESET and RESERVED
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for L and R
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for CU and CD
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for CL and CR
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	/* Third byte to console - 0x03 */
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for X-AXIS BIT7 & BIT6
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for X-AXIS BIT5 & BIT4
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for X-AXIS BIT3 & BIT2
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for X-AXIS BIT1 & BIT0
-	USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-	/* Stop bit to console */
-	// Make sure the last UART byte transmission is complete before sending stop bit
-	while(!(USART1->SR & USART_SR_TC)){};
-	GCControllerEmulation_SendStopBit();
+	return GCControllerEmulation_FinishCommand(console, decoder);
 }
 
-void GCControllerEmulation_SendControllerState(GCCommand_t command)
+uint32_t GCControllerEmulation_DecodeCommandByte(GCConsolePort_t *console, GCCommandDecoder_t *decoder, uint8_t uartByte)
 {
-	/* For some reason, placing the bit states for inputs in a variable
-	 * causes the UART to delay a little. Most reliable way is to place
-	 * code directly into if...then statements for direct data transmission
-	 * via DR in UART.
-	 */
-	/* Get snapshot of all button and switch inputs */
-	GCControllerEmulation_GetSwitchSnapshot();
-
-	/* Process button snapshot and update data we will send to the console */
-	GCControllerEmulation_ProcessSwitchSnapshot();
+	// Convert the UART byte back to its GC bit pair
+	uint32_t bitPair = gcJoybusDecodeTable[uartByte];
 
-	// State holders (left means left most bit, right means right most bit)
-	ButtonState_t leftButtonState;
-	ButtonState_t rightButtonState;
-
-	/* First byte to console */
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for RESERVED and RESERVED
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Update RESERVED and START
-	rightButtonState = gcProcessedButtonStates[GC_START];
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for RESERVED and START
-	if(rightButtonState == RELEASED)
-	{
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else
+	// A stop bit ends the command
+	if(bitPair == GC_JOYBUS_STOP_BIT)
 	{
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
+		return 1;
 	}
 
-	// Update Y and X
-	leftButtonState = gcProcessedButtonStates[GC_Y];
-	rightButtonState = gcProcessedButtonStates[GC_X];
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for Y and X
-	if( (leftButtonState == RELEASED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == RELEASED) && (rightButtonState == PUSHED) )
-	{
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == PUSHED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-	}
-	else
-	{
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-	}
+	// Shift the bit pair in, an invalid UART byte is only remembered
+	decoder->decodeErrors |= bitPair;
+	decoder->gcByte = (decoder->gcByte << 2) | (bitPair & 0x03);
+	decoder->numOfBitPairs++;
 
-	// Update B and A
-	leftButtonState = gcProcessedButtonStates[GC_B];
-	rightButtonState = gcProcessedButtonStates[GC_A];
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for B and A
-	if( (leftButtonState == RELEASED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == RELEASED) && (rightButtonState == PUSHED) )
+	// Store every complete GC byte (extra bytes past the buffer are dropped)
+	if(decoder->numOfBitPairs == GC_UART_BYTES_PER_GC_BYTE)
 	{
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == PUSHED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-	}
-	else
-	{
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
+		uint32_t numOfGCBytes = decoder->numOfGCBytes;
+		console->consoleCommand[(numOfGCBytes < MAX_GC_CONSOLE_COMMAND_BYTES) ? numOfGCBytes : (MAX_GC_CONSOLE_COMMAND_BYTES - 1)] = (uint8_t)decoder->gcByte;
+		decoder->numOfGCBytes = numOfGCBytes + 1;
+		decoder->numOfBitPairs = 0;
+		decoder->gcByte = 0;
 	}
 
-	/* Second byte to console */
-	// Update RESERVED and L
-	rightButtonState = gcProcessedButtonStates[GC_L];
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for RESERVED and L
-	if(rightButtonState == RELEASED)
+	return 0;
+}
+
+uint32_t GCControllerEmulation_FinishCommand(GCConsolePort_t *console, GCCommandDecoder_t *decoder)
+{
+	GC_PROFILE_START(GC_PROFILE_DECODE);
+	uint32_t numOfGCBytes = decoder->numOfGCBytes;
+
+	/* Only hand over a command made of whole, valid GC bytes that fits */
+	if( (decoder->decodeErrors & GC_JOYBUS_INVALID_BITS) || (decoder->numOfBitPairs != 0) ||
+		(numOfGCBytes > MAX_GC_CONSOLE_COMMAND_BYTES) )
 	{
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
+		numOfGCBytes = 0;
+		console->rxStats.numOfBadCommands++;
 	}
 	else
 	{
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
+		console->rxStats.numOfCommands++;
 	}
 
-	// Update R and Z
-	leftButtonState = gcProcessedButtonStates[GC_R];
-	rightButtonState = gcProcessedButtonStates[GC_Z];
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for R and Z
-	if( (leftButtonState == RELEASED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == RELEASED) && (rightButtonState == PUSHED) )
-	{
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == PUSHED) && (rightButtonState == RELEASED) )
+	*decoder = (GCCommandDecoder_t){0};
+
+	return numOfGCBytes;
+}
+
+void GCControllerEmulation_DispatchCommand(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	console->command = GC_COMMAND_UNKNOWN;
+	GCCommandHandler_t commandHandler = gcCommandHandlers[console->consoleCommand[0]];
+	GC_PROFILE_END(GC_PROFILE_DECODE);
+	if( (numOfGCBytes != 0) && (commandHandler != NULL) )
 	{
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
+		commandHandler(console, numOfGCBytes);
 	}
-	else
+}
+
+#if GC_USE_DMA_RX
+uint32_t GCControllerEmulation_ReceiveUartByte(uint32_t consolePort, uint8_t uartByte)
+{
+	GCConsolePort_t *console = &gcConsolePorts[consolePort];
+	if(!GCControllerEmulation_DecodeCommandByte(console, &console->rxDecoder, uartByte))
 	{
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
+		return 0;
 	}
+	GC_PROFILE_START(GC_PROFILE_TURNAROUND);
+
+	/* Our response is on the same wire, stop listening until it is out */
+	GCPort_StopReceiving(consolePort);
+	uint32_t numOfGCBytes = GCControllerEmulation_FinishCommand(console, &console->rxDecoder);
+	GCControllerEmulation_DispatchCommand(console, numOfGCBytes);
+	GCPort_StartReceiving(consolePort);
+#if GC_USE_TELEMETRY
+	GCControllerEmulation_RecordTelemetry(console, numOfGCBytes);
+#endif
+
+	return 1;
+}
+#endif
+
+void GCControllerEmulation_ReceiveErrors(uint32_t consolePort, uint32_t framingErrors, uint32_t overrunErrors, uint32_t noiseErrors)
+{
+	GCConsolePort_t *console = &gcConsolePorts[consolePort];
+	console->rxStats.framingErrors += framingErrors;
+	console->rxStats.overrunErrors += overrunErrors;
+	console->rxStats.noiseErrors += noiseErrors;
 
-	// Update DU and DD
-	leftButtonState = gcProcessedButtonStates[GC_DPAD_UP];
-	rightButtonState = gcProcessedButtonStates[GC_DPAD_DOWN];;
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for DU and DD
-	if( (leftButtonState == RELEASED) && (rightButtonState == RELEASED) )
+	// A command with a bad or lost UART byte must not be performed
+	console->rxDecoder.decodeErrors |= GC_JOYBUS_INVALID_BITS;
+}
+
+#if GC_USE_INPUT_EDGES
+void GCControllerEmulation_CaptureInputs(uint32_t inputs, uint32_t cycles)
+{
+	GCInputEdges_Capture(inputs, cycles);
+}
+#endif
+
+void GCControllerEmulation_HandleProbe(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	/* 0x00, STOP */
+	if(numOfGCBytes == 1)
 	{
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
+		console->command = GC_COMMAND_PROBE;
+		GCControllerEmulation_SendProbeResponse(console);
 	}
-	else if( (leftButtonState == RELEASED) && (rightButtonState == PUSHED) )
+}
+
+void GCControllerEmulation_HandleProbeOrigin(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	/* 0x41, STOP */
+	if(numOfGCBytes == 1)
 	{
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
+		console->command = GC_COMMAND_PROBE_ORIGIN;
+		GCControllerEmulation_SendControllerState(console, gcPollPackers[GC_POLL_MODE_STANDARD], GC_PROBE_ORIGIN_RESPONSE_BYTES);
 	}
-	else if( (leftButtonState == PUSHED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
+}
+
+void GCControllerEmulation_HandlePoll(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	/* 0x40, (0x00 to 0x07), (0x00, 0x01 or 0x02), STOP */
+	uint32_t pollMode = console->consoleCommand[1];
+	uint32_t rumble = console->consoleCommand[2];
+	if( (numOfGCBytes == 3) && (pollMode < GC_NUM_OF_POLL_MODES) && (rumble <= GC_RUMBLE_BRAKE) )
+	{
+#if GC_USE_POLL_CADENCE
+		GCCadence_Poll(&console->cadence, GCPort_GetCycles());
+#endif
+
+		console->command = (rumble == GC_RUMBLE_ON) ? GC_COMMAND_POLL_AND_TURN_RUMBLE_ON :
+						   (rumble == GC_RUMBLE_BRAKE) ? GC_COMMAND_POLL_AND_BRAKE_RUMBLE : GC_COMMAND_POLL_AND_TURN_RUMBLE_OFF;
+
+		// The next ready responses are built for this poll mode
+		GCPollPacker_t packer = gcPollPackers[pollMode];
+		console->pollPacker = packer;
+		uint32_t sentInputs = GCControllerEmulation_SendControllerState(console, packer, GC_POLL_RESPONSE_BYTES);
+
+#if GC_USE_MACROS
+		/* Step the sequence while the response goes out, the next
+		 * refresh builds the response to the next poll from it
+		 */
+		if(console->index == 0)
+		{
+			GCMacro_Poll(&gcMacro);
+		}
+#endif
+
+#if GC_USE_RECORDING
+		/* The main loop programs the records once the response is out */
+		if( (console->index == 0) && GCRecording_Record(&gcRecording, sentInputs) )
+		{
+			gcRecordingFlushDue = 1;
+		}
+#else
+		(void)sentInputs;
+#endif
+
+#if GC_USE_REPLAY
+		if(console->index == 0)
+		{
+			GCControllerEmulation_StepReplay();
+		}
+#endif
 	}
 	else
 	{
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
+		// Unknown command - 0x40, 0x??, 0x??
 	}
+}
 
-	// Update DR and DL
-	leftButtonState = gcProcessedButtonStates[GC_DPAD_RIGHT];
-	rightButtonState = gcProcessedButtonStates[GC_DPAD_LEFT];
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for DR and DL
-	if( (leftButtonState == RELEASED) && (rightButtonState == RELEASED) )
-	{
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else if( (leftButtonState == RELEASED) && (rightButtonState == PUSHED) )
+void GCControllerEmulation_HandleCalibrate(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	/* 0x42, 0x00, 0x00, STOP. The sticks are digital so their origin
+	 * never moves and the answer is the PROBE ORIGIN response.
+	 */
+	if(numOfGCBytes == 3)
 	{
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
+		console->command = GC_COMMAND_CALIBRATE;
+		GCControllerEmulation_SendControllerState(console, gcPollPackers[GC_POLL_MODE_STANDARD], GC_PROBE_ORIGIN_RESPONSE_BYTES);
 	}
-	else if( (leftButtonState == PUSHED) && (rightButtonState == RELEASED) )
+}
+
+void GCControllerEmulation_HandleReset(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	/* 0xFF, STOP. Answered like PROBE, and the poll mode starts over. */
+	if(numOfGCBytes == 1)
 	{
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
+		console->command = GC_COMMAND_RESET;
+		console->pollPacker = gcPollPackers[GC_POLL_MODE_STANDARD];
+		GCControllerEmulation_SendProbeResponse(console);
 	}
-	else
+}
+
+void GCControllerEmulation_SendProbeResponse(GCConsolePort_t *console)
+{
+	/* Send 0x09, 0x00, 0x03 */
+	GCPort_SendFrame(console->index, gcProbeResponseFrame, GC_PROBE_RESPONSE_BYTES);
+}
+
+uint32_t GCControllerEmulation_SendControllerState(GCConsolePort_t *console, GCPollPacker_t packer, uint32_t numOfGCBytes)
+{
+	/* Inputs were already sampled, processed and encoded while waiting
+	 * for the console, so only the transmission needs to be started.
+	 */
+	GCResponseCache_t *response = console->readyResponse;
+	GCResponseCacheStats_t *stats = &console->responseCacheStats;
+
+	// Keep track of how old the sent inputs are
+	uint32_t sendTime = GCPort_GetCycles();
+	uint32_t inputAge = sendTime - response->sampleTime;
+	stats->lastInputAge = inputAge;
+	if(inputAge > stats->maxInputAge)
 	{
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
+		stats->maxInputAge = inputAge;
 	}
+	stats->numOfResponses++;
+
+#if GC_USE_INPUT_EDGES
+	// Presses in this response have been seen by the console
+	GCInputEdges_Delivered(console->index, response->snapshot, sendTime);
+#endif
 
-	/* Third byte to console */
-	if(gcProcessedButtonStates[GC_MAIN_STICK_LEFT] == PUSHED)
+	uint32_t inputs = response->inputs;
+#if GC_USE_REPLAY
+	/* A ready response built before the replay moved on to this poll
+	 * would send the last recorded poll again
+	 */
+	uint32_t replayInputs = gcReplayInputs;
+	if(replayInputs & GC_REPLAY_PLAYING)
 	{
-		if(gcProcessedButtonStates[GC_TILT] == PUSHED)
-		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-		}
-		else
-		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-		}
+		inputs = replayInputs & ~GC_REPLAY_PLAYING;
 	}
-	else if(gcProcessedButtonStates[GC_MAIN_STICK_RIGHT] == PUSHED)
+#endif
+
+	/* Only a response in another layout than the ready one is packed
+	 * now, which happens when the console changes the poll mode or asks
+	 * for the origin outside of the standard mode
+	 */
+	const uint32_t *frame = response->frame;
+	if( (response->packer != packer) || (response->inputs != inputs) )
 	{
-		if(gcProcessedButtonStates[GC_TILT] == PUSHED)
-		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-		}
-		else
-		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK X AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-		}
+		GCControllerEmulation_EncodeControllerState(inputs, packer, console->onDemandFrame);
+		GCPort_PrepareFrame(console->index, console->onDemandFrame, numOfGCBytes);
+		frame = console->onDemandFrame;
 	}
-	else
+
+	/* Send response followed by the stop bit */
+	GCPort_SendFrame(console->index, frame, numOfGCBytes);
+
+#if GC_USE_TELEMETRY
+	console->sentInputs = inputs;
+#endif
+	return inputs;
+}
+
+void GCControllerEmulation_RefreshIfDue(GCConsolePort_t *console, uint32_t *isUpdated)
+{
+	/* A port that is still sending cannot take a new response, so the
+	 * inputs are left for the next port
+	 */
+	if(GCPort_IsBusy(console->index))
 	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK X AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK X AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK X AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK X AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
+		return;
 	}
 
-	/* Fourth byte to console */
-	// Update main stick y-axis
-	if(gcProcessedButtonStates[GC_MAIN_STICK_DOWN] == PUSHED)
+#if GC_USE_POLL_CADENCE
+	/* While locked, the response sent is the one refreshed at the
+	 * refresh time of the cadence. The loop idles until the guard time
+	 * before it and waits out the rest, so the snapshot is as new as the
+	 * guard allows.
+	 */
+	GCCadence_t *cadence = &console->cadence;
+	uint32_t refreshTime;
+	if(GCCadence_GetRefreshTime(cadence, GCPort_GetCycles(), console->refreshCycles, &refreshTime))
 	{
-		if(gcProcessedButtonStates[GC_TILT] == PUSHED)
+		if(GCCadence_IsRefreshed(cadence))
 		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
+#if !GC_USE_DMA_RX
+			// Only the command is waited for from now on
+			return;
+#endif
+			/* The command is received in the background, so the guard
+			 * only kept the poll away from the snapshot to swap of the
+			 * last refresh. Newer ones can only help.
+			 */
 		}
-		else
-		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-		}
-	}
-	else if(gcProcessedButtonStates[GC_MAIN_STICK_UP] == PUSHED)
-	{
-		if(gcProcessedButtonStates[GC_TILT] == PUSHED)
+		else if((int32_t)(refreshTime - GCPort_GetCycles()) > (int32_t)GC_POLL_GUARD_CYCLES)
 		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
+			return;
 		}
 		else
 		{
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT7 AND BIT6
-			USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT5 AND BIT4
-			USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT2 AND BIT2
-			USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-			// Make sure the transmit data register is empty before sending next byte
-			while(!(USART1->SR & USART_SR_TXE)){};
-			// Send states for MAIN STICK Y AXIS BIT1 AND BIT0
-			USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
+			// The inputs of an earlier port are old by now
+			GCPort_WaitForCycles(refreshTime);
+			GCCadence_SetRefreshed(cadence);
+			*isUpdated = 0;
 		}
 	}
-	else
-	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK Y AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK Y AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK Y AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for MAIN STICK Y AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
 
-	/* Fifth byte to console */
-	// Update c stick x-axis
-	if(gcProcessedButtonStates[GC_C_STICK_LEFT] == PUSHED)
-	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else if(gcProcessedButtonStates[GC_C_STICK_RIGHT] == PUSHED)
+	uint32_t startTime = GCPort_GetCycles();
+	if(!*isUpdated)
 	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-	}
-	else
-	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK X AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
+		GCControllerEmulation_UpdateInputs();
+		*isUpdated = 1;
 	}
+	GCControllerEmulation_RefreshResponseCache(console);
 
-	/* Sixth byte to console */
-	// Update c stick y-axis
-	if(gcProcessedButtonStates[GC_C_STICK_DOWN] == PUSHED)
-	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-	}
-	else if(gcProcessedButtonStates[GC_C_STICK_UP] == PUSHED)
+	uint32_t refreshCycles = GCPort_GetCycles() - startTime;
+	if(refreshCycles > console->refreshCycles)
 	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_11_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_01_CASE1 & 0xFF);
+		console->refreshCycles = refreshCycles;
 	}
-	else
+#else
+	if(!*isUpdated)
 	{
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT7 AND BIT6
-		USART1->DR = (GC_BITS_10_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT5 AND BIT4
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT2 AND BIT2
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for C STICK Y AXIS BIT1 AND BIT0
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
+		GCControllerEmulation_UpdateInputs();
+		*isUpdated = 1;
 	}
+	GCControllerEmulation_RefreshResponseCache(console);
+#endif
+}
+
+void GCControllerEmulation_UpdateInputs()
+{
+	/* Get snapshot of all button and switch inputs */
+	GC_PROFILE_START(GC_PROFILE_SWITCH_SNAPSHOT);
+	GCControllerEmulation_GetSwitchSnapshot();
+	GC_PROFILE_END(GC_PROFILE_SWITCH_SNAPSHOT);
+	gcSampledSnapShot = gcButtonInputSnapShot;
+
+#if GC_USE_DEBOUNCE
+	/* Chatter is filtered out before the snapshot is processed */
+	GC_PROFILE_START(GC_PROFILE_DEBOUNCE);
+	gcButtonInputSnapShot = GCDebounce_Process(&gcDebounce, gcButtonInputSnapShot, gcSnapshotTime);
+	GC_PROFILE_END(GC_PROFILE_DEBOUNCE);
+#endif
+
+	/* Process button snapshot and update data we will send to the console */
+	GC_PROFILE_START(GC_PROFILE_PROCESS_SNAPSHOT);
+	GCControllerEmulation_ProcessSwitchSnapshot();
+	GC_PROFILE_END(GC_PROFILE_PROCESS_SNAPSHOT);
+}
 
-	/* Seventh byte to console */
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for L TRIGGER BIT7 AND BIT6
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for L TRIGGER BIT5 AND BIT4
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for L TRIGGER BIT3 AND BIT2
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for L TRIGGER BIT1 AND BIT0
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	/* Eighth byte to console */
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for R TRIGGER BIT7 AND BIT6
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for R TRIGGER BIT5 AND BIT4
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for R TRIGGER BIT3 AND BIT2
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Make sure the transmit data register is empty before sending next byte
-	while(!(USART1->SR & USART_SR_TXE)){};
-	// Send states for R TRIGGER BIT1 AND BIT0
-	USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-	// Optional bytes to send
-	if(command == GC_COMMAND_PROBE_ORIGIN)
+void GCControllerEmulation_RefreshResponseCache(GCConsolePort_t *console)
+{
+	/* The buffer that is not ready may still be going out */
+	if(GCPort_IsBusy(console->index))
 	{
-		/* Ninth byte to console */
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		/* Tenth byte to console */
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
-
-		// Make sure the transmit data register is empty before sending next byte
-		while(!(USART1->SR & USART_SR_TXE)){};
-		// Send states for ?
-		USART1->DR = (GC_BITS_00_CASE1 & 0xFF);
+		return;
 	}
 
-	/* Stop bit to console */
-	// Make sure the last UART byte transmission is complete before sending stop bit
-	while(!(USART1->SR & USART_SR_TC)){};
-	GCControllerEmulation_SendStopBit();
+	/* Build in the buffer that is not ready to be sent */
+	GCResponseCache_t *response = (console->readyResponse == &console->responseCache[0]) ? &console->responseCache[1] : &console->responseCache[0];
+	response->sampleTime = gcSnapshotTime;
+	response->snapshot = gcSampledSnapShot;
+	response->inputs = gcProcessedButtonStates;
+
+	/* The whole response is encoded before the first UART byte goes out.
+	 * Deciding bit states while sending delays the UART between bytes,
+	 * so the send loop must only copy bytes to DR.
+	 */
+	GC_PROFILE_START(GC_PROFILE_ENCODE);
+	GCPollPacker_t packer = console->pollPacker;
+	response->packer = packer;
+	GCControllerEmulation_EncodeControllerState(gcProcessedButtonStates, packer, response->frame);
+	GCPort_PrepareFrame(console->index, response->frame, (packer == gcPollPackers[GC_POLL_MODE_STANDARD]) ? GC_PROBE_ORIGIN_RESPONSE_BYTES : GC_POLL_RESPONSE_BYTES);
+	GC_PROFILE_END(GC_PROFILE_ENCODE);
+
+	/* Swap it in */
+	console->readyResponse = response;
+}
+
+void GCControllerEmulation_EncodeControllerState(uint32_t buttons, GCPollPacker_t packer, uint32_t *frame)
+{
+	/* First byte - 0, 0, 0, START, Y, X, B, A */
+	frame[0] = gcJoybusEncodeTable[GC_BUTTON_TO_GC_BIT(buttons, GC_START, 4) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_Y, 3) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_X, 2) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_B, 1) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_A, 0)];
+
+	/* Second byte - 1, L, R, Z, DU, DD, DR, DL */
+	frame[1] = gcJoybusEncodeTable[0x80 |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_L, 6) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_R, 5) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_Z, 4) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_DPAD_UP, 3) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_DPAD_DOWN, 2) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_DPAD_RIGHT, 1) |
+								   GC_BUTTON_TO_GC_BIT(buttons, GC_DPAD_LEFT, 0)];
+
+	/* Third to eighth byte - main stick, c stick, triggers and analog
+	 * A/B as the poll mode lays them out. Every stick and modifier
+	 * combination has its values in gcStickTable.
+	 */
+	packer(&gcStickTable[GC_STICK_INDEX(buttons)], frame);
+}
+
+void GCControllerEmulation_PackPollMode0(const GCStickCoordinates_t *stick, uint32_t *frame)
+{
+	/* Sticks, 4 bit triggers and 4 bit analog A/B */
+	frame[2] = gcJoybusEncodeTable[stick->mainStickX];
+	frame[3] = gcJoybusEncodeTable[stick->mainStickY];
+	frame[4] = gcJoybusEncodeTable[stick->cStickX];
+	frame[5] = gcJoybusEncodeTable[stick->cStickY];
+	frame[6] = gcJoybusEncodeTable[GC_NIBBLES(stick->lTrigger, stick->rTrigger)];
+	frame[7] = gcJoybusEncodeTable[GC_NIBBLES(GC_ANALOG_A, GC_ANALOG_B)];
+}
+
+void GCControllerEmulation_PackPollMode1(const GCStickCoordinates_t *stick, uint32_t *frame)
+{
+	/* Main stick, 4 bit c stick, triggers and 4 bit analog A/B */
+	frame[2] = gcJoybusEncodeTable[stick->mainStickX];
+	frame[3] = gcJoybusEncodeTable[stick->mainStickY];
+	frame[4] = gcJoybusEncodeTable[GC_NIBBLES(stick->cStickX, stick->cStickY)];
+	frame[5] = gcJoybusEncodeTable[stick->lTrigger];
+	frame[6] = gcJoybusEncodeTable[stick->rTrigger];
+	frame[7] = gcJoybusEncodeTable[GC_NIBBLES(GC_ANALOG_A, GC_ANALOG_B)];
+}
+
+void GCControllerEmulation_PackPollMode2(const GCStickCoordinates_t *stick, uint32_t *frame)
+{
+	/* Main stick, 4 bit c stick, 4 bit triggers and analog A/B */
+	frame[2] = gcJoybusEncodeTable[stick->mainStickX];
+	frame[3] = gcJoybusEncodeTable[stick->mainStickY];
+	frame[4] = gcJoybusEncodeTable[GC_NIBBLES(stick->cStickX, stick->cStickY)];
+	frame[5] = gcJoybusEncodeTable[GC_NIBBLES(stick->lTrigger, stick->rTrigger)];
+	frame[6] = gcJoybusEncodeTable[GC_ANALOG_A];
+	frame[7] = gcJoybusEncodeTable[GC_ANALOG_B];
+}
+
+void GCControllerEmulation_PackPollMode3(const GCStickCoordinates_t *stick, uint32_t *frame)
+{
+	/* Sticks and triggers, then the analog A/B that only PROBE ORIGIN
+	 * sends
+	 */
+	frame[2] = gcJoybusEncodeTable[stick->mainStickX];
+	frame[3] = gcJoybusEncodeTable[stick->mainStickY];
+	frame[4] = gcJoybusEncodeTable[stick->cStickX];
+	frame[5] = gcJoybusEncodeTable[stick->cStickY];
+	frame[6] = gcJoybusEncodeTable[stick->lTrigger];
+	frame[7] = gcJoybusEncodeTable[stick->rTrigger];
+	frame[8] = gcJoybusEncodeTable[GC_ANALOG_A];
+	frame[9] = gcJoybusEncodeTable[GC_ANALOG_B];
+}
+
+void GCControllerEmulation_PackPollMode4(const GCStickCoordinates_t *stick, uint32_t *frame)
+{
+	/* Sticks and analog A/B, no triggers */
+	frame[2] = gcJoybusEncodeTable[stick->mainStickX];
+	frame[3] = gcJoybusEncodeTable[stick->mainStickY];
+	frame[4] = gcJoybusEncodeTable[stick->cStickX];
+	frame[5] = gcJoybusEncodeTable[stick->cStickY];
+	frame[6] = gcJoybusEncodeTable[GC_ANALOG_A];
+	frame[7] = gcJoybusEncodeTable[GC_ANALOG_B];
 }
 
 void GCControllerEmulation_ProcessSwitchSnapshot()
@@ -1366,166 +1093,204 @@ void GCControllerEmulation_ProcessSwitchSnapshot()
 	 * immediately after sending the last update to the console. This part of the code
 	 * should be handled as fast as possible. For the GC, we must process this within
 	 * 650us because this is the minimum time before the console polls again. For example
-	 * I wrote very basic SOCD code to clean to neutral. I also copied over the
-	 * gcButtonInputSnapShot array (raw inputs) into the gcProcessedButtonStates array,
-	 * (processed raw inputs).
+	 * SOCD is cleaned here with the policies of gc_socd.h. Both
+	 * gcButtonInputSnapShot (raw inputs) and gcProcessedButtonStates (processed raw
+	 * inputs) are packed words with one bit per button, see GC_BUTTON_MASK.
 	 *
 	 * You need to decide what you want to do for the "digital action buttons" and the
 	 * "digital feature buttons". I know you want to program behavior of the "digital
 	 * feature buttons" like the tilt buttons, but I have no idea if you want to do
 	 * something with the "digital action buttons" like the A, B, X, etc buttons.
 	 */
-	/* Apply basic SOCD cleaning (clean to neutral) */
-	// Clean d-pad x-axis
-	if ( (gcButtonInputSnapShot[GC_DPAD_LEFT] == RELEASED) && (gcButtonInputSnapShot[GC_DPAD_RIGHT] == RELEASED) )
-	{
-		gcProcessedButtonStates[GC_DPAD_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_DPAD_RIGHT] = RELEASED;
-	}
-	else if ( (gcButtonInputSnapShot[GC_DPAD_LEFT] == RELEASED) && (gcButtonInputSnapShot[GC_DPAD_RIGHT] == PUSHED) )
-	{
-		gcProcessedButtonStates[GC_DPAD_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_DPAD_RIGHT] = PUSHED;
-	}
-	else if ( (gcButtonInputSnapShot[GC_DPAD_LEFT] == PUSHED) && (gcButtonInputSnapShot[GC_DPAD_RIGHT] == RELEASED) )
-	{
-		gcProcessedButtonStates[GC_DPAD_LEFT] = PUSHED;
-		gcProcessedButtonStates[GC_DPAD_RIGHT] = RELEASED;
-	}
-	else
-	{
-		gcProcessedButtonStates[GC_DPAD_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_DPAD_RIGHT] = RELEASED;
-	}
+	/* Apply SOCD cleaning with the policy of each axis group, see gc_socd.h */
+	uint32_t processedButtons = GCSocd_Resolve(&gcSocd, gcButtonInputSnapShot);
 
-	// Clean d-pad y-axis
-	if ( (gcButtonInputSnapShot[GC_DPAD_DOWN] == RELEASED) && (gcButtonInputSnapShot[GC_DPAD_UP] == RELEASED) )
-	{
-		gcProcessedButtonStates[GC_DPAD_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_DPAD_UP] = RELEASED;
-	}
-	else if ( (gcButtonInputSnapShot[GC_DPAD_DOWN] == RELEASED) && (gcButtonInputSnapShot[GC_DPAD_UP] == PUSHED) )
-	{
-		gcProcessedButtonStates[GC_DPAD_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_DPAD_UP] = PUSHED;
-	}
-	else if ( (gcButtonInputSnapShot[GC_DPAD_DOWN] == PUSHED) && (gcButtonInputSnapShot[GC_DPAD_UP] == RELEASED) )
-	{
-		gcProcessedButtonStates[GC_DPAD_DOWN] = PUSHED;
-		gcProcessedButtonStates[GC_DPAD_UP] = RELEASED;
-	}
-	else
-	{
-		gcProcessedButtonStates[GC_DPAD_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_DPAD_UP] = RELEASED;
-	}
+#if GC_USE_MACROS
+	/* A sequence that plays replaces the inputs, see gc_macro.h */
+	processedButtons = GCMacro_Apply(&gcMacro, processedButtons);
+#endif
 
-	// Clean main stick x-axis
-	if ( (gcButtonInputSnapShot[GC_MAIN_STICK_LEFT] == RELEASED) && (gcButtonInputSnapShot[GC_MAIN_STICK_RIGHT] == RELEASED) )
+#if GC_USE_REPLAY
+	/* So does the recording, until it ends */
+	uint32_t replayInputs = gcReplayInputs;
+	if(replayInputs & GC_REPLAY_PLAYING)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_MAIN_STICK_RIGHT] = RELEASED;
+		processedButtons = replayInputs & ~GC_REPLAY_PLAYING;
 	}
-	else if ( (gcButtonInputSnapShot[GC_MAIN_STICK_LEFT] == RELEASED) && (gcButtonInputSnapShot[GC_MAIN_STICK_RIGHT] == PUSHED) )
+#endif
+
+	/* Digital action buttons and digital feature buttons do not need
+	 * any sort of special processing for the meantime so they are
+	 * carried over as is with the rest of the word.
+	 */
+	gcProcessedButtonStates = processedButtons;
+}
+
+#if GC_USE_RECORDING
+void GCControllerEmulation_StartRecording()
+{
+	const uint8_t *flash = GCPort_GetRecordingFlash();
+
+	/* START held at power up, or flash that holds no recording, starts
+	 * the recording over
+	 */
+	if( !GCRecording_HasMagic(flash) || (GCPort_ReadInputs() & GC_BUTTON_MASK(GC_START)) )
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_MAIN_STICK_RIGHT] = PUSHED;
+		GCPort_EraseRecordingFlash();
+		GCPort_ProgramRecordingWord(0, GC_RECORDING_MAGIC);
 	}
-	else if ( (gcButtonInputSnapShot[GC_MAIN_STICK_LEFT] == PUSHED) && (gcButtonInputSnapShot[GC_MAIN_STICK_RIGHT] == RELEASED) )
+
+	/* This session goes after the last one, see Note 3 of gc_recording.h */
+	GCRecordingReader_t reader;
+	GCRecording_InitReader(&reader, flash + GC_RECORDING_HEADER_BYTES, GC_RECORDING_FLASH_BYTES - GC_RECORDING_HEADER_BYTES);
+	gcRecordingOffset = GC_RECORDING_HEADER_BYTES + GCRecording_InitWriter(&gcRecording, GCRecording_SkipToEnd(&reader));
+	gcRecordingFlushDue = 0;
+}
+
+void GCControllerEmulation_FlushRecording()
+{
+	if(!gcRecordingFlushDue)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_LEFT] = PUSHED;
-		gcProcessedButtonStates[GC_MAIN_STICK_RIGHT] = RELEASED;
+		return;
 	}
-	else
+	gcRecordingFlushDue = 0;
+
+	uint32_t word;
+	for(uint32_t i = 0; i < GC_RECORDING_WORDS_PER_POLL; i++)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_MAIN_STICK_RIGHT] = RELEASED;
+		if(gcRecordingOffset >= GC_RECORDING_FLASH_BYTES)
+		{
+			// Full, later polls are not recorded
+			GCRecording_Stop(&gcRecording);
+			return;
+		}
+		if(!GCRecording_TakeWord(&gcRecording, &word))
+		{
+			return;
+		}
+		GCPort_ProgramRecordingWord(gcRecordingOffset, word);
+		gcRecordingOffset += 4;
 	}
+}
 
-	// Clean main stick y-axis
-	if ( (gcButtonInputSnapShot[GC_MAIN_STICK_DOWN] == RELEASED) && (gcButtonInputSnapShot[GC_MAIN_STICK_UP] == RELEASED) )
+#if GC_USE_DMA_RX
+uint32_t GCControllerEmulation_IsFlushClear()
+{
+	/* Interrupts run from flash too, so a stall would hold back the
+	 * response of a port
+	 */
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_MAIN_STICK_UP] = RELEASED;
+		if(GCPort_IsBusy(i))
+		{
+			return 0;
+		}
 	}
-	else if ( (gcButtonInputSnapShot[GC_MAIN_STICK_DOWN] == RELEASED) && (gcButtonInputSnapShot[GC_MAIN_STICK_UP] == PUSHED) )
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	/* The flush follows a poll of port 0, but the other consoles poll
+	 * at their own times. Every port that is polled has to be locked,
+	 * with its refresh time after the flush.
+	 */
+	uint32_t cycles = GCPort_GetCycles();
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_MAIN_STICK_UP] = PUSHED;
+		GCConsolePort_t *console = &gcConsolePorts[i];
+		uint32_t flushCycles = GC_RECORDING_WORDS_PER_POLL * GC_RECORDING_WORD_CYCLES;
+		uint32_t startTime;
+		if(!GCCadence_IsPolled(&console->cadence, cycles))
+		{
+			continue;
+		}
+
+		// The latest a flush can start and still leave the refresh on time
+		if( !GCCadence_GetRefreshTime(&console->cadence, cycles, console->refreshCycles + flushCycles, &startTime) ||
+			((int32_t)(startTime - cycles) < 0) )
+		{
+			return 0;
+		}
 	}
-	else if ( (gcButtonInputSnapShot[GC_MAIN_STICK_DOWN] == PUSHED) && (gcButtonInputSnapShot[GC_MAIN_STICK_UP] == RELEASED) )
+#endif
+
+	return 1;
+}
+#endif
+#endif
+
+#if GC_USE_REPLAY
+void GCControllerEmulation_StepReplay()
+{
+	uint32_t word;
+	gcReplayInputs = GCRecording_Next(&gcReplay, &word) ? (word | GC_REPLAY_PLAYING) : 0;
+}
+#endif
+
+#if GC_USE_TELEMETRY
+void GCControllerEmulation_RecordTelemetry(GCConsolePort_t *console, uint32_t numOfGCBytes)
+{
+	GCTelemetryRecord_t record = {0};
+	GCCommand_t command = console->command;
+
+	record.timestamp = GCPort_GetCycles();
+	record.command = (uint8_t)command;
+	record.flags = GC_TELEMETRY_FLAGS_PORT(console->index);
+
+	/* What the console sent, a bad command has no GC bytes */
+	record.numOfGCBytes = (uint8_t)numOfGCBytes;
+	for(uint32_t i = 0; (i < numOfGCBytes) && (i < GC_TELEMETRY_COMMAND_BYTES); i++)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_DOWN] = PUSHED;
-		gcProcessedButtonStates[GC_MAIN_STICK_UP] = RELEASED;
+		record.gcBytes[i] = console->consoleCommand[i];
 	}
-	else
+	if(numOfGCBytes == 0)
 	{
-		gcProcessedButtonStates[GC_MAIN_STICK_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_MAIN_STICK_UP] = RELEASED;
+		record.flags |= GC_TELEMETRY_FLAG_BAD_COMMAND;
 	}
 
-	// Clean c stick x-axis
-	if ( (gcButtonInputSnapShot[GC_C_STICK_LEFT] == RELEASED) && (gcButtonInputSnapShot[GC_C_STICK_RIGHT] == RELEASED) )
+	/* Rumble is only changed by a POLL, and stopped by a RESET */
+	if(command == GC_COMMAND_POLL_AND_TURN_RUMBLE_ON)
 	{
-		gcProcessedButtonStates[GC_C_STICK_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_C_STICK_RIGHT] = RELEASED;
+		console->rumble = 1;
 	}
-	else if ( (gcButtonInputSnapShot[GC_C_STICK_LEFT] == RELEASED) && (gcButtonInputSnapShot[GC_C_STICK_RIGHT] == PUSHED) )
+	else if( (command == GC_COMMAND_POLL_AND_TURN_RUMBLE_OFF) || (command == GC_COMMAND_POLL_AND_BRAKE_RUMBLE) ||
+			 (command == GC_COMMAND_RESET) )
 	{
-		gcProcessedButtonStates[GC_C_STICK_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_C_STICK_RIGHT] = PUSHED;
+		console->rumble = 0;
 	}
-	else if ( (gcButtonInputSnapShot[GC_C_STICK_LEFT] == PUSHED) && (gcButtonInputSnapShot[GC_C_STICK_RIGHT] == RELEASED) )
+	if(console->rumble)
 	{
-		gcProcessedButtonStates[GC_C_STICK_LEFT] = PUSHED;
-		gcProcessedButtonStates[GC_C_STICK_RIGHT] = RELEASED;
-	}
-	else
-	{
-		gcProcessedButtonStates[GC_C_STICK_LEFT] = RELEASED;
-		gcProcessedButtonStates[GC_C_STICK_RIGHT] = RELEASED;
+		record.flags |= GC_TELEMETRY_FLAG_RUMBLE;
 	}
 
-	// Clean c stick y-axis
-	if ( (gcButtonInputSnapShot[GC_C_STICK_DOWN] == RELEASED) && (gcButtonInputSnapShot[GC_C_STICK_UP] == RELEASED) )
-	{
-		gcProcessedButtonStates[GC_C_STICK_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_C_STICK_UP] = RELEASED;
-	}
-	else if ( (gcButtonInputSnapShot[GC_C_STICK_DOWN] == RELEASED) && (gcButtonInputSnapShot[GC_C_STICK_UP] == PUSHED) )
+	/* Inputs of the response that went out */
+	if(command != GC_COMMAND_UNKNOWN)
 	{
-		gcProcessedButtonStates[GC_C_STICK_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_C_STICK_UP] = PUSHED;
+		record.flags |= GC_TELEMETRY_FLAG_RESPONDED;
 	}
-	else if ( (gcButtonInputSnapShot[GC_C_STICK_DOWN] == PUSHED) && (gcButtonInputSnapShot[GC_C_STICK_UP] == RELEASED) )
+	if( (command != GC_COMMAND_UNKNOWN) && (command != GC_COMMAND_PROBE) && (command != GC_COMMAND_RESET) )
 	{
-		gcProcessedButtonStates[GC_C_STICK_DOWN] = PUSHED;
-		gcProcessedButtonStates[GC_C_STICK_UP] = RELEASED;
+		record.inputs = console->sentInputs;
+		record.inputAge = console->responseCacheStats.lastInputAge;
 	}
-	else
-	{
-		gcProcessedButtonStates[GC_C_STICK_DOWN] = RELEASED;
-		gcProcessedButtonStates[GC_C_STICK_UP] = RELEASED;
-	}
-	/* End of SOCD cleaning */
 
-	/* Process digital action buttons. For the meantime, they do not need
-	 * any sort of special processing so just copy them over.
-	 */
-	gcProcessedButtonStates[GC_A] = gcButtonInputSnapShot[GC_A];
-	gcProcessedButtonStates[GC_B] = gcButtonInputSnapShot[GC_B];
-	gcProcessedButtonStates[GC_X] = gcButtonInputSnapShot[GC_X];
-	gcProcessedButtonStates[GC_Y] = gcButtonInputSnapShot[GC_Y];
-	gcProcessedButtonStates[GC_L] = gcButtonInputSnapShot[GC_L];
-	gcProcessedButtonStates[GC_R] = gcButtonInputSnapShot[GC_R];
-	gcProcessedButtonStates[GC_Z] = gcButtonInputSnapShot[GC_Z];
-	gcProcessedButtonStates[GC_START] = gcButtonInputSnapShot[GC_START];
-	/* End processing of digital action buttons */
-
-	/* Process digital feature buttons. For the meantime, they do not need
-	 * any sort of special processing so just copy them over.
-	 */
-	gcProcessedButtonStates[GC_MACRO] = gcButtonInputSnapShot[GC_MACRO];
-	gcProcessedButtonStates[GC_TILT] = gcButtonInputSnapShot[GC_TILT];
-	/* End processing of digital action buttons */
+	record.framingErrors = GC_TELEMETRY_LOW_16(console->rxStats.framingErrors);
+	record.overrunErrors = GC_TELEMETRY_LOW_16(console->rxStats.overrunErrors);
+	record.noiseErrors = GC_TELEMETRY_LOW_16(console->rxStats.noiseErrors);
+	record.numOfBadCommands = GC_TELEMETRY_LOW_16(console->rxStats.numOfBadCommands);
+
+#if GC_USE_PROFILING
+	/* Last time of each phase, a phase still going on shows its last run */
+	record.commandRxCycles = GC_TELEMETRY_CLAMP_16(GCProfile_GetLastCycles(GC_PROFILE_COMMAND_RX));
+	record.turnaroundCycles = GC_TELEMETRY_CLAMP_16(GCProfile_GetLastCycles(GC_PROFILE_TURNAROUND));
+	record.txCycles = GC_TELEMETRY_CLAMP_16(GCProfile_GetLastCycles(GC_PROFILE_TX));
+	uint32_t refreshCycles = GCProfile_GetLastCycles(GC_PROFILE_SWITCH_SNAPSHOT) +
+							 GCProfile_GetLastCycles(GC_PROFILE_PROCESS_SNAPSHOT) +
+							 GCProfile_GetLastCycles(GC_PROFILE_ENCODE);
+#if GC_USE_DEBOUNCE
+	refreshCycles += GCProfile_GetLastCycles(GC_PROFILE_DEBOUNCE);
+#endif
+	record.refreshCycles = GC_TELEMETRY_CLAMP_16(refreshCycles);
+#endif
+
+	GCTelemetry_Push(&record);
 }
+#endif
@@ -0,0 +1,350 @@
+#include "gc_controller_reader.h"
+#include "gc_port.h"
+#include "gc_joybus.h"
+
+#if GC_USE_READER_MODE && GC_USE_DMA_RX
+/* The USART interrupt would hand the response to the emulation */
+#error "GC_USE_READER_MODE cannot be used with GC_USE_DMA_RX"
+#endif
+
+// Macros //
+/* Console port the controller is plugged into */
+#define GC_READER_PORT				0
+
+/* Bytes of each command sent */
+#define GC_READER_PROBE_COMMAND_BYTES	1
+#define GC_READER_ORIGIN_COMMAND_BYTES	1
+#define GC_READER_POLL_COMMAND_BYTES	3
+
+/* Poll mode asked for and the bit of the first POLL response byte a
+ * controller sets to have its origin read again
+ */
+#define GC_READER_POLL_MODE			0x03
+#define GC_READER_ORIGIN_WANTED		0x20
+
+// Enumerations //
+/* Command sent next */
+typedef enum
+{
+	GC_READER_STATE_PROBE = 0,
+	GC_READER_STATE_ORIGIN = 1,
+	GC_READER_STATE_POLL = 2
+} GCReaderState_t;
+
+/* Outcome of an exchange with the controller */
+typedef enum
+{
+	GC_READER_RESPONSE_OK = 0,
+	GC_READER_RESPONSE_TIMEOUT = 1,
+	GC_READER_RESPONSE_BAD = 2
+} GCReaderResponse_t;
+
+// Structures //
+/* Everything kept between commands */
+typedef struct
+{
+	GCReaderState_t state;
+	uint32_t nextCommandTime;
+	uint32_t numOfMisses;		/* Polls in a row without a good response */
+	uint32_t responseDelay;		/* Of the last exchange, see Note 3 of gc_controller_reader.h */
+	uint8_t pollCommand[GC_READER_POLL_COMMAND_BYTES];
+	GCReaderController_t controller;
+	GCReaderStats_t stats;
+} GCReader_t;
+
+// Variables //
+static GCReader_t gcReader;
+
+/* Commands encoded once, so sending one only has to start */
+static uint32_t gcReaderProbeFrame[GC_READER_PROBE_COMMAND_BYTES];
+static uint32_t gcReaderOriginFrame[GC_READER_ORIGIN_COMMAND_BYTES];
+static uint32_t gcReaderPollFrame[GC_READER_POLL_COMMAND_BYTES];
+
+// Function Prototypes //
+/* Sends a command frame and receives a response of the given number of
+ * GC bytes
+ */
+static GCReaderResponse_t GCControllerReader_Exchange(const uint32_t *, uint32_t, uint8_t *, uint32_t);
+
+/* Counts the outcome of an exchange, returns 1 if it was good */
+static uint32_t GCControllerReader_CountResponse(GCReaderResponse_t);
+
+/* Sends each command and moves along Note 2 of gc_controller_reader.h */
+static void GCControllerReader_Probe(void);
+static void GCControllerReader_ReadOrigin(void);
+static void GCControllerReader_Poll(uint32_t);
+
+// Public Function Implementations //
+void GCControllerReader_Init()
+{
+	static const uint8_t probe[] = {GC_JOYBUS_COMMAND_PROBE};
+	static const uint8_t origin[] = {GC_JOYBUS_COMMAND_PROBE_ORIGIN};
+
+	GCPort_Init();
+
+	gcReader = (GCReader_t){0};
+	gcReader.state = GC_READER_STATE_PROBE;
+	gcReader.nextCommandTime = GCPort_GetCycles();
+	gcReader.stats.minResponseDelay = UINT32_MAX;
+
+	GCJoybus_EncodeFrame(probe, GC_READER_PROBE_COMMAND_BYTES, gcReaderProbeFrame);
+	GCJoybus_EncodeFrame(origin, GC_READER_ORIGIN_COMMAND_BYTES, gcReaderOriginFrame);
+	GCPort_PrepareFrame(GC_READER_PORT, gcReaderProbeFrame, GC_READER_PROBE_COMMAND_BYTES);
+	GCPort_PrepareFrame(GC_READER_PORT, gcReaderOriginFrame, GC_READER_ORIGIN_COMMAND_BYTES);
+
+	// Poll in the standard mode with rumble off
+	GCControllerReader_SetRumble(0x00);
+}
+
+void GCControllerReader_Run()
+{
+	while(1)
+	{
+		GCControllerReader_RunOnce();
+	}
+}
+
+uint32_t GCControllerReader_RunOnce()
+{
+	uint32_t now = GCPort_GetCycles();
+	uint32_t lateCycles = now - gcReader.nextCommandTime;
+	if((int32_t)lateCycles < 0)
+	{
+		return 0;
+	}
+
+	/* Keep to the grid unless a whole period was missed, see Note 3 of
+	 * gc_controller_reader.h
+	 */
+	if(lateCycles > gcReader.stats.maxLateCycles)
+	{
+		gcReader.stats.maxLateCycles = lateCycles;
+	}
+	gcReader.nextCommandTime += GC_READER_POLL_PERIOD_CYCLES;
+	if(lateCycles >= GC_READER_POLL_PERIOD_CYCLES)
+	{
+		gcReader.nextCommandTime = now + GC_READER_POLL_PERIOD_CYCLES;
+	}
+
+	switch(gcReader.state)
+	{
+		case GC_READER_STATE_PROBE:
+			GCControllerReader_Probe();
+			break;
+
+		case GC_READER_STATE_ORIGIN:
+			GCControllerReader_ReadOrigin();
+			break;
+
+		default:
+			GCControllerReader_Poll(now);
+			break;
+	}
+
+	return 1;
+}
+
+void GCControllerReader_SetRumble(uint8_t rumble)
+{
+	gcReader.pollCommand[0] = GC_JOYBUS_COMMAND_POLL;
+	gcReader.pollCommand[1] = GC_READER_POLL_MODE;
+	gcReader.pollCommand[2] = rumble;
+
+	GCJoybus_EncodeFrame(gcReader.pollCommand, GC_READER_POLL_COMMAND_BYTES, gcReaderPollFrame);
+	GCPort_PrepareFrame(GC_READER_PORT, gcReaderPollFrame, GC_READER_POLL_COMMAND_BYTES);
+}
+
+void GCControllerReader_GetController(GCReaderController_t *controller)
+{
+	*controller = gcReader.controller;
+}
+
+void GCControllerReader_GetStats(GCReaderStats_t *stats)
+{
+	*stats = gcReader.stats;
+}
+
+// Private Function Implementations //
+GCReaderResponse_t GCControllerReader_Exchange(const uint32_t *command, uint32_t numOfCommandBytes, uint8_t *response, uint32_t numOfResponseBytes)
+{
+	uint32_t numOfGCBytes = 0;
+	uint32_t numOfBitPairs = 0;
+	uint32_t gcByte = 0;
+	uint32_t isBad = 0;
+
+	/* RX and TX share the line, so our own command must not be received.
+	 * The receiver is turned on once the stop bit released the line.
+	 */
+	GCPort_StopReceiving(GC_READER_PORT);
+	GCPort_SendFrame(GC_READER_PORT, command, numOfCommandBytes);
+	while(GCPort_IsBusy(GC_READER_PORT)){};
+	GCPort_StartReceiving(GC_READER_PORT);
+
+	uint32_t commandEnd = GCPort_GetCycles();
+	uint32_t lastByteTime = commandEnd;
+	uint32_t timeout = GC_READER_RESPONSE_TIMEOUT_CYCLES;
+
+	while(1)
+	{
+		// A controller that is not there, or stops in the middle, never ends the response
+		while(!GCPort_IsByteReceived(GC_READER_PORT))
+		{
+			if((GCPort_GetCycles() - lastByteTime) > timeout)
+			{
+				GCPort_StopReceiving(GC_READER_PORT);
+				return ((numOfGCBytes == 0) && (numOfBitPairs == 0)) ? GC_READER_RESPONSE_TIMEOUT : GC_READER_RESPONSE_BAD;
+			}
+		}
+
+		uint8_t bitPair = gcJoybusDecodeTable[GCPort_ReceiveByte(GC_READER_PORT)];
+		uint32_t now = GCPort_GetCycles();
+		if((numOfGCBytes == 0) && (numOfBitPairs == 0))
+		{
+			gcReader.responseDelay = now - commandEnd;
+		}
+		lastByteTime = now;
+		timeout = GC_READER_BYTE_TIMEOUT_CYCLES;
+
+		if(bitPair == GC_JOYBUS_STOP_BIT)
+		{
+			break;
+		}
+
+		// Keep counting bits after an invalid one so the length is still checked
+		if(bitPair == GC_JOYBUS_INVALID_BITS)
+		{
+			isBad = 1;
+			bitPair = 0;
+		}
+
+		gcByte = (gcByte << 2) | bitPair;
+		if(++numOfBitPairs == 4)
+		{
+			if(numOfGCBytes < numOfResponseBytes)
+			{
+				response[numOfGCBytes] = (uint8_t)gcByte;
+			}
+			numOfGCBytes++;
+			numOfBitPairs = 0;
+			gcByte = 0;
+		}
+	}
+
+	GCPort_StopReceiving(GC_READER_PORT);
+
+	if((numOfGCBytes == 0) && (numOfBitPairs == 0))
+	{
+		// The line only had the stop bit of nothing
+		return GC_READER_RESPONSE_TIMEOUT;
+	}
+
+	if(isBad || (numOfBitPairs != 0) || (numOfGCBytes != numOfResponseBytes))
+	{
+		return GC_READER_RESPONSE_BAD;
+	}
+
+	return GC_READER_RESPONSE_OK;
+}
+
+uint32_t GCControllerReader_CountResponse(GCReaderResponse_t result)
+{
+	if(result == GC_READER_RESPONSE_TIMEOUT)
+	{
+		gcReader.stats.numOfTimeouts++;
+	}
+	else if(result == GC_READER_RESPONSE_BAD)
+	{
+		gcReader.stats.numOfBadResponses++;
+	}
+
+	return (result == GC_READER_RESPONSE_OK) ? 1 : 0;
+}
+
+void GCControllerReader_Probe()
+{
+	uint8_t response[GC_READER_PROBE_BYTES];
+	GCReaderResponse_t result = GCControllerReader_Exchange(gcReaderProbeFrame, GC_READER_PROBE_COMMAND_BYTES, response, GC_READER_PROBE_BYTES);
+
+	if(GCControllerReader_CountResponse(result))
+	{
+		for(uint32_t i = 0; i < GC_READER_PROBE_BYTES; i++)
+		{
+			gcReader.controller.deviceId[i] = response[i];
+		}
+		gcReader.state = GC_READER_STATE_ORIGIN;
+	}
+}
+
+void GCControllerReader_ReadOrigin()
+{
+	uint8_t response[GC_READER_ORIGIN_BYTES];
+	GCReaderResponse_t result = GCControllerReader_Exchange(gcReaderOriginFrame, GC_READER_ORIGIN_COMMAND_BYTES, response, GC_READER_ORIGIN_BYTES);
+
+	if(!GCControllerReader_CountResponse(result))
+	{
+		// Start over, the controller may have been unplugged
+		gcReader.controller.isConnected = 0;
+		gcReader.state = GC_READER_STATE_PROBE;
+		return;
+	}
+
+	for(uint32_t i = 0; i < GC_READER_ORIGIN_BYTES; i++)
+	{
+		gcReader.controller.origin[i] = response[i];
+	}
+
+	if(!gcReader.controller.isConnected)
+	{
+		gcReader.controller.isConnected = 1;
+		gcReader.stats.numOfConnects++;
+	}
+	gcReader.numOfMisses = 0;
+	gcReader.state = GC_READER_STATE_POLL;
+}
+
+void GCControllerReader_Poll(uint32_t pollTime)
+{
+	uint8_t response[GC_READER_POLL_BYTES];
+	GCReaderResponse_t result = GCControllerReader_Exchange(gcReaderPollFrame, GC_READER_POLL_COMMAND_BYTES, response, GC_READER_POLL_BYTES);
+	gcReader.stats.numOfPolls++;
+
+	if(!GCControllerReader_CountResponse(result))
+	{
+		if(++gcReader.numOfMisses >= GC_READER_MAX_MISSES)
+		{
+			gcReader.controller.isConnected = 0;
+			gcReader.state = GC_READER_STATE_PROBE;
+		}
+		return;
+	}
+	gcReader.numOfMisses = 0;
+
+	/* How fast and how steady the controller answers */
+	GCReaderStats_t *stats = &gcReader.stats;
+	stats->lastResponseDelay = gcReader.responseDelay;
+	if(gcReader.responseDelay < stats->minResponseDelay)
+	{
+		stats->minResponseDelay = gcReader.responseDelay;
+	}
+	if(gcReader.responseDelay > stats->maxResponseDelay)
+	{
+		stats->maxResponseDelay = gcReader.responseDelay;
+	}
+
+	uint32_t isChanged = 0;
+	for(uint32_t i = 0; i < GC_READER_POLL_BYTES; i++)
+	{
+		isChanged |= (uint32_t)(response[i] ^ gcReader.controller.state[i]);
+		gcReader.controller.state[i] = response[i];
+	}
+	if(isChanged)
+	{
+		stats->numOfStateChanges++;
+	}
+	gcReader.controller.stateTime = pollTime;
+
+	if(response[0] & GC_READER_ORIGIN_WANTED)
+	{
+		gcReader.state = GC_READER_STATE_ORIGIN;
+	}
+}
@@ -0,0 +1,132 @@
+#include "gc_debounce.h"
+#include "gc_controller_emulation.h"
+
+// Macros //
+/* Inputs of each group */
+#define GC_DEBOUNCE_BUTTONS		(GC_BUTTON_MASK(GC_A) | GC_BUTTON_MASK(GC_B) | GC_BUTTON_MASK(GC_X) | \
+								 GC_BUTTON_MASK(GC_Y) | GC_BUTTON_MASK(GC_L) | GC_BUTTON_MASK(GC_R) | \
+								 GC_BUTTON_MASK(GC_Z) | GC_BUTTON_MASK(GC_START))
+#define GC_DEBOUNCE_DPAD		(GC_BUTTON_MASK(GC_DPAD_UP) | GC_BUTTON_MASK(GC_DPAD_DOWN) | \
+								 GC_BUTTON_MASK(GC_DPAD_LEFT) | GC_BUTTON_MASK(GC_DPAD_RIGHT))
+#define GC_DEBOUNCE_MAIN_STICK	(GC_BUTTON_MASK(GC_MAIN_STICK_UP) | GC_BUTTON_MASK(GC_MAIN_STICK_DOWN) | \
+								 GC_BUTTON_MASK(GC_MAIN_STICK_LEFT) | GC_BUTTON_MASK(GC_MAIN_STICK_RIGHT))
+#define GC_DEBOUNCE_C_STICK		(GC_BUTTON_MASK(GC_C_STICK_UP) | GC_BUTTON_MASK(GC_C_STICK_DOWN) | \
+								 GC_BUTTON_MASK(GC_C_STICK_LEFT) | GC_BUTTON_MASK(GC_C_STICK_RIGHT))
+#define GC_DEBOUNCE_MODIFIERS	(GC_BUTTON_MASK(GC_MACRO) | GC_BUTTON_MASK(GC_TILT))
+#define GC_DEBOUNCE_ALL_INPUTS	(GC_DEBOUNCE_BUTTONS | GC_DEBOUNCE_DPAD | GC_DEBOUNCE_MAIN_STICK | \
+								 GC_DEBOUNCE_C_STICK | GC_DEBOUNCE_MODIFIERS)
+
+// Constant Tables //
+static const uint32_t gcDebounceGroupInputs[NUM_OF_GC_DEBOUNCE_GROUPS] =
+{
+	[GC_DEBOUNCE_GROUP_BUTTONS] = GC_DEBOUNCE_BUTTONS,
+	[GC_DEBOUNCE_GROUP_DPAD] = GC_DEBOUNCE_DPAD,
+	[GC_DEBOUNCE_GROUP_MAIN_STICK] = GC_DEBOUNCE_MAIN_STICK,
+	[GC_DEBOUNCE_GROUP_C_STICK] = GC_DEBOUNCE_C_STICK,
+	[GC_DEBOUNCE_GROUP_MODIFIERS] = GC_DEBOUNCE_MODIFIERS
+};
+
+// Function Prototypes //
+/* Steps the counters of the inputs that are counting by one tick */
+inline static void GCDebounce_Tick(GCDebounce_t *, uint32_t);
+
+// Public Function Implementations //
+void GCDebounce_Init(GCDebounce_t *debounce, uint32_t inputs, uint32_t cycles, uint32_t tickCycles)
+{
+	*debounce = (GCDebounce_t){0};
+	debounce->state = inputs;
+	debounce->bypass = GC_DEBOUNCE_ALL_INPUTS;
+	debounce->tickCycles = tickCycles;
+	debounce->lastTick = cycles;
+}
+
+void GCDebounce_SetGroup(GCDebounce_t *debounce, GCDebounceGroup_t group, GCDebounceMode_t mode, uint32_t ticks)
+{
+	if( (group >= NUM_OF_GC_DEBOUNCE_GROUPS) || (mode >= NUM_OF_GC_DEBOUNCE_MODES) )
+	{
+		return;
+	}
+
+	uint32_t inputs = gcDebounceGroupInputs[group];
+	if(ticks > GC_DEBOUNCE_MAX_TICKS)
+	{
+		ticks = GC_DEBOUNCE_MAX_TICKS;
+	}
+
+	for(uint32_t b = 0; b < GC_DEBOUNCE_COUNTER_BITS; b++)
+	{
+		debounce->threshold[b] = (debounce->threshold[b] & ~inputs) | (((ticks >> b) & 1) ? inputs : 0);
+		debounce->count[b] &= ~inputs;
+	}
+	debounce->eager = (mode == GC_DEBOUNCE_EAGER) ? (debounce->eager | inputs) : (debounce->eager & ~inputs);
+	debounce->bypass = (ticks == 0) ? (debounce->bypass | inputs) : (debounce->bypass & ~inputs);
+	debounce->locked &= ~inputs;
+}
+
+uint32_t GCDebounce_Process(GCDebounce_t *debounce, uint32_t inputs, uint32_t cycles)
+{
+	/* Catch up on the ticks since the last snapshot. No counter goes
+	 * past GC_DEBOUNCE_MAX_TICKS so a long gap needs no more steps.
+	 */
+	uint32_t numOfTicks = (cycles - debounce->lastTick) / debounce->tickCycles;
+	debounce->lastTick += numOfTicks * debounce->tickCycles;
+	if(numOfTicks > GC_DEBOUNCE_MAX_TICKS)
+	{
+		numOfTicks = GC_DEBOUNCE_MAX_TICKS;
+	}
+	while(numOfTicks--)
+	{
+		GCDebounce_Tick(debounce, inputs);
+	}
+
+	/* EAGER inputs follow their first edge and then lock */
+	uint32_t changed = (inputs ^ debounce->state) & ~debounce->bypass;
+	uint32_t flipped = changed & debounce->eager & ~debounce->locked;
+	debounce->state ^= flipped;
+	debounce->locked |= flipped;
+
+	/* DEFERRED inputs that read like their state again start over */
+	uint32_t keep = (inputs ^ debounce->state) | debounce->eager;
+	for(uint32_t b = 0; b < GC_DEBOUNCE_COUNTER_BITS; b++)
+	{
+		debounce->count[b] &= keep;
+	}
+
+	debounce->state = (debounce->state & ~debounce->bypass) | (inputs & debounce->bypass);
+
+	return debounce->state;
+}
+
+// Private Function Implementations //
+void GCDebounce_Tick(GCDebounce_t *debounce, uint32_t inputs)
+{
+	uint32_t *count = debounce->count;
+	uint32_t *threshold = debounce->threshold;
+
+	/* Locked EAGER inputs and DEFERRED inputs away from their state count */
+	uint32_t counting = ((inputs ^ debounce->state) & ~debounce->eager & ~debounce->bypass) | debounce->locked;
+
+	// Add one to every counting counter, rippling the carry up
+	uint32_t carry = counting;
+	for(uint32_t b = 0; b < GC_DEBOUNCE_COUNTER_BITS; b++)
+	{
+		uint32_t nextCarry = count[b] & carry;
+		count[b] ^= carry;
+		carry = nextCarry;
+	}
+
+	// Counters that reached their threshold are done
+	uint32_t notDone = 0;
+	for(uint32_t b = 0; b < GC_DEBOUNCE_COUNTER_BITS; b++)
+	{
+		notDone |= count[b] ^ threshold[b];
+	}
+	uint32_t done = counting & ~notDone;
+
+	debounce->state ^= done & ~debounce->eager;
+	debounce->locked &= ~done;
+	for(uint32_t b = 0; b < GC_DEBOUNCE_COUNTER_BITS; b++)
+	{
+		count[b] &= ~done;
+	}
+}
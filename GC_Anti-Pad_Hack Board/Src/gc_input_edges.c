@@ -0,0 +1,209 @@
+#include "gc_input_edges.h"
+#include "gc_port.h"
+
+#if GC_USE_INPUT_EDGES
+_Static_assert((GC_INPUT_EDGE_RING_SIZE & (GC_INPUT_EDGE_RING_SIZE - 1)) == 0, "input edge ring size must be a power of 2");
+
+// Macros //
+/* Ring slot of a free running edge count */
+#define GC_INPUT_EDGE_SLOT(count)	((count) & (GC_INPUT_EDGE_RING_SIZE - 1))
+
+// Variables //
+/* Inputs at the last capture */
+static uint32_t gcLastInputs = 0;
+
+/* Presses kept in the responses of every console port, and how many
+ * more responses of it need them
+ */
+static uint32_t gcPendingPresses[GC_NUM_OF_CONSOLE_PORTS];
+static uint8_t gcPendingPolls[GC_NUM_OF_CONSOLE_PORTS][NUM_OF_GC_BUTTON_INPUTS];
+
+/* Console ports that sent a response within GC_POLL_MAX_PERIOD_CYCLES,
+ * and when they last did
+ */
+static uint32_t gcPollingPorts = 0;
+static uint32_t gcLastDeliveries[GC_NUM_OF_CONSOLE_PORTS];
+
+/* Presses no response has carried yet, and when they happened */
+static uint32_t gcUndeliveredPresses = 0;
+static uint32_t gcPressTimes[NUM_OF_GC_BUTTON_INPUTS];
+
+/* Edges waiting to be read */
+static GCInputEdge_t gcEdgeRing[GC_INPUT_EDGE_RING_SIZE];
+static uint32_t gcEdgeHead = 0;
+static uint32_t gcEdgeTail = 0;
+
+static GCInputEdgeStats_t gcEdgeStats;
+
+// Public Function Implementations //
+void GCInputEdges_Init(uint32_t inputs)
+{
+	uint32_t lock = GCPort_LockInputs();
+
+	gcLastInputs = inputs;
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		gcPendingPresses[i] = 0;
+	}
+	gcPollingPorts = 0;
+	gcUndeliveredPresses = 0;
+	gcEdgeHead = 0;
+	gcEdgeTail = 0;
+	gcEdgeStats = (GCInputEdgeStats_t){0};
+
+	GCPort_UnlockInputs(lock);
+}
+
+void GCInputEdges_Capture(uint32_t inputs, uint32_t cycles)
+{
+	uint32_t lock = GCPort_LockInputs();
+	uint32_t changed = inputs ^ gcLastInputs;
+
+	gcLastInputs = inputs;
+
+	/* Usually nothing changed, only then go over the inputs one by one */
+	while(changed != 0)
+	{
+		uint32_t button = (uint32_t)__builtin_ctz(changed);
+		uint32_t mask = 1UL << button;
+		uint32_t pushed = (inputs & mask) ? 1 : 0;
+		changed &= ~mask;
+
+		if(pushed)
+		{
+			gcEdgeStats.numOfPresses++;
+			gcPressTimes[button] = cycles;
+			gcUndeliveredPresses |= mask;
+#if GC_INPUT_STRETCH_POLLS
+			for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+			{
+				if(gcPollingPorts & (1UL << i))
+				{
+					gcPendingPresses[i] |= mask;
+					gcPendingPolls[i][button] = GC_INPUT_STRETCH_POLLS;
+				}
+			}
+#endif
+		}
+		else
+		{
+			// Only the stretch lets a console see this press
+			uint32_t pending = 0;
+			for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+			{
+				pending |= gcPendingPresses[i];
+			}
+			if(pending & mask)
+			{
+				gcEdgeStats.numOfStretchedPresses++;
+			}
+		}
+
+		/* Newest edges are dropped if nobody reads them */
+		gcEdgeStats.numOfEdges++;
+		if((gcEdgeHead - gcEdgeTail) < GC_INPUT_EDGE_RING_SIZE)
+		{
+			gcEdgeRing[GC_INPUT_EDGE_SLOT(gcEdgeHead)] = (GCInputEdge_t){cycles, (uint8_t)button, (uint8_t)pushed};
+			gcEdgeHead++;
+		}
+		else
+		{
+			gcEdgeStats.numOfDroppedEdges++;
+		}
+	}
+
+	GCPort_UnlockInputs(lock);
+}
+
+uint32_t GCInputEdges_Sample(uint32_t inputs, uint32_t cycles)
+{
+	uint32_t lock = GCPort_LockInputs();
+
+	GCInputEdges_Capture(inputs, cycles);
+
+	/* A port that stopped polling would keep its presses forever */
+	for(uint32_t i = 0; i < GC_NUM_OF_CONSOLE_PORTS; i++)
+	{
+		if( (gcPollingPorts & (1UL << i)) && ((cycles - gcLastDeliveries[i]) > GC_POLL_MAX_PERIOD_CYCLES) )
+		{
+			gcPollingPorts &= ~(1UL << i);
+			gcPendingPresses[i] = 0;
+		}
+		inputs |= gcPendingPresses[i];
+	}
+
+	GCPort_UnlockInputs(lock);
+
+	return inputs;
+}
+
+void GCInputEdges_Delivered(uint32_t consolePort, uint32_t inputs, uint32_t cycles)
+{
+	uint32_t lock = GCPort_LockInputs();
+
+	gcPollingPorts |= 1UL << consolePort;
+	gcLastDeliveries[consolePort] = cycles;
+
+	/* First response with a press, on any port, ends its latency */
+	uint32_t delivered = inputs & gcUndeliveredPresses;
+	gcUndeliveredPresses &= ~delivered;
+	while(delivered != 0)
+	{
+		uint32_t button = (uint32_t)__builtin_ctz(delivered);
+		uint32_t latency = cycles - gcPressTimes[button];
+		delivered &= ~(1UL << button);
+
+		if( (gcEdgeStats.numOfLatencies == 0) || (latency < gcEdgeStats.minLatency) )
+		{
+			gcEdgeStats.minLatency = latency;
+		}
+		if(latency > gcEdgeStats.maxLatency)
+		{
+			gcEdgeStats.maxLatency = latency;
+		}
+		gcEdgeStats.totalLatency += latency;
+		gcEdgeStats.numOfLatencies++;
+	}
+
+	/* Stretched presses are let go once enough responses of this port
+	 * carried them
+	 */
+	uint32_t stretched = inputs & gcPendingPresses[consolePort];
+	while(stretched != 0)
+	{
+		uint32_t button = (uint32_t)__builtin_ctz(stretched);
+		stretched &= ~(1UL << button);
+
+		if(--gcPendingPolls[consolePort][button] == 0)
+		{
+			gcPendingPresses[consolePort] &= ~(1UL << button);
+		}
+	}
+
+	GCPort_UnlockInputs(lock);
+}
+
+uint32_t GCInputEdges_Read(GCInputEdge_t *edge)
+{
+	uint32_t lock = GCPort_LockInputs();
+	uint32_t isRead = 0;
+
+	if(gcEdgeHead != gcEdgeTail)
+	{
+		*edge = gcEdgeRing[GC_INPUT_EDGE_SLOT(gcEdgeTail)];
+		gcEdgeTail++;
+		isRead = 1;
+	}
+
+	GCPort_UnlockInputs(lock);
+
+	return isRead;
+}
+
+void GCInputEdges_GetStats(GCInputEdgeStats_t *stats)
+{
+	uint32_t lock = GCPort_LockInputs();
+	*stats = gcEdgeStats;
+	GCPort_UnlockInputs(lock);
+}
+#endif
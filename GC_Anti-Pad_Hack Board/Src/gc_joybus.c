@@ -0,0 +1,51 @@
+#include "gc_joybus.h"
+
+// Macros //
+/* Sixteen consecutive GC bytes starting at gcByte */
+#define GC_JOYBUS_ENCODE_ROW(gcByte) \
+	GC_JOYBUS_ENCODE((gcByte) + 0x0), GC_JOYBUS_ENCODE((gcByte) + 0x1), \
+	GC_JOYBUS_ENCODE((gcByte) + 0x2), GC_JOYBUS_ENCODE((gcByte) + 0x3), \
+	GC_JOYBUS_ENCODE((gcByte) + 0x4), GC_JOYBUS_ENCODE((gcByte) + 0x5), \
+	GC_JOYBUS_ENCODE((gcByte) + 0x6), GC_JOYBUS_ENCODE((gcByte) + 0x7), \
+	GC_JOYBUS_ENCODE((gcByte) + 0x8), GC_JOYBUS_ENCODE((gcByte) + 0x9), \
+	GC_JOYBUS_ENCODE((gcByte) + 0xA), GC_JOYBUS_ENCODE((gcByte) + 0xB), \
+	GC_JOYBUS_ENCODE((gcByte) + 0xC), GC_JOYBUS_ENCODE((gcByte) + 0xD), \
+	GC_JOYBUS_ENCODE((gcByte) + 0xE), GC_JOYBUS_ENCODE((gcByte) + 0xF)
+
+/* Sixteen consecutive UART bytes starting at uartByte */
+#define GC_JOYBUS_DECODE_ROW(uartByte) \
+	GC_JOYBUS_DECODE((uartByte) + 0x0), GC_JOYBUS_DECODE((uartByte) + 0x1), \
+	GC_JOYBUS_DECODE((uartByte) + 0x2), GC_JOYBUS_DECODE((uartByte) + 0x3), \
+	GC_JOYBUS_DECODE((uartByte) + 0x4), GC_JOYBUS_DECODE((uartByte) + 0x5), \
+	GC_JOYBUS_DECODE((uartByte) + 0x6), GC_JOYBUS_DECODE((uartByte) + 0x7), \
+	GC_JOYBUS_DECODE((uartByte) + 0x8), GC_JOYBUS_DECODE((uartByte) + 0x9), \
+	GC_JOYBUS_DECODE((uartByte) + 0xA), GC_JOYBUS_DECODE((uartByte) + 0xB), \
+	GC_JOYBUS_DECODE((uartByte) + 0xC), GC_JOYBUS_DECODE((uartByte) + 0xD), \
+	GC_JOYBUS_DECODE((uartByte) + 0xE), GC_JOYBUS_DECODE((uartByte) + 0xF)
+
+// Variables //
+/* GC byte to four UART bytes. Built by the compiler so it lives in flash. */
+const uint32_t gcJoybusEncodeTable[256] =
+{
+	GC_JOYBUS_ENCODE_ROW(0x00), GC_JOYBUS_ENCODE_ROW(0x10),
+	GC_JOYBUS_ENCODE_ROW(0x20), GC_JOYBUS_ENCODE_ROW(0x30),
+	GC_JOYBUS_ENCODE_ROW(0x40), GC_JOYBUS_ENCODE_ROW(0x50),
+	GC_JOYBUS_ENCODE_ROW(0x60), GC_JOYBUS_ENCODE_ROW(0x70),
+	GC_JOYBUS_ENCODE_ROW(0x80), GC_JOYBUS_ENCODE_ROW(0x90),
+	GC_JOYBUS_ENCODE_ROW(0xA0), GC_JOYBUS_ENCODE_ROW(0xB0),
+	GC_JOYBUS_ENCODE_ROW(0xC0), GC_JOYBUS_ENCODE_ROW(0xD0),
+	GC_JOYBUS_ENCODE_ROW(0xE0), GC_JOYBUS_ENCODE_ROW(0xF0)
+};
+
+/* UART byte to GC bit pair. Built by the compiler so it lives in flash. */
+const uint8_t gcJoybusDecodeTable[256] =
+{
+	GC_JOYBUS_DECODE_ROW(0x00), GC_JOYBUS_DECODE_ROW(0x10),
+	GC_JOYBUS_DECODE_ROW(0x20), GC_JOYBUS_DECODE_ROW(0x30),
+	GC_JOYBUS_DECODE_ROW(0x40), GC_JOYBUS_DECODE_ROW(0x50),
+	GC_JOYBUS_DECODE_ROW(0x60), GC_JOYBUS_DECODE_ROW(0x70),
+	GC_JOYBUS_DECODE_ROW(0x80), GC_JOYBUS_DECODE_ROW(0x90),
+	GC_JOYBUS_DECODE_ROW(0xA0), GC_JOYBUS_DECODE_ROW(0xB0),
+	GC_JOYBUS_DECODE_ROW(0xC0), GC_JOYBUS_DECODE_ROW(0xD0),
+	GC_JOYBUS_DECODE_ROW(0xE0), GC_JOYBUS_DECODE_ROW(0xF0)
+};
@@ -0,0 +1,150 @@
+#include <stddef.h>
+#include "gc_macro.h"
+#include "gc_macro_profile.h"
+#include "gc_controller_emulation.h"
+
+// Macros //
+/* Bit of the output word set while a sequence plays, above every input */
+#define GC_MACRO_PLAYING		(1UL << 31)
+
+/* Buttons that pick a sequence while MACRO is held, slot 0 first */
+#define GC_MACRO_PICK_BUTTONS	(GC_BUTTON_MASK(GC_A) | GC_BUTTON_MASK(GC_B) | GC_BUTTON_MASK(GC_X) | GC_BUTTON_MASK(GC_Y))
+
+/* Stick and modifier inputs set by a STICK op */
+#define GC_MACRO_STICK_INPUTS	(((1UL << GC_STICK_INDEX_BITS) - 1) << GC_MAIN_STICK_UP)
+
+/* Operand of a PRESS or RELEASE op */
+#define GC_MACRO_OPERAND_WORD(bytes) \
+	( (uint32_t)(bytes)[0] | ((uint32_t)(bytes)[1] << 8) | ((uint32_t)(bytes)[2] << 16) )
+
+_Static_assert((GC_A == 0) && (GC_B == 1) && (GC_X == 2) && (GC_Y == 3), "The pick buttons must be the lowest inputs");
+
+// Constant Tables //
+static const uint8_t gcMacroSequenceA[] = {GC_MACRO_PROFILE_A};
+static const uint8_t gcMacroSequenceB[] = {GC_MACRO_PROFILE_B};
+static const uint8_t gcMacroSequenceX[] = {GC_MACRO_PROFILE_X};
+static const uint8_t gcMacroSequenceY[] = {GC_MACRO_PROFILE_Y};
+
+const uint8_t * const gcMacroSequences[GC_MACRO_NUM_OF_SLOTS] =
+{
+	gcMacroSequenceA,
+	gcMacroSequenceB,
+	gcMacroSequenceX,
+	gcMacroSequenceY
+};
+
+/* Slot of the lowest pick button pressed, for every combination of them */
+static const uint8_t gcMacroPickSlots[1UL << GC_MACRO_NUM_OF_SLOTS] =
+{
+	0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
+// Public Function Implementations //
+void GCMacro_Init(GCMacro_t *macro, const uint8_t * const *sequences)
+{
+	*macro = (GCMacro_t){0};
+	macro->sequences = sequences;
+}
+
+uint32_t GCMacro_Apply(GCMacro_t *macro, uint32_t inputs)
+{
+	uint32_t isMacroHeld = inputs & GC_BUTTON_MASK(GC_MACRO);
+
+	/* A pick button pressed while MACRO is held asks for its sequence,
+	 * see Note 3 of gc_macro.h
+	 */
+	uint32_t picked = inputs & ~macro->lastInputs & GC_MACRO_PICK_BUTTONS;
+	macro->lastInputs = inputs;
+	if(isMacroHeld && picked)
+	{
+		macro->requestedSlot = gcMacroPickSlots[picked];
+		macro->numOfRequests++;
+	}
+
+	// The pick buttons are not sent while MACRO is held
+	if(isMacroHeld)
+	{
+		inputs &= ~GC_MACRO_PICK_BUTTONS;
+	}
+
+	uint32_t output = macro->output;
+	return (output & GC_MACRO_PLAYING) ? (output & ~GC_MACRO_PLAYING) : inputs;
+}
+
+void GCMacro_Poll(GCMacro_t *macro)
+{
+	if(macro->sequence == NULL)
+	{
+		/* Nothing plays, start what was asked for since the last poll */
+		uint32_t numOfRequests = macro->numOfRequests;
+		if(numOfRequests == macro->numOfStarts)
+		{
+			return;
+		}
+		macro->numOfStarts = numOfRequests;
+		macro->sequence = macro->sequences[macro->requestedSlot];
+		macro->pc = 0;
+		macro->waitPolls = 0;
+		macro->held = 0;
+	}
+	else if(macro->waitPolls > 1)
+	{
+		macro->waitPolls--;
+		return;
+	}
+	else
+	{
+		// Presses while playing are not kept for later
+		macro->numOfStarts = macro->numOfRequests;
+	}
+
+	/* Execute up to the next WAIT, see Note 2 of gc_macro.h */
+	const uint8_t *sequence = macro->sequence;
+	uint32_t pc = macro->pc;
+	uint32_t held = macro->held;
+	macro->waitPolls = 1;
+
+	for(uint32_t i = 0; i < GC_MACRO_MAX_OPS_PER_POLL; i++)
+	{
+		uint8_t op = sequence[pc];
+		if(op == GC_MACRO_OP_PRESS)
+		{
+			held |= GC_MACRO_OPERAND_WORD(&sequence[pc + 1]);
+			pc += 4;
+		}
+		else if(op == GC_MACRO_OP_RELEASE)
+		{
+			held &= ~GC_MACRO_OPERAND_WORD(&sequence[pc + 1]);
+			pc += 4;
+		}
+		else if(op == GC_MACRO_OP_STICK)
+		{
+			uint32_t index = (uint32_t)sequence[pc + 1] | ((uint32_t)sequence[pc + 2] << 8);
+			held = (held & ~GC_MACRO_STICK_INPUTS) | ((index << GC_MAIN_STICK_UP) & GC_MACRO_STICK_INPUTS);
+			pc += 3;
+		}
+		else if(op == GC_MACRO_OP_WAIT)
+		{
+			macro->waitPolls = (sequence[pc + 1] != 0) ? sequence[pc + 1] : 1;
+			pc += 2;
+			break;
+		}
+		else
+		{
+			// END, or an unknown op, hands the controller back
+			macro->sequence = NULL;
+			macro->held = 0;
+			macro->output = 0;
+			return;
+		}
+	}
+
+	macro->pc = pc;
+	macro->held = held;
+	macro->output = held | GC_MACRO_PLAYING;
+}
+
+uint32_t GCMacro_IsPlaying(const GCMacro_t *macro)
+{
+	return (macro->output & GC_MACRO_PLAYING) ? 1 : 0;
+}
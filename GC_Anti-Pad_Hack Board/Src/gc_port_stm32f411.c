@@ -0,0 +1,1649 @@
+#include "gc_port.h"
+#include "stm32f4xx_hal.h"
+#include "io_mapping_stm32f411ce_blackpill_weactstudio_v3_0.h"
+#include "gc_controller_emulation.h"
+#include "gc_profile.h"
+#include "gc_capture_rx.h"
+#include "gc_waveform.h"
+
+#if GC_USE_CAPTURE_RX && GC_USE_DMA_RX
+/* Commands are only ended by the idle line in the main loop */
+#error "GC_USE_CAPTURE_RX does not support GC_USE_DMA_RX"
+#endif
+
+#if GC_USE_WAVEFORM_TX && (GC_USE_DMA_TX || GC_USE_DMA_SAMPLING)
+/* The waveform replaces the UART transmitter, and needs TIM1 and DMA2
+ * stream 5 like the input sampling
+ */
+#error "GC_USE_WAVEFORM_TX does not support GC_USE_DMA_TX or GC_USE_DMA_SAMPLING"
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 3
+/* USART1, USART2 and USART6 are the only ones with pins to spare */
+#error "GC_NUM_OF_CONSOLE_PORTS must be at most 3"
+#endif
+
+#if (GC_NUM_OF_CONSOLE_PORTS > 2) && (GC_USE_TELEMETRY || GC_USE_DMA_SAMPLING)
+/* Console port 2 takes USART6 and DMA2 streams 1 and 6 */
+#error "A third console port does not support GC_USE_TELEMETRY or GC_USE_DMA_SAMPLING"
+#endif
+
+// Macros //
+/* Every button input and the io mapping prefix of its pin. This table
+ * is expanded at compile time so the snapshot is a handful of shifts
+ * on three port reads instead of a HAL call per button.
+ */
+#define GC_INPUT_PIN_TABLE(ENTRY)				\
+	ENTRY(GC_A, BUTTON_A)						\
+	ENTRY(GC_B, BUTTON_B)						\
+	ENTRY(GC_X, BUTTON_X)						\
+	ENTRY(GC_Y, BUTTON_Y)						\
+	ENTRY(GC_L, BUTTON_L)						\
+	ENTRY(GC_R, BUTTON_R)						\
+	ENTRY(GC_Z, BUTTON_Z)						\
+	ENTRY(GC_START, BUTTON_START)				\
+	ENTRY(GC_DPAD_UP, BUTTON_DU)				\
+	ENTRY(GC_DPAD_DOWN, BUTTON_DD)				\
+	ENTRY(GC_DPAD_LEFT, BUTTON_DL)				\
+	ENTRY(GC_DPAD_RIGHT, BUTTON_DR)				\
+	ENTRY(GC_MAIN_STICK_UP, BUTTON_LSU)			\
+	ENTRY(GC_MAIN_STICK_DOWN, BUTTON_LSD)		\
+	ENTRY(GC_MAIN_STICK_LEFT, BUTTON_LSL)		\
+	ENTRY(GC_MAIN_STICK_RIGHT, BUTTON_LSR)		\
+	ENTRY(GC_C_STICK_UP, BUTTON_CU)				\
+	ENTRY(GC_C_STICK_DOWN, BUTTON_CD)			\
+	ENTRY(GC_C_STICK_LEFT, BUTTON_CL)			\
+	ENTRY(GC_C_STICK_RIGHT, BUTTON_CR)			\
+	ENTRY(GC_MACRO, BUTTON_MACRO)				\
+	ENTRY(GC_TILT, BUTTON_TILT)
+
+/* Moves one pin of the inverted port reads to its packed bit */
+#define GC_INPUT_PIN_TO_BIT(gcButton, pinName) \
+	(((pushedPins[pinName##_PORT_INDEX] >> pinName##_PIN) & 1UL) << (gcButton)) |
+
+/* Buttons that get an EXTI line. Each line is shared by the pins with
+ * its number on every port and can only be routed to one of them, so
+ * the others (DR, DL, DD, CD, CU, MACRO and TILT) have none. They are
+ * still timed by the full port reads every capture does.
+ */
+#define GC_INPUT_EXTI_TABLE(ENTRY)				\
+	ENTRY(BUTTON_LSD)							\
+	ENTRY(BUTTON_LSU)							\
+	ENTRY(BUTTON_CL)							\
+	ENTRY(BUTTON_CR)							\
+	ENTRY(BUTTON_DU)							\
+	ENTRY(BUTTON_LSR)							\
+	ENTRY(BUTTON_LSL)							\
+	ENTRY(BUTTON_L)								\
+	ENTRY(BUTTON_R)								\
+	ENTRY(BUTTON_Z)								\
+	ENTRY(BUTTON_START)							\
+	ENTRY(BUTTON_A)								\
+	ENTRY(BUTTON_B)								\
+	ENTRY(BUTTON_X)								\
+	ENTRY(BUTTON_Y)
+
+/* EXTI line of one routed button */
+#define GC_INPUT_EXTI_LINE(pinName)		(1UL << pinName##_PIN) |
+
+/* Routes the EXTI line of one button to its port */
+#define GC_INPUT_EXTI_ROUTE(pinName) \
+	SYSCFG->EXTICR[pinName##_PIN >> 2] = (SYSCFG->EXTICR[pinName##_PIN >> 2] & ~(0xFUL << ((pinName##_PIN & 3) * 4))) | \
+										 ((uint32_t)pinName##_PORT_INDEX << ((pinName##_PIN & 3) * 4));
+
+/* Every routed EXTI line */
+#define GC_INPUT_EXTI_LINES		(GC_INPUT_EXTI_TABLE(GC_INPUT_EXTI_LINE) 0)
+
+/* Priority of the input EXTI interrupts, below the GC data line */
+#define GC_INPUT_EXTI_PRIORITY	2
+
+/* Background input sampling. TIM1 update, compare 1 and compare 4 each
+ * ask a DMA2 stream to copy one input port, in that order, so all three
+ * are copied within a few timer ticks of each other.
+ */
+#define GC_SAMPLE_TIMER			TIM1
+#define GC_SAMPLE_STREAM_A		DMA2_Stream5	/* Channel 6, TIM1_UP */
+#define GC_SAMPLE_STREAM_B		DMA2_Stream1	/* Channel 6, TIM1_CH1 */
+#define GC_SAMPLE_STREAM_C		DMA2_Stream4	/* Channel 6, TIM1_CH4 */
+#define GC_SAMPLE_CHANNEL		6
+#define GC_SAMPLE_PORT_B_TICKS	16
+#define GC_SAMPLE_PORT_C_TICKS	32
+
+/* Timer count after which every port of a period has been copied */
+#define GC_SAMPLE_SETTLED_TICKS	(GC_SAMPLE_PORT_C_TICKS + 16)
+
+/* Samples of each port kept in RAM, must be a power of 2 */
+#define GC_SAMPLE_RING_SIZE		(GC_MAX_SAMPLE_WINDOW * 2)
+
+/* UART bytes the circular receive buffer holds */
+#define GC_RX_RING_SIZE			64
+
+/* Edge captures of the data line. DMA1 stream 3 channel 2 is TIM4_CH2,
+ * the input filter takes 8 samples at the timer clock.
+ */
+#define GC_CAPTURE_STREAM		DMA1_Stream3
+#define GC_CAPTURE_CHANNEL		2
+#define GC_CAPTURE_FILTER		3
+#define GC_CAPTURE_RING_SIZE	64
+
+/* Time the line stays high after the stop bit before the command is
+ * over. No bit inside a command is high for more than about 3 us.
+ */
+#define GC_CAPTURE_IDLE_NS		5000
+
+/* Response waveform. TIM1 updates once a slot and each update asks
+ * DMA2 stream 5 channel 6 (TIM1_UP) to write the next slot to the TX
+ * pin BSRR.
+ */
+#define GC_WAVE_TIMER			TIM1
+#define GC_WAVE_STREAM			DMA2_Stream5
+#define GC_WAVE_CHANNEL			6
+#define GC_WAVE_SLOT_NS			1000
+
+/* Frames with a waveform of their own, the PROBE response, both
+ * buffers of the ready response and the response packed on demand. In
+ * reader mode the PROBE, PROBE ORIGIN and POLL commands use three.
+ */
+#define GC_WAVE_NUM_OF_FRAMES	4
+
+/* Width of the stop bit sent after a response */
+#define GC_STOP_BIT_WIDTH_NS	1000
+
+/* Baud rate of the GC data lines */
+#define GC_BAUD_RATE			1100000
+
+/* Baud rate of the expansion port telemetry, 100 MHz / 16 / 6.25 */
+#define GC_TELEMETRY_BAUD_RATE	1000000
+
+/* Recording region, the two 128 KB sectors at the end of the flash. The
+ * address comes from the linker script, which keeps the program out of
+ * them once a build refers to it.
+ */
+#define GC_RECORDING_FLASH_ADDRESS		((uint32_t)_srecording)
+#define GC_RECORDING_FIRST_SECTOR		FLASH_SECTOR_6
+#define GC_RECORDING_NUM_OF_SECTORS		2
+
+// Structures //
+#if GC_USE_WAVEFORM_TX
+/* Waveform of a frame and the slot its stop bit was last written at,
+ * 0 if none was
+ */
+typedef struct
+{
+	const uint32_t *frame;
+	uint32_t numOfGCBytes;
+	uint32_t stopSlot;
+	uint32_t slots[GC_WAVEFORM_SLOTS(GC_MAX_RESPONSE_BYTES)];
+} GCPortWaveform_t;
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+/* USART, pins and DMA streams of a console port above 0. These ports
+ * always send and receive with DMA, and have no GC_STOP pin so the
+ * stop bit is sent by the USART as one more UART byte.
+ */
+typedef struct
+{
+	USART_TypeDef *uart;
+	IRQn_Type irq;
+	GPIO_TypeDef *gpioPort;
+	uint32_t pins;
+	uint32_t alternate;
+	DMA_Stream_TypeDef *txStream;
+	DMA_Stream_TypeDef *rxStream;
+	uint32_t channel;
+	volatile uint32_t *txFlagClear;	/* LIFCR or HIFCR of the TX stream */
+	uint32_t txFlags;
+} GCConsoleLine_t;
+
+/* State of a console port above 0 */
+typedef struct
+{
+	UART_HandleTypeDef huart;
+	volatile uint32_t sendInProgress;	/* Set until the stop bit UART byte is out */
+	uint32_t sendingStopBit;
+	uint8_t rxRing[GC_RX_RING_SIZE];
+	uint32_t rxReadIndex;
+} GCConsoleLineState_t;
+#endif
+
+// Variables //
+/* UART for faking 1-wire protocol */
+static UART_HandleTypeDef huart1;
+
+#if GC_USE_RECORDING || GC_USE_REPLAY
+/* Start of the RECORDING region of the linker script */
+extern const uint8_t _srecording[];
+#endif
+
+#if GC_USE_DMA_TX
+/* DMA stream that feeds responses to the UART */
+static DMA_HandleTypeDef hdma_usart1_tx;
+
+/* Set while a response is being sent, cleared after its stop bit */
+static volatile uint32_t gcSendInProgress = 0;
+#endif
+
+#if GC_USE_DMA_RX
+/* DMA stream that fills gcRxRing from the UART without stopping */
+static DMA_HandleTypeDef hdma_usart1_rx;
+
+/* Circular buffer of received UART bytes */
+static uint8_t gcRxRing[GC_RX_RING_SIZE];
+
+/* Next UART byte in gcRxRing to be handed over */
+static uint32_t gcRxReadIndex = 0;
+#endif
+
+#if GC_USE_CAPTURE_RX
+/* Timer count of every edge of the data line, written by DMA */
+static volatile uint16_t gcCaptureRing[GC_CAPTURE_RING_SIZE];
+
+/* Next edge in gcCaptureRing to be decoded */
+static uint32_t gcCaptureReadIndex = 0;
+
+/* Edge decoding and the UART bytes it gave that were not taken yet */
+static GCCaptureRx_t gcCaptureRx;
+static uint8_t gcCaptureBytes[GC_CAPTURE_RX_MAX_IDLE_BYTES];
+static uint32_t gcCaptureByteIndex = 0;
+static uint32_t gcNumOfCaptureBytes = 0;
+
+/* Cycle counter at the last decoded edge, and the cycles without an
+ * edge that end a command
+ */
+static uint32_t gcCaptureEdgeCycles = 0;
+static uint32_t gcCaptureIdleCycles = 0;
+#endif
+
+#if GC_USE_WAVEFORM_TX
+/* Slot patterns of the TX pin and the waveform of every frame */
+static GCWaveform_t gcWaveform;
+static GCPortWaveform_t gcWaveforms[GC_WAVE_NUM_OF_FRAMES];
+#endif
+
+#if GC_USE_TELEMETRY
+/* UART and DMA stream of the expansion port */
+static UART_HandleTypeDef huart6;
+static DMA_HandleTypeDef hdma_usart6_tx;
+#endif
+
+#if GC_USE_DMA_SAMPLING
+/* IDR of each input port, written by DMA every sample period */
+static volatile uint16_t gcInputSamples[NUM_OF_IO_PORTS][GC_SAMPLE_RING_SIZE];
+
+/* Samples per second and CPU cycles per tick of the sample timer */
+static uint32_t gcSampleRate = 0;
+static uint32_t gcSampleCyclesPerTick = 1;
+#endif
+
+#if !GC_USE_TIMER_STOP_BIT
+/* Cycles the stop bit is held low, derived from SystemCoreClock */
+static uint32_t gcStopBitCycles = 0;
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+/* Console ports 1 and 2. DMA1 streams 6 and 5 channel 4 are USART2 TX
+ * and RX, DMA2 streams 6 and 1 channel 5 are USART6 TX and RX.
+ */
+static const GCConsoleLine_t gcConsoleLines[GC_NUM_OF_CONSOLE_PORTS - 1] =
+{
+	{
+		GC_PORT1_UART, USART2_IRQn, GC_PORT1_PORT, GC_PORT1_TX_PIN_HAL | GC_PORT1_RX_PIN_HAL, GC_PORT1_UART_AF,
+		DMA1_Stream6, DMA1_Stream5, DMA_CHANNEL_4, &DMA1->HIFCR,
+		DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6
+	},
+#if GC_NUM_OF_CONSOLE_PORTS > 2
+	{
+		GC_PORT2_UART, USART6_IRQn, GC_PORT2_PORT, GC_PORT2_TX_PIN_HAL | GC_PORT2_RX_PIN_HAL, GC_PORT2_UART_AF,
+		DMA2_Stream6, DMA2_Stream1, DMA_CHANNEL_5, &DMA2->HIFCR,
+		DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6
+	}
+#endif
+};
+
+static GCConsoleLineState_t gcConsoleLineStates[GC_NUM_OF_CONSOLE_PORTS - 1];
+#endif
+
+// Function Prototypes //
+/* Sends a stop bit to indicate end of GC data transmission */
+inline static void GCPort_SendStopBit(void);
+
+/* Packs inverted port reads, indexed by IO_PORT_INDEX, into an input word */
+inline static uint32_t GCPort_PackInputs(const uint32_t *);
+
+#if GC_USE_DMA_SAMPLING
+/* Sets up a DMA stream to copy a port IDR to its sample ring forever */
+static void GCPort_InitSampleStream(DMA_Stream_TypeDef *, GPIO_TypeDef *, volatile uint16_t *);
+#endif
+
+#if GC_USE_DMA_RX
+/* Gets where the DMA stream of a receive ring writes next */
+inline static uint32_t GCPort_GetRxWriteIndex(DMA_Stream_TypeDef *);
+
+/* Hands what DMA received in the ring of a console port since last time
+ * to the emulation
+ */
+inline static void GCPort_ProcessRxRing(uint32_t, DMA_Stream_TypeDef *, const uint8_t *, uint32_t *);
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+/* Sets up the USART and DMA streams of a console port above 0 */
+static void GCPort_InitConsoleLine(uint32_t);
+
+/* USART interrupt of a console port above 0 */
+static void GCPort_ServiceConsoleLine(uint32_t);
+#endif
+
+#if GC_USE_CAPTURE_RX
+/* Decodes captured edges until a UART byte is ready, returns 1 if one is */
+static uint32_t GCPort_ProcessCaptureRing(void);
+#endif
+
+#if GC_USE_WAVEFORM_TX
+/* Finds the waveform of a frame, or a free one if it has none */
+static GCPortWaveform_t *GCPort_FindWaveform(const uint32_t *);
+
+/* Renders the given number of GC bytes of a frame into a waveform */
+static void GCPort_RenderWaveform(GCPortWaveform_t *, const uint32_t *, uint32_t);
+#endif
+
+#if GC_USE_INPUT_EDGES
+/* Clears the given EXTI lines and captures all inputs */
+inline static void GCPort_CaptureInputs(uint32_t);
+#endif
+
+// Function Implementations //
+/* Initializes the GC data line and the buttons of the GC Anti-Pad Hack Board */
+void GCPort_Init()
+{
+	/* Setup GC communication */
+	// Clocks
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+	__HAL_RCC_USART1_CLK_ENABLE();
+
+	// Init structure
+	GPIO_InitTypeDef GPIO_InitStruct_GCPort = {0};
+
+	// Stop bit control
+#if GC_USE_WAVEFORM_TX
+	/* The stop bit is part of the response waveform, GC_STOP is not used */
+#elif GC_USE_TIMER_STOP_BIT
+	/* The timer runs in one pulse mode with PWM mode 2 and an inverted
+	 * output. Stopped, the pin is high. Once started, it goes low after
+	 * one tick, stays low until the counter reaches ARR, and then the
+	 * timer stops itself with the pin high again.
+	 */
+	__HAL_RCC_TIM3_CLK_ENABLE();
+	uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+	if(RCC->CFGR & RCC_CFGR_PPRE1_2)
+	{
+		// Timers run twice as fast as a divided APB1
+		timerClock *= 2;
+	}
+	uint32_t stopBitTicks = (uint32_t)(((uint64_t)timerClock * GC_STOP_BIT_WIDTH_NS) / 1000000000UL);
+
+	GC_STOP_TIMER->CR1 = TIM_CR1_OPM;
+	GC_STOP_TIMER->PSC = 0;
+	GC_STOP_TIMER->ARR = stopBitTicks;
+	GC_STOP_TIMER->CCR2 = 1;
+	GC_STOP_TIMER->CCMR1 = TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2M_0;
+	GC_STOP_TIMER->CCER = TIM_CCER_CC2P | TIM_CCER_CC2E;
+	GC_STOP_TIMER->EGR = TIM_EGR_UG;
+	GC_STOP_TIMER->SR = 0;
+
+	GPIO_InitStruct_GCPort.Pin = GC_STOP_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_AF_OD;
+	GPIO_InitStruct_GCPort.Alternate = GC_STOP_TIMER_AF;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(GC_STOP_PORT, &GPIO_InitStruct_GCPort);
+#else
+	gcStopBitCycles = (uint32_t)(((uint64_t)SystemCoreClock * GC_STOP_BIT_WIDTH_NS) / 1000000000UL);
+
+	GPIO_InitStruct_GCPort.Pin = GC_STOP_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(GC_STOP_PORT, &GPIO_InitStruct_GCPort);
+	GC_STOP_PORT->BSRR = GC_STOP_SET;
+#endif
+
+	// USART1 TX/RX, either can be replaced
+#if !(GC_USE_CAPTURE_RX && GC_USE_WAVEFORM_TX)
+#if GC_USE_CAPTURE_RX
+	GPIO_InitStruct_GCPort.Pin = GC_TX_PIN_HAL;
+#elif GC_USE_WAVEFORM_TX
+	GPIO_InitStruct_GCPort.Pin = GC_RX_PIN_HAL;
+#else
+	GPIO_InitStruct_GCPort.Pin = GC_TX_PIN_HAL | GC_RX_PIN_HAL;
+#endif
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_AF_OD;
+	GPIO_InitStruct_GCPort.Alternate = GPIO_AF7_USART1;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(GC_TX_PORT, &GPIO_InitStruct_GCPort);
+
+	// Configure USART1
+	huart1.Instance = USART1;
+	huart1.Init.BaudRate = GC_BAUD_RATE; // 1100000 works
+	huart1.Init.WordLength = UART_WORDLENGTH_8B;
+	huart1.Init.StopBits = UART_STOPBITS_1;
+	huart1.Init.Parity = UART_PARITY_NONE;
+#if GC_USE_CAPTURE_RX
+	huart1.Init.Mode = UART_MODE_TX;
+#elif GC_USE_WAVEFORM_TX
+	huart1.Init.Mode = UART_MODE_RX;
+#else
+	huart1.Init.Mode = UART_MODE_TX_RX;
+#endif
+	huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+	huart1.Init.OverSampling = UART_OVERSAMPLING_8;
+	HAL_UART_Init(&huart1);
+#endif
+
+#if GC_USE_DMA_TX
+	// DMA2 stream 7 channel 4 is USART1 TX
+	__HAL_RCC_DMA2_CLK_ENABLE();
+	hdma_usart1_tx.Instance = DMA2_Stream7;
+	hdma_usart1_tx.Init.Channel = DMA_CHANNEL_4;
+	hdma_usart1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_usart1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_usart1_tx.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_usart1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma_usart1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma_usart1_tx.Init.Mode = DMA_NORMAL;
+	hdma_usart1_tx.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	hdma_usart1_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	HAL_DMA_Init(&hdma_usart1_tx);
+	DMA2_Stream7->PAR = (uint32_t)&USART1->DR;
+	USART1->CR3 |= USART_CR3_DMAT;
+
+	// Stop bit is sent from the transmission complete interrupt
+	HAL_NVIC_SetPriority(USART1_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(USART1_IRQn);
+#endif
+
+	// Cycle counter used to time stamp sampled inputs
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	/* Setup buttons */
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+	__HAL_RCC_GPIOC_CLK_ENABLE();
+
+	// A Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_A_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_A_PORT, &GPIO_InitStruct_GCPort);
+
+	// B Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_B_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_B_PORT, &GPIO_InitStruct_GCPort);
+
+	// X Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_X_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_X_PORT, &GPIO_InitStruct_GCPort);
+
+	// Y Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_Y_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_Y_PORT, &GPIO_InitStruct_GCPort);
+
+	// L Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_L_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_L_PORT, &GPIO_InitStruct_GCPort);
+
+	// R Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_R_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_R_PORT, &GPIO_InitStruct_GCPort);
+
+	// Z Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_Z_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_Z_PORT, &GPIO_InitStruct_GCPort);
+
+	// START Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_START_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_START_PORT, &GPIO_InitStruct_GCPort);
+
+	// DU Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_DU_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_DU_PORT, &GPIO_InitStruct_GCPort);
+
+	// DD Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_DD_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_DD_PORT, &GPIO_InitStruct_GCPort);
+
+	// DL Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_DL_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_DL_PORT, &GPIO_InitStruct_GCPort);
+
+	// DR Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_DR_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_DR_PORT, &GPIO_InitStruct_GCPort);
+
+	// LSU Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_LSU_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_LSU_PORT, &GPIO_InitStruct_GCPort);
+
+	// LSD Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_LSD_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_LSD_PORT, &GPIO_InitStruct_GCPort);
+
+	// LSL Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_LSL_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_LSL_PORT, &GPIO_InitStruct_GCPort);
+
+	// LSR Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_LSR_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_LSR_PORT, &GPIO_InitStruct_GCPort);
+
+	// CU Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_CU_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_CU_PORT, &GPIO_InitStruct_GCPort);
+
+	// CD Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_CD_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_CD_PORT, &GPIO_InitStruct_GCPort);
+
+	// CL Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_CL_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_CL_PORT, &GPIO_InitStruct_GCPort);
+
+	// CR Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_CR_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_CR_PORT, &GPIO_InitStruct_GCPort);
+
+	// MACRO Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_MACRO_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_MACRO_PORT, &GPIO_InitStruct_GCPort);
+
+	// TILT Button
+	GPIO_InitStruct_GCPort.Pin = BUTTON_TILT_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct_GCPort.Pull = GPIO_PULLUP;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(BUTTON_TILT_PORT, &GPIO_InitStruct_GCPort);
+
+#if GC_USE_INPUT_EDGES
+	/* Both edges of every routed button raise an interrupt. The pins stay
+	 * inputs with pull ups, only the EXTI lines are set up here.
+	 */
+	__HAL_RCC_SYSCFG_CLK_ENABLE();
+	GC_INPUT_EXTI_TABLE(GC_INPUT_EXTI_ROUTE)
+	EXTI->RTSR |= GC_INPUT_EXTI_LINES;
+	EXTI->FTSR |= GC_INPUT_EXTI_LINES;
+	EXTI->PR = GC_INPUT_EXTI_LINES;
+	EXTI->IMR |= GC_INPUT_EXTI_LINES;
+
+	HAL_NVIC_SetPriority(EXTI0_IRQn, GC_INPUT_EXTI_PRIORITY, 0);
+	HAL_NVIC_SetPriority(EXTI1_IRQn, GC_INPUT_EXTI_PRIORITY, 0);
+	HAL_NVIC_SetPriority(EXTI3_IRQn, GC_INPUT_EXTI_PRIORITY, 0);
+	HAL_NVIC_SetPriority(EXTI4_IRQn, GC_INPUT_EXTI_PRIORITY, 0);
+	HAL_NVIC_SetPriority(EXTI9_5_IRQn, GC_INPUT_EXTI_PRIORITY, 0);
+	HAL_NVIC_SetPriority(EXTI15_10_IRQn, GC_INPUT_EXTI_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+	HAL_NVIC_EnableIRQ(EXTI1_IRQn);
+	HAL_NVIC_EnableIRQ(EXTI3_IRQn);
+	HAL_NVIC_EnableIRQ(EXTI4_IRQn);
+	HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+	HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+#endif
+
+#if GC_USE_DMA_SAMPLING
+	/* TIM1 runs from APB2. Its period is the sample period, with a
+	 * prescaler only if that does not fit 16 bits.
+	 */
+	__HAL_RCC_TIM1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+	uint32_t sampleClock = HAL_RCC_GetPCLK2Freq();
+	if(RCC->CFGR & RCC_CFGR_PPRE2_2)
+	{
+		// Timers run twice as fast as a divided APB2
+		sampleClock *= 2;
+	}
+	uint32_t sampleTicks = sampleClock / GC_SAMPLE_RATE_HZ;
+	uint32_t samplePrescaler = (sampleTicks - 1) / 65536;
+	sampleTicks /= (samplePrescaler + 1);
+	gcSampleRate = sampleClock / ((samplePrescaler + 1) * sampleTicks);
+	gcSampleCyclesPerTick = (SystemCoreClock / sampleClock) * (samplePrescaler + 1);
+
+	GCPort_InitSampleStream(GC_SAMPLE_STREAM_A, GPIOA, gcInputSamples[IO_PORT_INDEX_A]);
+	GCPort_InitSampleStream(GC_SAMPLE_STREAM_B, GPIOB, gcInputSamples[IO_PORT_INDEX_B]);
+	GCPort_InitSampleStream(GC_SAMPLE_STREAM_C, GPIOC, gcInputSamples[IO_PORT_INDEX_C]);
+
+	/* Compare channels are frozen, they only ask for DMA. The update
+	 * event loads the prescaler before any request is enabled.
+	 */
+	GC_SAMPLE_TIMER->CR1 = 0;
+	GC_SAMPLE_TIMER->PSC = samplePrescaler;
+	GC_SAMPLE_TIMER->ARR = sampleTicks - 1;
+	GC_SAMPLE_TIMER->CCMR1 = 0;
+	GC_SAMPLE_TIMER->CCMR2 = 0;
+	GC_SAMPLE_TIMER->CCR1 = GC_SAMPLE_PORT_B_TICKS;
+	GC_SAMPLE_TIMER->CCR4 = GC_SAMPLE_PORT_C_TICKS;
+	GC_SAMPLE_TIMER->EGR = TIM_EGR_UG;
+	GC_SAMPLE_TIMER->SR = 0;
+	GC_SAMPLE_TIMER->DIER = TIM_DIER_UDE | TIM_DIER_CC1DE | TIM_DIER_CC4DE;
+	GC_SAMPLE_TIMER->CR1 = TIM_CR1_CEN;
+#endif
+
+#if GC_USE_DMA_RX
+	/* DMA2 stream 2 channel 4 is USART1 RX. Nothing is received until
+	 * GCPort_StartReceiving is called.
+	 */
+	__HAL_RCC_DMA2_CLK_ENABLE();
+	hdma_usart1_rx.Instance = DMA2_Stream2;
+	hdma_usart1_rx.Init.Channel = DMA_CHANNEL_4;
+	hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
+	hdma_usart1_rx.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	hdma_usart1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	HAL_DMA_Init(&hdma_usart1_rx);
+	DMA2_Stream2->PAR = (uint32_t)&USART1->DR;
+	DMA2_Stream2->M0AR = (uint32_t)gcRxRing;
+	DMA2_Stream2->NDTR = GC_RX_RING_SIZE;
+	DMA2_Stream2->CR |= DMA_SxCR_EN;
+
+	// Commands end with an idle line, errors are counted
+	USART1->CR3 |= USART_CR3_DMAR | USART_CR3_EIE;
+	USART1->CR1 |= USART_CR1_IDLEIE;
+	HAL_NVIC_SetPriority(USART1_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(USART1_IRQn);
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	/* The other console ports, USART2 on port A and USART6 on the
+	 * expansion port
+	 */
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_USART2_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+#if GC_NUM_OF_CONSOLE_PORTS > 2
+	__HAL_RCC_GPIOC_CLK_ENABLE();
+	__HAL_RCC_USART6_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+#endif
+	for(uint32_t consolePort = 1; consolePort < GC_NUM_OF_CONSOLE_PORTS; consolePort++)
+	{
+		GCPort_InitConsoleLine(consolePort);
+	}
+#endif
+
+#if GC_USE_CAPTURE_RX
+	/* The data line is received by TIM4 channel 2 instead of USART1 */
+	__HAL_RCC_TIM4_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	GPIO_InitStruct_GCPort.Pin = GC_RX_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_AF_OD;
+	GPIO_InitStruct_GCPort.Alternate = GC_RX_TIMER_AF;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(GC_RX_PORT, &GPIO_InitStruct_GCPort);
+
+	/* Half words from the capture register to the ring, wrapping around
+	 * forever at the same priority as the other GC data line streams
+	 */
+	GC_CAPTURE_STREAM->CR = 0;
+	while(GC_CAPTURE_STREAM->CR & DMA_SxCR_EN){};
+	GC_CAPTURE_STREAM->PAR = (uint32_t)&GC_RX_TIMER->CCR2;
+	GC_CAPTURE_STREAM->M0AR = (uint32_t)gcCaptureRing;
+	GC_CAPTURE_STREAM->NDTR = GC_CAPTURE_RING_SIZE;
+	GC_CAPTURE_STREAM->FCR = 0;
+	GC_CAPTURE_STREAM->CR = (GC_CAPTURE_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | DMA_SxCR_PL_0 |
+							DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+	GC_CAPTURE_STREAM->CR |= DMA_SxCR_EN;
+
+	/* The counter runs freely at the timer clock. Channel 2 captures
+	 * both edges of TI2 and asks for DMA every time, but stays disabled
+	 * until GCPort_StartReceiving is called.
+	 */
+	GC_RX_TIMER->CR1 = 0;
+	GC_RX_TIMER->PSC = 0;
+	GC_RX_TIMER->ARR = 0xFFFF;
+	GC_RX_TIMER->CCMR1 = TIM_CCMR1_CC2S_0 | (GC_CAPTURE_FILTER << TIM_CCMR1_IC2F_Pos);
+	GC_RX_TIMER->CCER = TIM_CCER_CC2P | TIM_CCER_CC2NP;
+	GC_RX_TIMER->EGR = TIM_EGR_UG;
+	GC_RX_TIMER->SR = 0;
+	GC_RX_TIMER->DIER = TIM_DIER_CC2DE;
+	GC_RX_TIMER->CR1 = TIM_CR1_CEN;
+
+	gcCaptureIdleCycles = (uint32_t)(((uint64_t)SystemCoreClock * GC_CAPTURE_IDLE_NS) / 1000000000UL);
+#endif
+
+#if GC_USE_WAVEFORM_TX
+	/* The TX pin is an open drain output, released until DMA writes the
+	 * first slot of a response to its BSRR
+	 */
+	__HAL_RCC_TIM1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	GC_TX_PORT->BSRR = GC_TX_BIT;
+	GPIO_InitStruct_GCPort.Pin = GC_TX_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(GC_TX_PORT, &GPIO_InitStruct_GCPort);
+
+	GCWaveform_Init(&gcWaveform, (uint32_t)GC_TX_BIT << 16, (uint32_t)GC_TX_BIT);
+
+	/* Words from a waveform to BSRR, one per request */
+	GC_WAVE_STREAM->CR = 0;
+	while(GC_WAVE_STREAM->CR & DMA_SxCR_EN){};
+	GC_WAVE_STREAM->PAR = (uint32_t)&GC_TX_PORT->BSRR;
+	GC_WAVE_STREAM->FCR = 0;
+	GC_WAVE_STREAM->CR = (GC_WAVE_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | DMA_SxCR_PL_0 |
+						 DMA_SxCR_MSIZE_1 | DMA_SxCR_PSIZE_1 | DMA_SxCR_MINC | DMA_SxCR_DIR_0;
+
+#if GC_USE_DMA_RX
+	/* Receiving starts again from the transfer complete interrupt, once
+	 * the last slot of the stop bit is written, so nothing waits for the
+	 * response in the USART interrupt
+	 */
+	GC_WAVE_STREAM->CR |= DMA_SxCR_TCIE;
+	HAL_NVIC_SetPriority(DMA2_Stream5_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+#endif
+
+	/* TIM1 runs from APB2 and updates once a slot. Its DMA request is
+	 * only enabled while a response is sent.
+	 */
+	uint32_t waveClock = HAL_RCC_GetPCLK2Freq();
+	if(RCC->CFGR & RCC_CFGR_PPRE2_2)
+	{
+		// Timers run twice as fast as a divided APB2
+		waveClock *= 2;
+	}
+	GC_WAVE_TIMER->CR1 = 0;
+	GC_WAVE_TIMER->PSC = 0;
+	GC_WAVE_TIMER->ARR = (uint32_t)(((uint64_t)waveClock * GC_WAVE_SLOT_NS) / 1000000000UL) - 1;
+	GC_WAVE_TIMER->EGR = TIM_EGR_UG;
+	GC_WAVE_TIMER->SR = 0;
+	GC_WAVE_TIMER->DIER = 0;
+	GC_WAVE_TIMER->CR1 = TIM_CR1_CEN;
+#endif
+
+#if GC_USE_TELEMETRY
+	/* Setup expansion port telemetry, only TX is used */
+	__HAL_RCC_USART6_CLK_ENABLE();
+
+	GPIO_InitStruct_GCPort.Pin = COMMS_TX_PIN_HAL;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct_GCPort.Alternate = COMMS_UART_AF;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(COMMS_TX_PORT, &GPIO_InitStruct_GCPort);
+
+	huart6.Instance = COMMS_UART;
+	huart6.Init.BaudRate = GC_TELEMETRY_BAUD_RATE;
+	huart6.Init.WordLength = UART_WORDLENGTH_8B;
+	huart6.Init.StopBits = UART_STOPBITS_1;
+	huart6.Init.Parity = UART_PARITY_NONE;
+	huart6.Init.Mode = UART_MODE_TX;
+	huart6.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+	huart6.Init.OverSampling = UART_OVERSAMPLING_16;
+	HAL_UART_Init(&huart6);
+
+	/* DMA2 stream 6 channel 5 is USART6 TX. It has the lowest priority
+	 * so it never holds up the GC data line streams.
+	 */
+	__HAL_RCC_DMA2_CLK_ENABLE();
+	hdma_usart6_tx.Instance = DMA2_Stream6;
+	hdma_usart6_tx.Init.Channel = DMA_CHANNEL_5;
+	hdma_usart6_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_usart6_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_usart6_tx.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_usart6_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma_usart6_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma_usart6_tx.Init.Mode = DMA_NORMAL;
+	hdma_usart6_tx.Init.Priority = DMA_PRIORITY_LOW;
+	hdma_usart6_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	HAL_DMA_Init(&hdma_usart6_tx);
+	DMA2_Stream6->PAR = (uint32_t)&COMMS_UART->DR;
+	COMMS_UART->CR3 |= USART_CR3_DMAT;
+#endif
+}
+
+/* Gets all inputs from GC Anti-Pad Hack Board. Each port is read
+ * only once so every button is sampled at the same instant.
+ */
+uint32_t GCPort_ReadInputs()
+{
+	/* Read all ports back to back. Inputs are pulled up so a low pin
+	 * is a pushed button, invert so a set bit means PUSHED.
+	 */
+	uint32_t pushedPins[NUM_OF_IO_PORTS];
+	pushedPins[IO_PORT_INDEX_A] = ~GPIOA->IDR;
+	pushedPins[IO_PORT_INDEX_B] = ~GPIOB->IDR;
+	pushedPins[IO_PORT_INDEX_C] = ~GPIOC->IDR;
+
+	return GCPort_PackInputs(pushedPins);
+}
+
+uint32_t GCPort_PackInputs(const uint32_t *pushedPins)
+{
+	/* Pack every button into its bit */
+	return GC_INPUT_PIN_TABLE(GC_INPUT_PIN_TO_BIT) 0;
+}
+
+void GCPort_ReadInputWindow(uint32_t numOfSamples, GCInputWindow_t *window)
+{
+#if GC_USE_DMA_SAMPLING
+	uint32_t remaining, ticks, cycles;
+
+	/* Port C is copied last, so once its sample is in the whole period
+	 * is. Wait out the few ticks the ports are being copied, and read
+	 * again if a new period started between the two reads.
+	 */
+	do
+	{
+		remaining = GC_SAMPLE_STREAM_C->NDTR;
+		ticks = GC_SAMPLE_TIMER->CNT;
+		cycles = DWT->CYCCNT;
+	} while(ticks < GC_SAMPLE_SETTLED_TICKS);
+
+	uint32_t newest = (GC_SAMPLE_RING_SIZE * 2 - remaining - 1) & (GC_SAMPLE_RING_SIZE - 1);
+	if(numOfSamples > GC_MAX_SAMPLE_WINDOW)
+	{
+		numOfSamples = GC_MAX_SAMPLE_WINDOW;
+	}
+
+	/* Inputs are pulled up, so a pin that never read high was pushed in
+	 * every sample and one that ever read low was pushed in at least one
+	 */
+	uint32_t anyHigh[NUM_OF_IO_PORTS] = {0};
+	uint32_t allHigh[NUM_OF_IO_PORTS] = {0xFFFF, 0xFFFF, 0xFFFF};
+	for(uint32_t i = 0; i < numOfSamples; i++)
+	{
+		uint32_t slot = (newest - i) & (GC_SAMPLE_RING_SIZE - 1);
+		for(uint32_t port = 0; port < NUM_OF_IO_PORTS; port++)
+		{
+			anyHigh[port] |= gcInputSamples[port][slot];
+			allHigh[port] &= gcInputSamples[port][slot];
+		}
+	}
+
+	uint32_t pushedPins[NUM_OF_IO_PORTS];
+	for(uint32_t port = 0; port < NUM_OF_IO_PORTS; port++)
+	{
+		pushedPins[port] = ~anyHigh[port];
+	}
+	window->allPushed = GCPort_PackInputs(pushedPins);
+	for(uint32_t port = 0; port < NUM_OF_IO_PORTS; port++)
+	{
+		pushedPins[port] = ~allHigh[port];
+	}
+	window->anyPushed = GCPort_PackInputs(pushedPins);
+
+	// The newest period started with the port A copy
+	window->sampleTime = cycles - (ticks * gcSampleCyclesPerTick);
+#else
+	// Without background samples the pins are the only sample
+	window->allPushed = GCPort_ReadInputs();
+	window->anyPushed = window->allPushed;
+	window->sampleTime = DWT->CYCCNT;
+	(void)numOfSamples;
+#endif
+}
+
+uint32_t GCPort_GetInputSampleRate()
+{
+#if GC_USE_DMA_SAMPLING
+	return gcSampleRate;
+#else
+	return 0;
+#endif
+}
+
+uint32_t GCPort_GetCycles()
+{
+	return DWT->CYCCNT;
+}
+
+void GCPort_WaitForCycles(uint32_t cycles)
+{
+	while((int32_t)(DWT->CYCCNT - cycles) < 0){};
+}
+
+uint32_t GCPort_LockInputs()
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+void GCPort_UnlockInputs(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+void GCPort_StartReceiving(uint32_t consolePort)
+{
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	if(consolePort != 0)
+	{
+		// The TC interrupt starts receiving after the stop bit
+		GCConsoleLineState_t *state = &gcConsoleLineStates[consolePort - 1];
+		if(state->sendInProgress)
+		{
+			return;
+		}
+
+		state->rxReadIndex = GCPort_GetRxWriteIndex(gcConsoleLines[consolePort - 1].rxStream);
+		gcConsoleLines[consolePort - 1].uart->CR1 |= USART_CR1_RE;
+		return;
+	}
+#else
+	(void)consolePort;
+#endif
+
+#if GC_USE_DMA_TX
+	// A response is still going out, the TC interrupt starts receiving after its stop bit
+	if(gcSendInProgress)
+	{
+		return;
+	}
+#endif
+
+#if GC_USE_WAVEFORM_TX && GC_USE_DMA_RX
+	// A response is still going out, the transfer complete interrupt starts receiving after its stop bit
+	if(GC_WAVE_STREAM->CR & DMA_SxCR_EN)
+	{
+		return;
+	}
+#elif GC_USE_WAVEFORM_TX
+	// Do not receive our own response, the stream clears EN once it is done
+	while(GC_WAVE_STREAM->CR & DMA_SxCR_EN){};
+#elif GC_USE_TIMER_STOP_BIT
+	// Do not receive our own stop bit, the timer clears CEN once it is done
+	while(GC_STOP_TIMER->CR1 & TIM_CR1_CEN){};
+#endif
+
+#if GC_USE_DMA_RX
+	/* Whatever was received while not listening is skipped */
+	gcRxReadIndex = GCPort_GetRxWriteIndex(DMA2_Stream2);
+#endif
+
+#if GC_USE_CAPTURE_RX
+	/* Edges captured before, like those of our own response, are skipped */
+	gcCaptureReadIndex = GC_CAPTURE_RING_SIZE - GC_CAPTURE_STREAM->NDTR;
+	if(gcCaptureReadIndex == GC_CAPTURE_RING_SIZE)
+	{
+		gcCaptureReadIndex = 0;
+	}
+	GCCaptureRx_Reset(&gcCaptureRx);
+	gcCaptureByteIndex = 0;
+	gcNumOfCaptureBytes = 0;
+	gcCaptureEdgeCycles = DWT->CYCCNT;
+
+	// Enable the capture
+	GC_RX_TIMER->CCER |= TIM_CCER_CC2E;
+#else
+	// Enable the UART receiver
+	USART1->CR1 |= USART_CR1_RE;
+#endif
+}
+
+void GCPort_StopReceiving(uint32_t consolePort)
+{
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	if(consolePort != 0)
+	{
+		gcConsoleLines[consolePort - 1].uart->CR1 &= ~USART_CR1_RE;
+		return;
+	}
+#else
+	(void)consolePort;
+#endif
+
+#if GC_USE_CAPTURE_RX
+	// Disable the capture
+	GC_RX_TIMER->CCER &= ~TIM_CCER_CC2E;
+#else
+	// Disable the receiver
+	USART1->CR1 &= ~USART_CR1_RE;
+#endif
+}
+
+uint32_t GCPort_IsByteReceived(uint32_t consolePort)
+{
+	// Only console port 0 is received without GC_USE_DMA_RX
+	(void)consolePort;
+
+#if GC_USE_CAPTURE_RX
+	return GCPort_ProcessCaptureRing();
+#else
+	return (USART1->SR & USART_SR_RXNE) ? 1 : 0;
+#endif
+}
+
+uint8_t GCPort_ReceiveByte(uint32_t consolePort)
+{
+	(void)consolePort;
+
+#if GC_USE_CAPTURE_RX
+	// Decode edges until the next UART byte is ready
+	while(!GCPort_ProcessCaptureRing()){};
+	return gcCaptureBytes[gcCaptureByteIndex++];
+#else
+	// Make sure the receive data register is not empty before receiving next byte
+	uint32_t status;
+	while(!((status = USART1->SR) & USART_SR_RXNE)){};
+
+	/* Reading DR clears the error flags as well. A byte lost to an
+	 * overrun misframes the command, so it must not be performed.
+	 */
+	if(status & (USART_SR_FE | USART_SR_ORE | USART_SR_NE))
+	{
+		GCControllerEmulation_ReceiveErrors(0, (status & USART_SR_FE) ? 1 : 0,
+											(status & USART_SR_ORE) ? 1 : 0,
+											(status & USART_SR_NE) ? 1 : 0);
+	}
+	return (uint8_t)USART1->DR;
+#endif
+}
+
+uint32_t GCPort_IsBusy(uint32_t consolePort)
+{
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	if(consolePort != 0)
+	{
+		return gcConsoleLineStates[consolePort - 1].sendInProgress;
+	}
+#else
+	(void)consolePort;
+#endif
+
+#if GC_USE_DMA_TX
+	// The line is ours until the stop bit of the last response is sent
+	if(gcSendInProgress)
+	{
+		return 1;
+	}
+#endif
+
+#if GC_USE_WAVEFORM_TX
+	// The stream clears EN once the last slot, the end of the stop bit, is written
+	if(GC_WAVE_STREAM->CR & DMA_SxCR_EN)
+	{
+		return 1;
+	}
+#elif GC_USE_TIMER_STOP_BIT
+	// The timer clears CEN once the stop bit is done
+	if(GC_STOP_TIMER->CR1 & TIM_CR1_CEN)
+	{
+		return 1;
+	}
+#endif
+
+	return 0;
+}
+
+void GCPort_SendStopBit()
+{
+	/* The timing of the stop bit does not need to be so precise, but
+	 * it is GC_STOP_BIT_WIDTH_NS at any clock configuration.
+	 */
+	GC_PROFILE_START(GC_PROFILE_STOP_BIT);
+#if GC_USE_TIMER_STOP_BIT
+	// The timer makes the whole pulse and stops by itself
+	GC_STOP_TIMER->CR1 |= TIM_CR1_CEN;
+#else
+	uint32_t start = DWT->CYCCNT;
+	GC_STOP_PORT->BSRR = GC_STOP_CLEAR;
+	while((DWT->CYCCNT - start) < gcStopBitCycles){};
+	GC_STOP_PORT->BSRR = GC_STOP_SET;
+#endif
+	GC_PROFILE_END(GC_PROFILE_STOP_BIT);
+}
+
+void GCPort_PrepareFrame(uint32_t consolePort, const uint32_t *frame, uint32_t numOfGCBytes)
+{
+	// Only console port 0 can send a waveform
+	(void)consolePort;
+
+#if GC_USE_WAVEFORM_TX
+	GCPort_RenderWaveform(GCPort_FindWaveform(frame), frame, numOfGCBytes);
+#else
+	// The UART sends the frame as it is
+	(void)frame;
+	(void)numOfGCBytes;
+#endif
+}
+
+void GCPort_SendFrame(uint32_t consolePort, const uint32_t *frame, uint32_t numOfGCBytes)
+{
+	GC_PROFILE_END(GC_PROFILE_TURNAROUND);
+	GC_PROFILE_START(GC_PROFILE_TX);
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+	if(consolePort != 0)
+	{
+		/* Same as USART1 with GC_USE_DMA_TX, the TC interrupt then sends
+		 * the stop bit UART byte
+		 */
+		const GCConsoleLine_t *line = &gcConsoleLines[consolePort - 1];
+		gcConsoleLineStates[consolePort - 1].sendInProgress = 1;
+		*line->txFlagClear = line->txFlags;
+		line->txStream->M0AR = (uint32_t)frame;
+		line->txStream->NDTR = numOfGCBytes * GC_UART_BYTES_PER_GC_BYTE;
+		line->uart->SR = ~(uint32_t)USART_SR_TC;
+		line->txStream->CR |= DMA_SxCR_EN;
+		line->uart->CR1 |= USART_CR1_TCIE;
+		return;
+	}
+#else
+	(void)consolePort;
+#endif
+#if GC_USE_WAVEFORM_TX
+	/* The slots were rendered when the frame was prepared, only its stop
+	 * bit has to be written since a POLL sends fewer GC bytes than a
+	 * PROBE ORIGIN from the same frame
+	 */
+	GCPortWaveform_t *waveform = GCPort_FindWaveform(frame);
+	if( (waveform->frame != frame) || (numOfGCBytes > waveform->numOfGCBytes) )
+	{
+		GCPort_RenderWaveform(waveform, frame, numOfGCBytes);
+	}
+
+	uint32_t stopSlot = numOfGCBytes * GC_WAVEFORM_SLOTS_PER_GC_BYTE;
+	if( (waveform->stopSlot != stopSlot) &&
+		(waveform->stopSlot < (waveform->numOfGCBytes * GC_WAVEFORM_SLOTS_PER_GC_BYTE)) && (waveform->stopSlot != 0) )
+	{
+		// Put back the GC byte an earlier stop bit was written over
+		uint32_t gcByte = waveform->stopSlot / GC_WAVEFORM_SLOTS_PER_GC_BYTE;
+		GCWaveform_Render(&gcWaveform, &frame[gcByte], 1, &waveform->slots[waveform->stopSlot]);
+	}
+	GCWaveform_StopBit(&gcWaveform, &waveform->slots[stopSlot]);
+	waveform->stopSlot = stopSlot;
+
+	/* The request is off while the stream is set up, so nothing left over
+	 * from the last response goes first. The forced update then writes the
+	 * first slot at once and every update after it the next one.
+	 */
+	GC_WAVE_TIMER->DIER = 0;
+	DMA2->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+	GC_WAVE_STREAM->M0AR = (uint32_t)waveform->slots;
+	GC_WAVE_STREAM->NDTR = GC_WAVEFORM_SLOTS(numOfGCBytes);
+	GC_WAVE_STREAM->CR |= DMA_SxCR_EN;
+	GC_WAVE_TIMER->DIER = TIM_DIER_UDE;
+	GC_WAVE_TIMER->EGR = TIM_EGR_UG;
+	GC_PROFILE_END(GC_PROFILE_TX);
+#elif GC_USE_DMA_TX
+	/* Hand the whole frame to DMA. The UART raises TC once the last byte
+	 * is out and the interrupt sends the stop bit, so nothing here waits.
+	 */
+	gcSendInProgress = 1;
+	DMA2->HIFCR = DMA_HIFCR_CTCIF7 | DMA_HIFCR_CHTIF7 | DMA_HIFCR_CTEIF7 | DMA_HIFCR_CDMEIF7 | DMA_HIFCR_CFEIF7;
+	DMA2_Stream7->M0AR = (uint32_t)frame;
+	DMA2_Stream7->NDTR = numOfGCBytes * GC_UART_BYTES_PER_GC_BYTE;
+	USART1->SR = ~(uint32_t)USART_SR_TC;
+	DMA2_Stream7->CR |= DMA_SxCR_EN;
+	USART1->CR1 |= USART_CR1_TCIE;
+#else
+	const uint8_t *uartBytes = (const uint8_t *)frame;
+	uint32_t numOfUartBytes = numOfGCBytes * GC_UART_BYTES_PER_GC_BYTE;
+
+	for(uint32_t i = 0; i < numOfUartBytes; i++)
+	{
+		// Make sure the transmit data register is empty before sending next byte
+		while(!(USART1->SR & USART_SR_TXE)){};
+		USART1->DR = uartBytes[i];
+	}
+
+	/* Stop bit to console */
+	// Make sure the last UART byte transmission is complete before sending stop bit
+	while(!(USART1->SR & USART_SR_TC)){};
+	GC_PROFILE_END(GC_PROFILE_TX);
+	GCPort_SendStopBit();
+#endif
+}
+
+#if GC_USE_TELEMETRY
+void GCPort_SendTelemetry(const uint8_t *bytes, uint32_t numOfBytes)
+{
+	/* No interrupt is needed, the stream disables itself once the last
+	 * byte is handed to the UART and GCPort_IsTelemetryBusy sees that.
+	 */
+	DMA2->HIFCR = DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6;
+	DMA2_Stream6->M0AR = (uint32_t)bytes;
+	DMA2_Stream6->NDTR = numOfBytes;
+	DMA2_Stream6->CR |= DMA_SxCR_EN;
+}
+
+uint32_t GCPort_IsTelemetryBusy()
+{
+	return (DMA2_Stream6->CR & DMA_SxCR_EN) ? 1 : 0;
+}
+#endif
+
+#if GC_USE_RECORDING || GC_USE_REPLAY
+const uint8_t *GCPort_GetRecordingFlash()
+{
+	return (const uint8_t *)GC_RECORDING_FLASH_ADDRESS;
+}
+
+void GCPort_EraseRecordingFlash()
+{
+	FLASH_EraseInitTypeDef erase = {0};
+	uint32_t sectorError;
+
+	/* 2.7 V to 3.6 V, so the sectors are erased 32 bits at a time */
+	erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	erase.Sector = GC_RECORDING_FIRST_SECTOR;
+	erase.NbSectors = GC_RECORDING_NUM_OF_SECTORS;
+	erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	HAL_FLASH_Unlock();
+	HAL_FLASHEx_Erase(&erase, &sectorError);
+	HAL_FLASH_Lock();
+}
+
+void GCPort_ProgramRecordingWord(uint32_t offset, uint32_t word)
+{
+	HAL_FLASH_Unlock();
+	HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, GC_RECORDING_FLASH_ADDRESS + offset, word);
+	HAL_FLASH_Lock();
+}
+#endif
+
+#if GC_USE_DMA_TX || GC_USE_DMA_RX
+void USART1_IRQHandler(void)
+{
+	uint32_t status = USART1->SR;
+
+#if GC_USE_DMA_RX
+	if(status & (USART_SR_IDLE | USART_SR_FE | USART_SR_ORE | USART_SR_NE))
+	{
+		/* Reading SR then DR clears these flags. DMA already took the
+		 * received bytes so nothing is lost by reading DR.
+		 */
+		(void)USART1->DR;
+
+		// A command with a bad UART byte must not be performed
+		if(status & (USART_SR_FE | USART_SR_ORE | USART_SR_NE))
+		{
+			GCControllerEmulation_ReceiveErrors(0, (status & USART_SR_FE) ? 1 : 0,
+												(status & USART_SR_ORE) ? 1 : 0,
+												(status & USART_SR_NE) ? 1 : 0);
+		}
+
+		/* The line goes idle after the stop bit of a command */
+		if(status & USART_SR_IDLE)
+		{
+			GCPort_ProcessRxRing(0, DMA2_Stream2, gcRxRing, &gcRxReadIndex);
+		}
+	}
+#endif
+
+#if GC_USE_DMA_TX
+	/* Last UART byte of the response is out, finish with the stop bit */
+	if( (USART1->CR1 & USART_CR1_TCIE) && (status & USART_SR_TC) )
+	{
+		USART1->CR1 &= ~USART_CR1_TCIE;
+		GC_PROFILE_END(GC_PROFILE_TX);
+		GCPort_SendStopBit();
+		gcSendInProgress = 0;
+#if GC_USE_DMA_RX
+		GCPort_StartReceiving(0);
+#endif
+	}
+#endif
+}
+#endif
+
+#if GC_USE_WAVEFORM_TX && GC_USE_DMA_RX
+void DMA2_Stream5_IRQHandler(void)
+{
+	/* Last slot of the response is written, the line is free */
+	if(DMA2->HISR & DMA_HISR_TCIF5)
+	{
+		DMA2->HIFCR = DMA_HIFCR_CTCIF5;
+		GCPort_StartReceiving(0);
+	}
+}
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+void USART2_IRQHandler(void)
+{
+	GCPort_ServiceConsoleLine(1);
+}
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 2
+void USART6_IRQHandler(void)
+{
+	GCPort_ServiceConsoleLine(2);
+}
+#endif
+
+#if GC_USE_DMA_SAMPLING
+void GCPort_InitSampleStream(DMA_Stream_TypeDef *stream, GPIO_TypeDef *port, volatile uint16_t *samples)
+{
+	/* Half words from the IDR to the ring, wrapping around forever. The
+	 * priority is below the GC data line streams.
+	 */
+	stream->CR = 0;
+	while(stream->CR & DMA_SxCR_EN){};
+	stream->PAR = (uint32_t)&port->IDR;
+	stream->M0AR = (uint32_t)samples;
+	stream->NDTR = GC_SAMPLE_RING_SIZE;
+	stream->FCR = 0;
+	stream->CR = (GC_SAMPLE_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_0 | DMA_SxCR_MSIZE_0 |
+				 DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+	stream->CR |= DMA_SxCR_EN;
+}
+#endif
+
+#if GC_USE_DMA_RX
+uint32_t GCPort_GetRxWriteIndex(DMA_Stream_TypeDef *stream)
+{
+	uint32_t writeIndex = GC_RX_RING_SIZE - stream->NDTR;
+	return (writeIndex == GC_RX_RING_SIZE) ? 0 : writeIndex;
+}
+
+void GCPort_ProcessRxRing(uint32_t consolePort, DMA_Stream_TypeDef *stream, const uint8_t *ring, uint32_t *readIndex)
+{
+	uint32_t writeIndex = GCPort_GetRxWriteIndex(stream);
+
+	while(*readIndex != writeIndex)
+	{
+		uint8_t uartByte = ring[*readIndex];
+		*readIndex = (*readIndex + 1 == GC_RX_RING_SIZE) ? 0 : *readIndex + 1;
+
+		/* The emulation stops receiving while it answers a command, what
+		 * is left belongs to no command
+		 */
+		if(GCControllerEmulation_ReceiveUartByte(consolePort, uartByte))
+		{
+			return;
+		}
+	}
+}
+#endif
+
+#if GC_NUM_OF_CONSOLE_PORTS > 1
+void GCPort_InitConsoleLine(uint32_t consolePort)
+{
+	const GCConsoleLine_t *line = &gcConsoleLines[consolePort - 1];
+	GCConsoleLineState_t *state = &gcConsoleLineStates[consolePort - 1];
+
+	// TX and RX share the data line like on USART1
+	GPIO_InitTypeDef GPIO_InitStruct_GCPort = {0};
+	GPIO_InitStruct_GCPort.Pin = line->pins;
+	GPIO_InitStruct_GCPort.Mode = GPIO_MODE_AF_OD;
+	GPIO_InitStruct_GCPort.Alternate = line->alternate;
+	GPIO_InitStruct_GCPort.Pull = GPIO_NOPULL;
+	GPIO_InitStruct_GCPort.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(line->gpioPort, &GPIO_InitStruct_GCPort);
+
+	state->huart.Instance = line->uart;
+	state->huart.Init.BaudRate = GC_BAUD_RATE;
+	state->huart.Init.WordLength = UART_WORDLENGTH_8B;
+	state->huart.Init.StopBits = UART_STOPBITS_1;
+	state->huart.Init.Parity = UART_PARITY_NONE;
+	state->huart.Init.Mode = UART_MODE_TX_RX;
+	state->huart.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+	state->huart.Init.OverSampling = UART_OVERSAMPLING_8;
+	HAL_UART_Init(&state->huart);
+
+	/* Bytes of a frame to DR, and DR to the circular receive ring. Both
+	 * streams have the priority of the USART1 ones.
+	 */
+	line->txStream->CR = 0;
+	while(line->txStream->CR & DMA_SxCR_EN){};
+	line->txStream->PAR = (uint32_t)&line->uart->DR;
+	line->txStream->FCR = 0;
+	line->txStream->CR = line->channel | DMA_SxCR_PL | DMA_SxCR_MINC | DMA_SxCR_DIR_0;
+
+	line->rxStream->CR = 0;
+	while(line->rxStream->CR & DMA_SxCR_EN){};
+	line->rxStream->PAR = (uint32_t)&line->uart->DR;
+	line->rxStream->M0AR = (uint32_t)state->rxRing;
+	line->rxStream->NDTR = GC_RX_RING_SIZE;
+	line->rxStream->FCR = 0;
+	line->rxStream->CR = line->channel | DMA_SxCR_PL | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+	line->rxStream->CR |= DMA_SxCR_EN;
+
+	/* Same priority as USART1 so the console ports never preempt each
+	 * other, and an answer is only held up by an interrupt already
+	 * running
+	 */
+	line->uart->CR3 |= USART_CR3_DMAT | USART_CR3_DMAR | USART_CR3_EIE;
+	line->uart->CR1 |= USART_CR1_IDLEIE;
+	HAL_NVIC_SetPriority(line->irq, 0, 0);
+	HAL_NVIC_EnableIRQ(line->irq);
+}
+
+void GCPort_ServiceConsoleLine(uint32_t consolePort)
+{
+	const GCConsoleLine_t *line = &gcConsoleLines[consolePort - 1];
+	GCConsoleLineState_t *state = &gcConsoleLineStates[consolePort - 1];
+	USART_TypeDef *uart = line->uart;
+	uint32_t status = uart->SR;
+
+	if(status & (USART_SR_IDLE | USART_SR_FE | USART_SR_ORE | USART_SR_NE))
+	{
+		// Reading SR then DR clears these flags, like on USART1
+		(void)uart->DR;
+
+		if(status & (USART_SR_FE | USART_SR_ORE | USART_SR_NE))
+		{
+			GCControllerEmulation_ReceiveErrors(consolePort, (status & USART_SR_FE) ? 1 : 0,
+												(status & USART_SR_ORE) ? 1 : 0,
+												(status & USART_SR_NE) ? 1 : 0);
+		}
+
+		if(status & USART_SR_IDLE)
+		{
+			GCPort_ProcessRxRing(consolePort, line->rxStream, state->rxRing, &state->rxReadIndex);
+		}
+	}
+
+	/* Once the last UART byte of the response is out, the stop bit goes
+	 * out as a 0xFF UART byte, which is only low for its start bit.
+	 * Writing DR after reading SR clears TC.
+	 */
+	if( (uart->CR1 & USART_CR1_TCIE) && (status & USART_SR_TC) )
+	{
+		if(!state->sendingStopBit)
+		{
+			state->sendingStopBit = 1;
+			uart->DR = GC_BITS_STOP_BIT;
+		}
+		else
+		{
+			uart->CR1 &= ~USART_CR1_TCIE;
+			state->sendingStopBit = 0;
+			state->sendInProgress = 0;
+			GCPort_StartReceiving(consolePort);
+		}
+	}
+}
+#endif
+
+#if GC_USE_CAPTURE_RX
+uint32_t GCPort_ProcessCaptureRing()
+{
+	if(gcCaptureByteIndex < gcNumOfCaptureBytes)
+	{
+		return 1;
+	}
+	gcCaptureByteIndex = 0;
+	gcNumOfCaptureBytes = 0;
+
+	uint32_t writeIndex = GC_CAPTURE_RING_SIZE - GC_CAPTURE_STREAM->NDTR;
+	if(writeIndex == GC_CAPTURE_RING_SIZE)
+	{
+		writeIndex = 0;
+	}
+
+	while(gcCaptureReadIndex != writeIndex)
+	{
+		uint16_t time = gcCaptureRing[gcCaptureReadIndex];
+		gcCaptureReadIndex = (gcCaptureReadIndex + 1 == GC_CAPTURE_RING_SIZE) ? 0 : gcCaptureReadIndex + 1;
+
+		/* An edge is decoded no earlier than it happened, so the idle
+		 * time below is never cut short
+		 */
+		gcCaptureEdgeCycles = DWT->CYCCNT;
+		if(GCCaptureRx_Edge(&gcCaptureRx, time, &gcCaptureBytes[0]))
+		{
+			gcNumOfCaptureBytes = 1;
+			return 1;
+		}
+	}
+
+	// A line high for long enough ends the command with its stop bit
+	if( ((DWT->CYCCNT - gcCaptureEdgeCycles) >= gcCaptureIdleCycles) && (GC_RX_PORT->IDR & GC_RX_BIT) )
+	{
+		gcNumOfCaptureBytes = GCCaptureRx_Idle(&gcCaptureRx, gcCaptureBytes);
+	}
+
+	return (gcNumOfCaptureBytes != 0) ? 1 : 0;
+}
+#endif
+
+#if GC_USE_WAVEFORM_TX
+GCPortWaveform_t *GCPort_FindWaveform(const uint32_t *frame)
+{
+	GCPortWaveform_t *unused = NULL;
+
+	for(uint32_t i = 0; i < GC_WAVE_NUM_OF_FRAMES; i++)
+	{
+		if(gcWaveforms[i].frame == frame)
+		{
+			return &gcWaveforms[i];
+		}
+		if( (unused == NULL) && (gcWaveforms[i].frame == NULL) )
+		{
+			unused = &gcWaveforms[i];
+		}
+	}
+
+	/* The emulation only sends GC_WAVE_NUM_OF_FRAMES frames, any other
+	 * one takes over the last waveform
+	 */
+	return (unused != NULL) ? unused : &gcWaveforms[GC_WAVE_NUM_OF_FRAMES - 1];
+}
+
+void GCPort_RenderWaveform(GCPortWaveform_t *waveform, const uint32_t *frame, uint32_t numOfGCBytes)
+{
+	if(numOfGCBytes > GC_MAX_RESPONSE_BYTES)
+	{
+		numOfGCBytes = GC_MAX_RESPONSE_BYTES;
+	}
+
+	waveform->frame = frame;
+	waveform->numOfGCBytes = numOfGCBytes;
+	waveform->stopSlot = 0;
+	GCWaveform_Render(&gcWaveform, frame, numOfGCBytes, waveform->slots);
+}
+#endif
+
+#if GC_USE_INPUT_EDGES
+void GCPort_CaptureInputs(uint32_t lines)
+{
+	/* Clear first, so an edge during the read raises the interrupt again */
+	EXTI->PR = lines;
+	uint32_t cycles = DWT->CYCCNT;
+	GCControllerEmulation_CaptureInputs(GCPort_ReadInputs(), cycles);
+}
+
+void EXTI0_IRQHandler(void)
+{
+	GCPort_CaptureInputs(EXTI_PR_PR0);
+}
+
+void EXTI1_IRQHandler(void)
+{
+	GCPort_CaptureInputs(EXTI_PR_PR1);
+}
+
+void EXTI3_IRQHandler(void)
+{
+	GCPort_CaptureInputs(EXTI_PR_PR3);
+}
+
+void EXTI4_IRQHandler(void)
+{
+	GCPort_CaptureInputs(EXTI_PR_PR4);
+}
+
+void EXTI9_5_IRQHandler(void)
+{
+	GCPort_CaptureInputs(EXTI->PR & GC_INPUT_EXTI_LINES & 0x03E0UL);
+}
+
+void EXTI15_10_IRQHandler(void)
+{
+	GCPort_CaptureInputs(EXTI->PR & GC_INPUT_EXTI_LINES & 0xFC00UL);
+}
+#endif
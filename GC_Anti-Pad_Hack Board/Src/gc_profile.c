@@ -0,0 +1,61 @@
+#include "gc_profile.h"
+
+#if GC_USE_PROFILING
+// Macros //
+/* Histogram bucket of a cycle count, the number of bits it needs */
+#define GC_PROFILE_BUCKET(cycles)	( ((cycles) == 0) ? 0 : (32 - __builtin_clz(cycles)) )
+
+// Variables //
+/* Start time of every phase */
+static volatile uint32_t gcProfileStartCycles[NUM_OF_GC_PROFILE_PHASES];
+
+/* Statistics of every phase, kept in RAM to be read with a debugger */
+static GCProfileStats_t gcProfileStats[NUM_OF_GC_PROFILE_PHASES];
+
+// Public Function Implementations //
+void GCProfile_Start(GCProfilePhase_t phase)
+{
+	gcProfileStartCycles[phase] = GCPort_GetCycles();
+}
+
+void GCProfile_End(GCProfilePhase_t phase)
+{
+	GCProfile_Record(phase, GCPort_GetCycles() - gcProfileStartCycles[phase]);
+}
+
+void GCProfile_Record(GCProfilePhase_t phase, uint32_t cycles)
+{
+	GCProfileStats_t *stats = &gcProfileStats[phase];
+
+	stats->lastCycles = cycles;
+	if( (stats->numOfSamples == 0) || (cycles < stats->minCycles) )
+	{
+		stats->minCycles = cycles;
+	}
+	if(cycles > stats->maxCycles)
+	{
+		stats->maxCycles = cycles;
+	}
+	stats->totalCycles += cycles;
+	stats->numOfSamples++;
+	stats->histogram[GC_PROFILE_BUCKET(cycles)]++;
+}
+
+void GCProfile_GetStats(GCProfilePhase_t phase, GCProfileStats_t *stats)
+{
+	*stats = gcProfileStats[phase];
+}
+
+uint32_t GCProfile_GetLastCycles(GCProfilePhase_t phase)
+{
+	return gcProfileStats[phase].lastCycles;
+}
+
+void GCProfile_Reset()
+{
+	for(uint32_t phase = 0; phase < NUM_OF_GC_PROFILE_PHASES; phase++)
+	{
+		gcProfileStats[phase] = (GCProfileStats_t){0};
+	}
+}
+#endif
@@ -0,0 +1,223 @@
+#include "gc_recording.h"
+
+// Macros //
+/* Record tags, see Note 1 of gc_recording.h */
+#define GC_RECORDING_TAG_RUN_MAX	0x7F
+#define GC_RECORDING_TAG_FLIP		0x80
+#define GC_RECORDING_TAG_XOR		0xC0
+#define GC_RECORDING_TAG_KEY		0xC1
+#define GC_RECORDING_TAG_END		0xFF
+
+/* Top bits of a FLIP tag and its bit number */
+#define GC_RECORDING_FLIP_MASK		0xE0
+#define GC_RECORDING_FLIP_BIT		0x1F
+
+/* Longest record, a RUN ended by an XOR or KEY */
+#define GC_RECORDING_MAX_RECORD_BYTES	5
+
+/* Operand of an XOR or KEY record */
+#define GC_RECORDING_OPERAND(bytes) \
+	( (uint32_t)(bytes)[0] | ((uint32_t)(bytes)[1] << 8) | ((uint32_t)(bytes)[2] << 16) )
+
+_Static_assert((GC_RECORDING_RING_BYTES & (GC_RECORDING_RING_BYTES - 1)) == 0, "GC_RECORDING_RING_BYTES must be a power of 2");
+
+// Function Prototypes //
+/* Queues the bytes of one record, or stops the recording if they do not
+ * fit. Returns 1 if they were queued.
+ */
+static uint32_t GCRecording_Queue(GCRecordingWriter_t *, const uint8_t *, uint32_t);
+
+// Public Function Implementations //
+uint32_t GCRecording_InitWriter(GCRecordingWriter_t *writer, uint32_t endOffset)
+{
+	*writer = (GCRecordingWriter_t){0};
+
+	/* The bytes of a cut off record past the last whole word read as
+	 * erased flash. Finish it with 0x00 bytes from that word on.
+	 */
+	uint32_t numOfPadBytes = endOffset & 3;
+	writer->head = numOfPadBytes;
+	writer->numOfRecordBytes = numOfPadBytes;
+
+	return endOffset - numOfPadBytes;
+}
+
+uint32_t GCRecording_Record(GCRecordingWriter_t *writer, uint32_t word)
+{
+	if(writer->isStopped)
+	{
+		return 0;
+	}
+	writer->numOfPolls++;
+
+	/* The same word again only counts, until a RUN is full */
+	if(writer->hasKey && (word == writer->lastWord))
+	{
+		if(++writer->runLength < GC_RECORDING_MAX_RUN)
+		{
+			return 1;
+		}
+		uint8_t run = GC_RECORDING_MAX_RUN - 1;
+		writer->runLength = 0;
+		return GCRecording_Queue(writer, &run, 1);
+	}
+
+	uint8_t record[GC_RECORDING_MAX_RECORD_BYTES];
+	uint32_t numOfBytes = 0;
+	if(writer->runLength != 0)
+	{
+		record[numOfBytes++] = (uint8_t)(writer->runLength - 1);
+		writer->runLength = 0;
+	}
+
+	/* One button is a FLIP, more than one an XOR */
+	uint32_t changed = word ^ writer->lastWord;
+	uint32_t operand = changed;
+	if(!writer->hasKey)
+	{
+		record[numOfBytes++] = GC_RECORDING_TAG_KEY;
+		operand = word;
+		writer->hasKey = 1;
+	}
+	else if((changed & (changed - 1)) == 0)
+	{
+		record[numOfBytes++] = (uint8_t)(GC_RECORDING_TAG_FLIP | __builtin_ctz(changed));
+	}
+	else
+	{
+		record[numOfBytes++] = GC_RECORDING_TAG_XOR;
+	}
+
+	if(record[numOfBytes - 1] >= GC_RECORDING_TAG_XOR)
+	{
+		record[numOfBytes++] = (uint8_t)operand;
+		record[numOfBytes++] = (uint8_t)(operand >> 8);
+		record[numOfBytes++] = (uint8_t)(operand >> 16);
+	}
+
+	writer->lastWord = word;
+	return GCRecording_Queue(writer, record, numOfBytes);
+}
+
+uint32_t GCRecording_TakeWord(GCRecordingWriter_t *writer, uint32_t *word)
+{
+	uint32_t tail = writer->tail;
+	if((writer->head - tail) < 4)
+	{
+		return 0;
+	}
+
+	/* Flash is little endian, so the first byte is the lowest */
+	*word = 0;
+	for(uint32_t i = 0; i < 4; i++)
+	{
+		*word |= (uint32_t)writer->ring[(tail + i) & (GC_RECORDING_RING_BYTES - 1)] << (8 * i);
+	}
+	writer->tail = tail + 4;
+
+	return 1;
+}
+
+void GCRecording_Stop(GCRecordingWriter_t *writer)
+{
+	writer->isStopped = 1;
+}
+
+uint32_t GCRecording_HasMagic(const uint8_t *data)
+{
+	uint32_t magic = GC_RECORDING_OPERAND(data) | ((uint32_t)data[3] << 24);
+	return (magic == GC_RECORDING_MAGIC) ? 1 : 0;
+}
+
+void GCRecording_InitReader(GCRecordingReader_t *reader, const uint8_t *data, uint32_t size)
+{
+	*reader = (GCRecordingReader_t){0};
+	reader->data = data;
+	reader->size = size;
+}
+
+uint32_t GCRecording_Next(GCRecordingReader_t *reader, uint32_t *word)
+{
+	/* Every record is one poll, a RUN then repeats it, so the cost of a
+	 * poll never depends on the recording
+	 */
+	if(reader->runLeft != 0)
+	{
+		reader->runLeft--;
+		*word = reader->word;
+		return 1;
+	}
+
+	if(reader->offset >= reader->size)
+	{
+		return 0;
+	}
+
+	const uint8_t *record = &reader->data[reader->offset];
+	uint8_t tag = record[0];
+	if(tag <= GC_RECORDING_TAG_RUN_MAX)
+	{
+		reader->runLeft = tag;
+		reader->offset++;
+	}
+	else if((tag & GC_RECORDING_FLIP_MASK) == GC_RECORDING_TAG_FLIP)
+	{
+		reader->word ^= 1UL << (tag & GC_RECORDING_FLIP_BIT);
+		reader->offset++;
+	}
+	else if( ((tag == GC_RECORDING_TAG_XOR) || (tag == GC_RECORDING_TAG_KEY)) && ((reader->offset + 4) <= reader->size) )
+	{
+		uint32_t operand = GC_RECORDING_OPERAND(&record[1]);
+		reader->word = (tag == GC_RECORDING_TAG_KEY) ? operand : (reader->word ^ operand);
+		reader->offset += 4;
+	}
+	else
+	{
+		// END, or a tag that is not a record
+		return 0;
+	}
+
+	*word = reader->word;
+	return 1;
+}
+
+uint32_t GCRecording_SkipToEnd(GCRecordingReader_t *reader)
+{
+	uint32_t word;
+
+	/* A RUN is skipped as one record */
+	while(GCRecording_Next(reader, &word))
+	{
+		reader->runLeft = 0;
+	}
+
+	if( (reader->offset < reader->size) && (reader->data[reader->offset] != GC_RECORDING_TAG_END) )
+	{
+		// Not erased flash, the region is treated as full
+		return reader->size;
+	}
+
+	return reader->offset;
+}
+
+// Private Function Implementations //
+uint32_t GCRecording_Queue(GCRecordingWriter_t *writer, const uint8_t *record, uint32_t numOfBytes)
+{
+	uint32_t head = writer->head;
+	if((GC_RECORDING_RING_BYTES - (head - writer->tail)) < numOfBytes)
+	{
+		writer->isStopped = 1;
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < numOfBytes; i++)
+	{
+		writer->ring[(head + i) & (GC_RECORDING_RING_BYTES - 1)] = record[i];
+	}
+
+	// The bytes are in place before the consumer can see them
+	writer->head = head + numOfBytes;
+	writer->numOfRecordBytes += numOfBytes;
+
+	return 1;
+}
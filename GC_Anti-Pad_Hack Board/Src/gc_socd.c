@@ -0,0 +1,106 @@
+#include "gc_socd.h"
+#include "gc_controller_emulation.h"
+
+// Macros //
+/* Both directions of an axis, the first one is the low bit of the pair */
+#define GC_SOCD_AXIS(firstDirection)	(GC_BUTTON_MASK(firstDirection) | GC_BUTTON_MASK((firstDirection) + 1))
+
+/* Axes of each group */
+#define GC_SOCD_DPAD_AXES		(GC_SOCD_AXIS(GC_DPAD_UP) | GC_SOCD_AXIS(GC_DPAD_LEFT))
+#define GC_SOCD_MAIN_STICK_AXES	(GC_SOCD_AXIS(GC_MAIN_STICK_UP) | GC_SOCD_AXIS(GC_MAIN_STICK_LEFT))
+#define GC_SOCD_C_STICK_AXES	(GC_SOCD_AXIS(GC_C_STICK_UP) | GC_SOCD_AXIS(GC_C_STICK_LEFT))
+#define GC_SOCD_ALL_AXES		(GC_SOCD_DPAD_AXES | GC_SOCD_MAIN_STICK_AXES | GC_SOCD_C_STICK_AXES)
+
+/* Low bit of every axis */
+#define GC_SOCD_FIRST_BITS		(GC_BUTTON_MASK(GC_DPAD_UP) | GC_BUTTON_MASK(GC_DPAD_LEFT) | \
+								 GC_BUTTON_MASK(GC_MAIN_STICK_UP) | GC_BUTTON_MASK(GC_MAIN_STICK_LEFT) | \
+								 GC_BUTTON_MASK(GC_C_STICK_UP) | GC_BUTTON_MASK(GC_C_STICK_LEFT))
+
+/* Up of every y-axis */
+#define GC_SOCD_UP_BITS			(GC_BUTTON_MASK(GC_DPAD_UP) | GC_BUTTON_MASK(GC_MAIN_STICK_UP) | GC_BUTTON_MASK(GC_C_STICK_UP))
+
+/* Spreads a flag on the low bit of each axis to both of its bits */
+#define GC_SOCD_SPREAD(firstBits)	((firstBits) | ((firstBits) << 1))
+
+/* Axes with both bits set in a word */
+#define GC_SOCD_BOTH(word)		GC_SOCD_SPREAD((word) & ((word) >> 1) & GC_SOCD_FIRST_BITS)
+
+/* Axes with any bit set in a word */
+#define GC_SOCD_ANY(word)		GC_SOCD_SPREAD(((word) | ((word) >> 1)) & GC_SOCD_FIRST_BITS)
+
+// The masks above rely on this layout of GCButtonInput_t
+_Static_assert( (GC_DPAD_DOWN == GC_DPAD_UP + 1) && (GC_DPAD_RIGHT == GC_DPAD_LEFT + 1) &&
+				(GC_MAIN_STICK_DOWN == GC_MAIN_STICK_UP + 1) && (GC_MAIN_STICK_RIGHT == GC_MAIN_STICK_LEFT + 1) &&
+				(GC_C_STICK_DOWN == GC_C_STICK_UP + 1) && (GC_C_STICK_RIGHT == GC_C_STICK_LEFT + 1) &&
+				((GC_DPAD_UP | GC_DPAD_LEFT | GC_MAIN_STICK_UP | GC_MAIN_STICK_LEFT | GC_C_STICK_UP | GC_C_STICK_LEFT) & 1) == 0,
+				"SOCD axes must be pairs of bits starting on an even bit");
+
+// Constant Tables //
+static const uint32_t gcSocdGroupAxes[NUM_OF_GC_SOCD_GROUPS] =
+{
+	[GC_SOCD_GROUP_DPAD] = GC_SOCD_DPAD_AXES,
+	[GC_SOCD_GROUP_MAIN_STICK] = GC_SOCD_MAIN_STICK_AXES,
+	[GC_SOCD_GROUP_C_STICK] = GC_SOCD_C_STICK_AXES
+};
+
+// Public Function Implementations //
+void GCSocd_Init(GCSocd_t *socd, GCSocdPolicy_t dpadPolicy, GCSocdPolicy_t mainStickPolicy, GCSocdPolicy_t cStickPolicy)
+{
+	*socd = (GCSocd_t){0};
+	socd->policyAxes[GC_SOCD_NEUTRAL] = GC_SOCD_ALL_AXES;
+
+	GCSocd_SetPolicy(socd, GC_SOCD_GROUP_DPAD, dpadPolicy);
+	GCSocd_SetPolicy(socd, GC_SOCD_GROUP_MAIN_STICK, mainStickPolicy);
+	GCSocd_SetPolicy(socd, GC_SOCD_GROUP_C_STICK, cStickPolicy);
+}
+
+void GCSocd_SetPolicy(GCSocd_t *socd, GCSocdGroup_t group, GCSocdPolicy_t policy)
+{
+	if( (group >= NUM_OF_GC_SOCD_GROUPS) || (policy >= NUM_OF_GC_SOCD_POLICIES) )
+	{
+		return;
+	}
+
+	for(uint32_t i = 0; i < NUM_OF_GC_SOCD_POLICIES; i++)
+	{
+		socd->policyAxes[i] &= ~gcSocdGroupAxes[group];
+	}
+	socd->policyAxes[policy] |= gcSocdGroupAxes[group];
+}
+
+uint32_t GCSocd_Resolve(GCSocd_t *socd, uint32_t inputs)
+{
+	/* Remember which direction of each axis was pushed last. Both pushed
+	 * at once leaves both bits set, which no policy picks.
+	 */
+	uint32_t newlyPushed = inputs & ~socd->lastInputs & GC_SOCD_ALL_AXES;
+	uint32_t pushedAxes = GC_SOCD_ANY(newlyPushed);
+	uint32_t lastPushed = (socd->lastPushed & ~pushedAxes) | newlyPushed;
+	uint32_t lastPushedSingle = lastPushed & ~GC_SOCD_BOTH(lastPushed);
+
+	/* Axes with both directions held */
+	uint32_t conflicts = GC_SOCD_BOTH(inputs);
+	uint32_t clean = inputs & ~conflicts;
+
+	/* The loser of a conflict stays off until it is let go */
+	uint32_t suppressed = (socd->suppressed | (conflicts & ~lastPushed)) & inputs;
+
+	/* What every policy would send, only the axes using it are kept */
+	uint32_t lastInput = clean | (conflicts & lastPushedSingle);
+	uint32_t firstInput = clean | (conflicts & ~lastPushed);
+	uint32_t upPriority = clean | (conflicts & GC_SOCD_UP_BITS);
+	uint32_t secondInput = (clean | (conflicts & lastPushedSingle)) & ~suppressed;
+
+	uint32_t resolved = (inputs & ~GC_SOCD_ALL_AXES) |
+						(clean & socd->policyAxes[GC_SOCD_NEUTRAL]) |
+						(lastInput & socd->policyAxes[GC_SOCD_LAST_INPUT]) |
+						(firstInput & socd->policyAxes[GC_SOCD_FIRST_INPUT]) |
+						(upPriority & socd->policyAxes[GC_SOCD_UP_PRIORITY]) |
+						(secondInput & socd->policyAxes[GC_SOCD_SECOND_INPUT]);
+
+	socd->lastInputs = inputs;
+	socd->lastPushed = lastPushed;
+	socd->suppressed = suppressed;
+
+	return resolved;
+}
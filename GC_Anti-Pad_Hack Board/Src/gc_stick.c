@@ -0,0 +1,70 @@
+#include "gc_stick.h"
+#include "gc_stick_profile.h"
+
+// Macros //
+/* State of one input inside a table index */
+#define GC_STICK_BIT(index, gcButton)	(((index) >> ((gcButton) - GC_MAIN_STICK_UP)) & 1)
+
+/* Direction of each axis inside a table index */
+#define GC_STICK_DX(index, left, right) \
+	( GC_STICK_BIT(index, left) ? -1 : (GC_STICK_BIT(index, right) ? 1 : 0) )
+#define GC_STICK_DY(index, down, up) \
+	( GC_STICK_BIT(index, down) ? -1 : (GC_STICK_BIT(index, up) ? 1 : 0) )
+
+#define GC_STICK_MAIN_DX(index)		GC_STICK_DX(index, GC_MAIN_STICK_LEFT, GC_MAIN_STICK_RIGHT)
+#define GC_STICK_MAIN_DY(index)		GC_STICK_DY(index, GC_MAIN_STICK_DOWN, GC_MAIN_STICK_UP)
+#define GC_STICK_C_DX(index)		GC_STICK_DX(index, GC_C_STICK_LEFT, GC_C_STICK_RIGHT)
+#define GC_STICK_C_DY(index)		GC_STICK_DY(index, GC_C_STICK_DOWN, GC_C_STICK_UP)
+#define GC_STICK_TILT(index)		GC_STICK_BIT(index, GC_TILT)
+#define GC_STICK_MACRO(index)		GC_STICK_BIT(index, GC_MACRO)
+
+/* Every analog byte of one table index */
+#define GC_STICK_ENTRY(index) \
+	{ \
+		GC_STICK_PROFILE_MAIN_X(GC_STICK_MAIN_DX(index), GC_STICK_MAIN_DY(index), GC_STICK_TILT(index), GC_STICK_MACRO(index)), \
+		GC_STICK_PROFILE_MAIN_Y(GC_STICK_MAIN_DX(index), GC_STICK_MAIN_DY(index), GC_STICK_TILT(index), GC_STICK_MACRO(index)), \
+		GC_STICK_PROFILE_C_X(GC_STICK_C_DX(index), GC_STICK_C_DY(index), GC_STICK_TILT(index), GC_STICK_MACRO(index)), \
+		GC_STICK_PROFILE_C_Y(GC_STICK_C_DX(index), GC_STICK_C_DY(index), GC_STICK_TILT(index), GC_STICK_MACRO(index)), \
+		GC_STICK_PROFILE_L_TRIGGER(GC_STICK_TILT(index), GC_STICK_MACRO(index)), \
+		GC_STICK_PROFILE_R_TRIGGER(GC_STICK_TILT(index), GC_STICK_MACRO(index)) \
+	}
+
+/* Sixteen consecutive table indexes starting at index */
+#define GC_STICK_ROW(index) \
+	GC_STICK_ENTRY((index) + 0x0), GC_STICK_ENTRY((index) + 0x1), \
+	GC_STICK_ENTRY((index) + 0x2), GC_STICK_ENTRY((index) + 0x3), \
+	GC_STICK_ENTRY((index) + 0x4), GC_STICK_ENTRY((index) + 0x5), \
+	GC_STICK_ENTRY((index) + 0x6), GC_STICK_ENTRY((index) + 0x7), \
+	GC_STICK_ENTRY((index) + 0x8), GC_STICK_ENTRY((index) + 0x9), \
+	GC_STICK_ENTRY((index) + 0xA), GC_STICK_ENTRY((index) + 0xB), \
+	GC_STICK_ENTRY((index) + 0xC), GC_STICK_ENTRY((index) + 0xD), \
+	GC_STICK_ENTRY((index) + 0xE), GC_STICK_ENTRY((index) + 0xF)
+
+/* 256 consecutive table indexes starting at index */
+#define GC_STICK_BLOCK(index) \
+	GC_STICK_ROW((index) + 0x00), GC_STICK_ROW((index) + 0x10), \
+	GC_STICK_ROW((index) + 0x20), GC_STICK_ROW((index) + 0x30), \
+	GC_STICK_ROW((index) + 0x40), GC_STICK_ROW((index) + 0x50), \
+	GC_STICK_ROW((index) + 0x60), GC_STICK_ROW((index) + 0x70), \
+	GC_STICK_ROW((index) + 0x80), GC_STICK_ROW((index) + 0x90), \
+	GC_STICK_ROW((index) + 0xA0), GC_STICK_ROW((index) + 0xB0), \
+	GC_STICK_ROW((index) + 0xC0), GC_STICK_ROW((index) + 0xD0), \
+	GC_STICK_ROW((index) + 0xE0), GC_STICK_ROW((index) + 0xF0)
+
+// The table index relies on this layout of GCButtonInput_t
+_Static_assert( (GC_TILT - GC_MAIN_STICK_UP + 1 == GC_STICK_INDEX_BITS) &&
+				(GC_MAIN_STICK_DOWN > GC_MAIN_STICK_UP) && (GC_MAIN_STICK_LEFT > GC_MAIN_STICK_UP) &&
+				(GC_MAIN_STICK_RIGHT > GC_MAIN_STICK_UP) && (GC_C_STICK_UP > GC_MAIN_STICK_UP) &&
+				(GC_C_STICK_DOWN > GC_MAIN_STICK_UP) && (GC_C_STICK_LEFT > GC_MAIN_STICK_UP) &&
+				(GC_C_STICK_RIGHT > GC_MAIN_STICK_UP) && (GC_MACRO > GC_MAIN_STICK_UP),
+				"stick and modifier inputs must be the bits from GC_MAIN_STICK_UP to GC_TILT");
+
+// Variables //
+/* Analog bytes of every stick and modifier combination. Built by the
+ * compiler so it lives in flash.
+ */
+const GCStickCoordinates_t gcStickTable[1UL << GC_STICK_INDEX_BITS] =
+{
+	GC_STICK_BLOCK(0x000), GC_STICK_BLOCK(0x100),
+	GC_STICK_BLOCK(0x200), GC_STICK_BLOCK(0x300)
+};
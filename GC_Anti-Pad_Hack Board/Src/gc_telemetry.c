@@ -0,0 +1,92 @@
+#include "gc_telemetry.h"
+#include "gc_port.h"
+
+#if GC_USE_TELEMETRY
+_Static_assert(sizeof(GCTelemetryRecord_t) == GC_TELEMETRY_RECORD_BYTES, "telemetry record must not be padded");
+_Static_assert((GC_TELEMETRY_RING_SIZE & (GC_TELEMETRY_RING_SIZE - 1)) == 0, "telemetry ring size must be a power of 2");
+
+// Macros //
+/* Ring slot of a free running record count */
+#define GC_TELEMETRY_SLOT(count)	((count) & (GC_TELEMETRY_RING_SIZE - 1))
+
+// Variables //
+/* Records waiting to be sent, or being sent */
+static GCTelemetryRecord_t gcTelemetryRing[GC_TELEMETRY_RING_SIZE];
+
+/* Free running record counts, the head is only moved by GCTelemetry_Push
+ * and the tail only by GCTelemetry_Service
+ */
+static volatile uint32_t gcTelemetryHead = 0;
+static volatile uint32_t gcTelemetryTail = 0;
+
+/* Records handed to the port by the last GCTelemetry_Service */
+static uint32_t gcTelemetryNumInFlight = 0;
+
+/* Sequence of the next record, counts dropped records too */
+static uint8_t gcTelemetrySequence = 0;
+
+static GCTelemetryStats_t gcTelemetryStats;
+
+// Public Function Implementations //
+void GCTelemetry_Push(GCTelemetryRecord_t *record)
+{
+	uint32_t head = gcTelemetryHead;
+	uint8_t sequence = gcTelemetrySequence++;
+
+	// Never wait for the expansion port, drop the record instead
+	if((head - gcTelemetryTail) >= GC_TELEMETRY_RING_SIZE)
+	{
+		gcTelemetryStats.numOfDropped++;
+		return;
+	}
+
+	record->sync = GC_TELEMETRY_SYNC;
+	record->sequence = sequence;
+	record->numOfDropped = (gcTelemetryStats.numOfDropped > 0xFFFF) ? 0xFFFF : (uint16_t)gcTelemetryStats.numOfDropped;
+
+	const uint8_t *recordBytes = (const uint8_t *)record;
+	uint16_t checksum = 0;
+	for(uint32_t i = 0; i < (GC_TELEMETRY_RECORD_BYTES - sizeof(record->checksum)); i++)
+	{
+		checksum += recordBytes[i];
+	}
+	record->checksum = checksum;
+
+	gcTelemetryRing[GC_TELEMETRY_SLOT(head)] = *record;
+	gcTelemetryStats.numOfRecords++;
+
+	// The record must be in memory before the reader or the DMA can see it
+	__sync_synchronize();
+	gcTelemetryHead = head + 1;
+}
+
+void GCTelemetry_Service()
+{
+	if(GCPort_IsTelemetryBusy())
+	{
+		return;
+	}
+
+	/* The DMA is done with the last records, give their slots back */
+	uint32_t tail = gcTelemetryTail + gcTelemetryNumInFlight;
+	gcTelemetryTail = tail;
+	gcTelemetryNumInFlight = 0;
+
+	uint32_t numOfWaiting = gcTelemetryHead - tail;
+	if(numOfWaiting == 0)
+	{
+		return;
+	}
+
+	/* Send what is waiting up to the end of the ring, the rest goes next time */
+	uint32_t numToEnd = GC_TELEMETRY_RING_SIZE - GC_TELEMETRY_SLOT(tail);
+	gcTelemetryNumInFlight = (numOfWaiting < numToEnd) ? numOfWaiting : numToEnd;
+	GCPort_SendTelemetry((const uint8_t *)&gcTelemetryRing[GC_TELEMETRY_SLOT(tail)],
+						 gcTelemetryNumInFlight * GC_TELEMETRY_RECORD_BYTES);
+}
+
+void GCTelemetry_GetStats(GCTelemetryStats_t *stats)
+{
+	*stats = gcTelemetryStats;
+}
+#endif
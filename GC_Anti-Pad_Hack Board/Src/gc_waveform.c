@@ -0,0 +1,41 @@
+#include "gc_waveform.h"
+#include "gc_joybus.h"
+
+// Public Function Implementations //
+void GCWaveform_Init(GCWaveform_t *waveform, uint32_t low, uint32_t high)
+{
+	waveform->low = low;
+	waveform->high = high;
+
+	for(uint32_t bitPair = 0; bitPair < 4; bitPair++)
+	{
+		for(uint32_t slot = 0; slot < (2 * GC_WAVEFORM_SLOTS_PER_BIT); slot++)
+		{
+			/* Left bit first, a 1 goes high after 1 slot and a 0 after 3 */
+			uint32_t isOne = (bitPair >> ((slot < GC_WAVEFORM_SLOTS_PER_BIT) ? 1 : 0)) & 1;
+			uint32_t bitSlot = slot % GC_WAVEFORM_SLOTS_PER_BIT;
+			waveform->bitPairs[bitPair][slot] = (bitSlot < (isOne ? 1 : 3)) ? low : high;
+		}
+	}
+}
+
+void GCWaveform_Render(const GCWaveform_t *waveform, const uint32_t *frame, uint32_t numOfGCBytes, uint32_t *slots)
+{
+	const uint8_t *uartBytes = (const uint8_t *)frame;
+	uint32_t numOfUartBytes = numOfGCBytes * GC_UART_BYTES_PER_GC_BYTE;
+
+	for(uint32_t i = 0; i < numOfUartBytes; i++)
+	{
+		const uint32_t *pattern = waveform->bitPairs[gcJoybusDecodeTable[uartBytes[i]] & 0x03];
+		for(uint32_t slot = 0; slot < (2 * GC_WAVEFORM_SLOTS_PER_BIT); slot++)
+		{
+			*slots++ = pattern[slot];
+		}
+	}
+}
+
+void GCWaveform_StopBit(const GCWaveform_t *waveform, uint32_t *slots)
+{
+	slots[0] = waveform->low;
+	slots[1] = waveform->high;
+}
@@ -11,6 +11,11 @@ int main(void)
 	/* Start up main application code */
 	Main_Init();
 
+#if GC_USE_READER_MODE
+	/* Act as the console and poll the controller plugged in */
+	GCControllerReader_Init();
+	GCControllerReader_Run();
+#else
 	/* Get the GC emulation ready */
 	GCControllerEmulation_Init();
 
@@ -19,6 +24,7 @@ int main(void)
 	{
 		GCControllerEmulation_Run();
 	}
+#endif
 }
 
 /* Main Functions */